@@ -5,7 +5,12 @@
 #ifndef TASP_CONFIG_HPP_
 #define TASP_CONFIG_HPP_
 
+#include <chrono>
 #include <experimental/filesystem>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
 #include <string_view>
 
 namespace fs = std::experimental::filesystem;
@@ -15,6 +20,59 @@ namespace tasp
 
 class ConfigImpl;
 class ConfigGlobalImpl;
+class ConfigSubscription;
+class ConfigSubscriptionImpl;
+template<typename Type>
+class ConfigKeyImpl;
+
+/**
+ * @brief Строковое значение конфигурационного файла без копирования.
+ *
+ * Создается функциями Config::GetView и ConfigGlobal::GetView. Хранит ссылку
+ * на снимок глобального конфигурационного файла, поэтому значение остается
+ * действительным после перезагрузки, пока существует объект. Значение из
+ * Config действительно, пока файл не изменен и не перезагружен.
+ */
+class [[gnu::visibility("default")]] ConfigView final
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * @param owner Владелец памяти значения
+     * @param value Значение
+     */
+    ConfigView(std::shared_ptr<const void> owner,
+               std::string_view value) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~ConfigView() noexcept;
+
+    /**
+     * @brief Запрос значения.
+     *
+     * @return Значение
+     */
+    [[nodiscard]] std::string_view Value() const noexcept;
+
+    ConfigView(const ConfigView &) noexcept;
+    ConfigView(ConfigView &&) noexcept;
+    ConfigView &operator=(const ConfigView &) noexcept;
+    ConfigView &operator=(ConfigView &&) noexcept;
+
+private:
+    /**
+     * @brief Владелец памяти значения.
+     */
+    std::shared_ptr<const void> owner_;
+
+    /**
+     * @brief Значение.
+     */
+    std::string_view value_;
+};
 
 /**
  * @brief Интерфейс для работы с конфигурационным файлом.
@@ -66,6 +124,39 @@ public:
     [[nodiscard]] Type Get(std::string_view path,
                            const Type &default_value = {}) const noexcept;
 
+    /**
+     * @brief Обход элементов последовательности.
+     *
+     * Функция обработки вызывается для каждого элемента по порядку без
+     * создания массива. Для типа std::string_view элемент передается без
+     * копирования и действителен, пока файл не изменен и не перезагружен.
+     * Элементы, которые не удалось преобразовать к типу, пропускаются.
+     *
+     * @param path Полный путь к последовательности
+     * @param callback Функция обработки элемента
+     *
+     * @return Количество обработанных элементов. Если параметр отсутствует
+     * или не является последовательностью - 0
+     */
+    template<typename Type>
+    std::size_t ForEach(
+        std::string_view path,
+        const std::function<void(const Type &)> &callback) const noexcept;
+
+    /**
+     * @brief Запрос строкового значения без копирования.
+     *
+     * @param path Полный путь к значению
+     * @param default_value Значение по умолчанию. Должно существовать, пока
+     * используется результат
+     *
+     * @return Значение из конфигурационного файла или значение по умолчанию,
+     * если параметр отсутствует или не является скалярным
+     */
+    [[nodiscard]] ConfigView GetView(
+        std::string_view path,
+        std::string_view default_value = {}) const noexcept;
+
     /**
      * @brief Установка нового значения в конфигурационном файле.
      *
@@ -97,10 +188,37 @@ public:
     /**
      * @brief Сохранение значений в конфигурационный файл.
      *
+     * Файл заменяется атомарно: при сбое во время записи он содержит либо
+     * старое, либо новое содержимое. Если содержимое не изменилось, файл не
+     * перезаписывается. Внутри пакетного изменения (@ref Begin) сохранение
+     * откладывается до @ref Commit.
+     *
      * @return Результат сохранения файла
      */
     [[nodiscard]] bool Save() const noexcept;
 
+    /**
+     * @brief Начало пакетного изменения.
+     *
+     * Изменения накапливаются в памяти и записываются в файл одной записью
+     * при вызове @ref Commit. Пакетные изменения могут быть вложенными.
+     */
+    void Begin() noexcept;
+
+    /**
+     * @brief Завершение пакетного изменения с сохранением файла.
+     *
+     * @return Результат сохранения файла
+     */
+    [[nodiscard]] bool Commit() noexcept;
+
+    /**
+     * @brief Отмена пакетного изменения.
+     *
+     * Восстанавливаются значения на момент вызова внешнего @ref Begin.
+     */
+    void Rollback() noexcept;
+
     /**
      * @brief Перезагрузка конфигурационного файла.
      *
@@ -127,6 +245,17 @@ public:
      */
     [[nodiscard]] std::string String() const noexcept;
 
+    /**
+     * @brief Конвертация части конфигурационного файла в текстовый формат.
+     *
+     * @param path Путь к узлу конфигурационного файла. Ключи разделяются
+     * точкой
+     *
+     * @return Узел конфигурационного файла в виде текста или пустая строка,
+     * если узел отсутствует
+     */
+    [[nodiscard]] std::string String(std::string_view path) const noexcept;
+
     Config(const Config &) = delete;
     Config(Config &&) = delete;
     Config &operator=(const Config &) = delete;
@@ -186,10 +315,47 @@ public:
     [[nodiscard]] Type Get(std::string_view path,
                            const Type &default_value = {}) const noexcept;
 
+    /**
+     * @brief Обход элементов последовательности.
+     *
+     * Функция обработки вызывается для каждого элемента по порядку без
+     * создания массива. Для типа std::string_view элемент передается без
+     * копирования и действителен внутри функции обработки: снимок
+     * конфигурационного файла сохраняется до завершения обхода. Элементы,
+     * которые не удалось преобразовать к типу, пропускаются.
+     *
+     * @param path Полный путь к последовательности
+     * @param callback Функция обработки элемента
+     *
+     * @return Количество обработанных элементов. Если параметр отсутствует
+     * или не является последовательностью - 0
+     */
+    template<typename Type>
+    std::size_t ForEach(
+        std::string_view path,
+        const std::function<void(const Type &)> &callback) const noexcept;
+
+    /**
+     * @brief Запрос строкового значения без копирования.
+     *
+     * @param path Полный путь к значению
+     * @param default_value Значение по умолчанию. Должно существовать, пока
+     * используется результат
+     *
+     * @return Значение из конфигурационного файла или значение по умолчанию,
+     * если параметр отсутствует или не является скалярным
+     */
+    [[nodiscard]] ConfigView GetView(
+        std::string_view path,
+        std::string_view default_value = {}) const noexcept;
+
     /**
      * @brief Перезагрузка конфигурационного файла.
      *
-     * Конфигурационный файл перечитывает. Вся старая информация удаляется.
+     * Конфигурационный файл перечитывается в новый снимок, который заменяет
+     * текущий целиком. Чтение параметров из других потоков во время
+     * перезагрузки не блокируется. Если основной конфигурационный файл не
+     * найден или содержит ошибки, сохраняются ранее загруженные параметры.
      */
     void Reload() noexcept;
 
@@ -200,12 +366,82 @@ public:
      */
     [[nodiscard]] std::string String() const noexcept;
 
+    /**
+     * @brief Конвертация части конфигурационного файла в текстовый формат.
+     *
+     * @param path Путь к узлу конфигурационного файла. Ключи разделяются
+     * точкой
+     *
+     * @return Узел конфигурационного файла в виде текста или пустая строка,
+     * если узел отсутствует
+     */
+    [[nodiscard]] std::string String(std::string_view path) const noexcept;
+
+    /**
+     * @brief Включение отслеживания изменений конфигурационного файла.
+     *
+     * Отдельный поток через inotify отслеживает основной конфигурационный
+     * файл и все файлы из параметра include. После серии изменений файлы
+     * перечитываются, когда изменения прекращаются на время задержки, и
+     * функция оповещения вызывается, только если содержимое файлов отличается
+     * от загруженного. Перезагрузка файла функцией оповещения не выполняется.
+     *
+     * Повторный вызов заменяет ранее запущенное отслеживание. Функция не
+     * потокобезопасная.
+     *
+     * @param callback Функция оповещения. Вызывается из потока отслеживания.
+     * Пустая функция - отслеживание выключается
+     * @param debounce Задержка проверки содержимого после последнего
+     * изменения
+     */
+    void Watch(const std::function<void()> &callback,
+               std::chrono::milliseconds debounce =
+                   std::chrono::milliseconds{500}) noexcept;
+
+    /**
+     * @brief Подписка на изменение части конфигурационного файла.
+     *
+     * При перезагрузке (@ref Reload) новый снимок сравнивается с предыдущим
+     * по каждому параметру, и функция оповещения вызывается, только если
+     * изменился узел prefix или любой вложенный в него параметр. Функции
+     * оповещения вызываются из потока, выполняющего перезагрузку, после замены
+     * снимка и без захваченных блокировок перезагрузки: из функции оповещения
+     * можно перезагружать конфигурационный файл и изменять подписки.
+     *
+     * @param prefix Путь к узлу конфигурационного файла. Ключи разделяются
+     * точкой. Пустая строка - любое изменение
+     * @param callback Функция оповещения
+     *
+     * @return Подписка. Удаление подписки отменяет оповещения
+     */
+    [[nodiscard]] std::unique_ptr<ConfigSubscription> Subscribe(
+        std::string_view prefix,
+        const std::function<void()> &callback) noexcept;
+
+    /**
+     * @brief Подписка на изменение нескольких частей конфигурационного файла.
+     *
+     * Функция оповещения вызывается при перезагрузке один раз, даже если
+     * изменились несколько узлов из списка.
+     *
+     * @param prefixes Пути к узлам конфигурационного файла
+     * @param callback Функция оповещения
+     *
+     * @return Подписка. Удаление подписки отменяет оповещения
+     */
+    [[nodiscard]] std::unique_ptr<ConfigSubscription> Subscribe(
+        std::initializer_list<std::string_view> prefixes,
+        const std::function<void()> &callback) noexcept;
+
     ConfigGlobal(const ConfigGlobal &) = delete;
     ConfigGlobal(ConfigGlobal &&) = delete;
     ConfigGlobal &operator=(const ConfigGlobal &) = delete;
     ConfigGlobal &operator=(ConfigGlobal &&) = delete;
 
 private:
+    template<typename Type>
+    friend class ConfigKey;
+
     /**
      * @brief Конструктор.
      *
@@ -227,6 +463,105 @@ private:
     std::unique_ptr<ConfigGlobalImpl> impl_;
 };
 
+/**
+ * @brief Подписка на изменение части глобального конфигурационного файла.
+ *
+ * Создается функцией ConfigGlobal::Subscribe.
+ *
+ * Класс скрывает от пользователя реализацию с помощью идиомы PIMPL
+ * (Pointer to Implementation – указатель на реализацию).
+ */
+class [[gnu::visibility("default")]] ConfigSubscription final
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * @param impl Реализация подписки
+     */
+    explicit ConfigSubscription(
+        std::unique_ptr<ConfigSubscriptionImpl> impl) noexcept;
+
+    /**
+     * @brief Деструктор. Отменяет подписку.
+     *
+     * Если функция оповещения выполняется в другом потоке, ожидает ее
+     * завершения.
+     */
+    ~ConfigSubscription() noexcept;
+
+    ConfigSubscription(const ConfigSubscription &) = delete;
+    ConfigSubscription(ConfigSubscription &&) = delete;
+    ConfigSubscription &operator=(const ConfigSubscription &) = delete;
+    ConfigSubscription &operator=(ConfigSubscription &&) = delete;
+
+private:
+    /**
+     * @brief Указатель на реализацию.
+     */
+    std::unique_ptr<ConfigSubscriptionImpl> impl_;
+};
+
+/**
+ * @brief Ключ глобального конфигурационного файла с кэшированием значения.
+ *
+ * Класс скрывает от пользователя реализацию с помощью идиомы PIMPL
+ * (Pointer to Implementation – указатель на реализацию).
+ *
+ * Путь к значению разбирается один раз при создании ключа. Значение
+ * запрашивается из конфигурационного файла при первом вызове @ref Get и
+ * сохраняется вместе с номером загрузки конфигурационного файла. Пока
+ * конфигурационный файл не перезагружен, @ref Get возвращает сохраненное
+ * значение без обращения к конфигурационному файлу.
+ *
+ * Предназначен для значений, которые читаются часто (например, при обработке
+ * каждого запроса):
+ *
+ * @code
+ * static const tasp::ConfigKey<int> timeout{"server.timeout", 30};
+ * const int value{timeout.Get()};
+ * @endcode
+ *
+ * Поддерживаются те же типы, что и в @ref ConfigGlobal::Get. Функция @ref Get
+ * может вызываться из разных потоков.
+ */
+template<typename Type>
+class [[gnu::visibility("default")]] ConfigKey final
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * @param path Полный путь к значению. Ключи разделяются точкой
+     * @param default_value Значение по умолчанию
+     */
+    explicit ConfigKey(std::string_view path,
+                       const Type &default_value = {}) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~ConfigKey() noexcept;
+
+    /**
+     * @brief Запрос значения из глобального конфигурационного файла.
+     *
+     * @return Значение из конфигурационного файла или значение по умолчанию
+     */
+    [[nodiscard]] Type Get() const noexcept;
+
+    ConfigKey(const ConfigKey &) = delete;
+    ConfigKey(ConfigKey &&) = delete;
+    ConfigKey &operator=(const ConfigKey &) = delete;
+    ConfigKey &operator=(ConfigKey &&) = delete;
+
+private:
+    /**
+     * @brief Указатель на реализацию.
+     */
+    std::unique_ptr<ConfigKeyImpl<Type>> impl_;
+};
+
 }  // namespace tasp
 
 #endif  // TASP_CONFIG_HPP_
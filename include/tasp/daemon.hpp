@@ -16,7 +16,8 @@ class DaemonImpl;
  * @brief Интерфейс для создания демона.
  *
  * Сигналы завершающие выполнение: SIGINT, SIGTERM, SIGQUIT, SIGKILL
- * Сигналы для обновление конфигурации: SIGUSR1, SIGUSR2
+ * Сигналы для обновление конфигурации: SIGUSR1, SIGUSR2. Логи при этом
+ * переоткрываются.
  *
  * Класс скрывает от пользователя реализацию с помощью идиомы PIMPL
  * (Pointer to Implementation – указатель на реализацию).
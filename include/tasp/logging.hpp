@@ -5,13 +5,19 @@
 #ifndef TASP_LOGGING_HPP_
 #define TASP_LOGGING_HPP_
 
+#include <jsoncpp/json/json.h>
+
 #include <any>
+#include <chrono>
 #include <experimental/source_location>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include "health.hpp"
+
 /**
  * @brief Убирание использования std::experimental.
  */
@@ -22,6 +28,9 @@ namespace tasp
 
 class LoggingImpl;
 class FormatWithLocationImpl;
+class BytesImpl;
+class LogSubscription;
+class LogSubscriptionImpl;
 
 /**
  * @brief Формат строки с локацией.
@@ -74,6 +83,91 @@ private:
     std::unique_ptr<FormatWithLocationImpl> impl_;
 };
 
+/**
+ * @brief Двоичные данные для вывода в лог.
+ *
+ * Данные копируются один раз при создании объекта, но не больше
+ * @ref Logging::BytesLimit байт. Копии объекта используют общие данные.
+ * В сообщении данные выводятся в виде шестнадцатеричного дампа с текстовым
+ * представлением. Дамп формируется в потоке обработки логов.
+ *
+ * Пример:
+ * @code
+ * Logging::Debug("Получен кадр {}", Bytes{frame.data(), frame.size()});
+ * Logging::Debug("Получен кадр {}", Bytes{frame});
+ * @endcode
+ *
+ * Класс скрывает от пользователя реализацию с помощью идиомы PIMPL
+ * (Pointer to Implementation – указатель на реализацию).
+ */
+class [[gnu::visibility("default")]] Bytes final
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * @param data Указатель на данные
+     * @param size Размер данных в байтах
+     */
+    Bytes(const void *data, std::size_t size) noexcept;
+
+    /**
+     * @brief Конструктор из непрерывного контейнера (std::vector,
+     * std::array, std::string и т.п.).
+     *
+     * @param container Контейнер с данными
+     */
+    template<class Container,
+             class = decltype(std::data(std::declval<const Container &>()))>
+    explicit Bytes(const Container &container) noexcept
+    : Bytes(std::data(container),
+            std::size(container) * sizeof(*std::data(container)))
+    {
+    }
+
+    /**
+     * @brief Конструктор копирования. Данные не копируются.
+     *
+     * @param bytes Двоичные данные
+     */
+    Bytes(const Bytes &bytes) noexcept;
+
+    /**
+     * @brief Конструктор перемещения.
+     *
+     * @param bytes Двоичные данные
+     */
+    Bytes(Bytes &&bytes) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~Bytes() noexcept;
+
+    /**
+     * @brief Запрос скопированных данных.
+     *
+     * @return Данные (не больше @ref Logging::BytesLimit байт)
+     */
+    [[nodiscard]] std::string_view Data() const noexcept;
+
+    /**
+     * @brief Запрос исходного размера данных.
+     *
+     * @return Размер данных в байтах
+     */
+    [[nodiscard]] std::size_t Size() const noexcept;
+
+    Bytes &operator=(const Bytes &) = delete;
+    Bytes &operator=(Bytes &&) = delete;
+
+private:
+    /**
+     * @brief Указатель на реализацию.
+     */
+    std::shared_ptr<const BytesImpl> impl_;
+};
+
 /**
  * @brief Интерфейс единого вывода сообщений во все типы логов.
  *
@@ -151,6 +245,44 @@ public:
             const std::vector<std::any> &params = {}) noexcept;
     // clang-format on
 
+    /**
+     * @brief Запрос максимального размера двоичных данных, копируемых в
+     * сообщение (параметр logging.bytes.max_size).
+     *
+     * @return Размер в байтах
+     */
+    [[nodiscard]] std::size_t BytesLimit() const noexcept;
+
+    /**
+     * @brief Запуск логирования.
+     *
+     * До запуска логи не открываются, а сообщения накапливаются в буфере
+     * фиксированного размера. При запуске создается поток обработки, который
+     * открывает логи по глобальному конфигурационному файлу и выводит в них
+     * накопленные сообщения. Функция не ожидает открытия логов.
+     *
+     * Вызывается автоматически после загрузки глобального конфигурационного
+     * файла, а также при перезагрузке и принудительном выводе. Если
+     * логирование так и не было запущено, при завершении программы
+     * накопленные сообщения выводятся в стандартный вывод ошибок. Повторные
+     * вызовы игнорируются.
+     */
+    void Start() noexcept;
+
+    /**
+     * @brief Остановка логирования.
+     *
+     * Выводит накопленные сообщения и завершает поток обработки, после чего
+     * глобальный конфигурационный файл больше не читается. Сообщения,
+     * добавленные после остановки, выводятся при принудительном выводе в
+     * вызывающем потоке, а оставшиеся - при завершении программы в
+     * стандартный вывод ошибок.
+     *
+     * Вызывается автоматически перед удалением глобального
+     * конфигурационного файла. Повторные вызовы игнорируются.
+     */
+    void Stop() noexcept;
+
     /**
      * @brief Перезагрузка логирования.
      *
@@ -159,6 +291,93 @@ public:
      */
     void Reload() noexcept;
 
+    /**
+     * @brief Переоткрытие логов.
+     *
+     * Выполняет перезагрузку логирования, при которой все логи создаются
+     * заново, даже если их параметры не изменились. Используется после
+     * ротации файлов логов внешней программой (например, logrotate).
+     */
+    void Reopen() noexcept;
+
+    /**
+     * @brief Принудительный вывод накопленных сообщений в логи.
+     *
+     * Блокирует вызывающий поток, пока все сообщения, добавленные до вызова
+     * функции, не будут выведены во все открытые логи, или пока не истечет
+     * время ожидания. Если логирование не запускалось (@ref Start), не
+     * запускает его и выводит накопленные сообщения в стандартный вывод
+     * ошибок.
+     *
+     * @param timeout Максимальное время ожидания
+     *
+     * @return Все ли сообщения были выведены за время ожидания
+     */
+    bool Flush(std::chrono::milliseconds timeout = std::chrono::seconds{
+                   5}) noexcept;
+
+    /**
+     * @brief Аварийный вывод при падении программы.
+     *
+     * Предназначена для вызова из обработчика сигнала: использует только
+     * async-signal-safe функции и не захватывает блокировки. Записывает в
+     * файловые логи выводимую в момент падения пачку и сообщения,
+     * накопленные в очереди, а в них и в стандартный вывод ошибок - сообщение
+     * о падении и стек вызовов. После вызова новые сообщения не
+     * добавляются в очередь.
+     *
+     * @param signum Номер сигнала, вызвавшего падение
+     */
+    void Emergency(int signum) noexcept;
+
+    /**
+     * @brief Запрос статистики работы логов.
+     *
+     * Для файловых логов выводится режим синхронизации с устройством хранения,
+     * количество синхронизаций, среднее и максимальное время синхронизации
+     * (мкс) и количество сообщений за одну синхронизацию. Для всех логов
+     * выводится гистограмма времени записи пачек сообщений. Для очереди -
+     * текущее и максимальное количество не выведенных сообщений, скорость
+     * добавления, размеры пачек и количество отброшенных сообщений.
+     *
+     * @return Статистика в формате Json::Value
+     */
+    [[nodiscard]] Json::Value Statistics() const noexcept;
+
+    /**
+     * @brief Запрос состояния логирования.
+     *
+     * Состояние Warning - логирование не запущено или очередь сообщений
+     * (файл временного хранения) заполнена больше чем на 80%. Состояние
+     * Error - с предыдущего запроса были отброшены сообщения, не выведенные в
+     * логи, или поток обработки остановлен. В сообщении отчета указывается количество
+     * сообщений в очереди и скорость их добавления.
+     *
+     * @return Отчет о состоянии с названием "logging"
+     */
+    [[nodiscard]] HealthReport Health() const noexcept;
+
+    /**
+     * @brief Подписка на сообщения лога.
+     *
+     * Поток обработки передает подписчику сообщения через ограниченный буфер
+     * без блокировки: если подписчик не успевает читать сообщения, новые
+     * сообщения отбрасываются и учитываются в счетчике отброшенных.
+     *
+     * Подписка действует, пока существует возвращенный объект.
+     *
+     * @param level Минимальный уровень передаваемых сообщений
+     * @param source Начало названия файла передаваемых сообщений. Пустая
+     * строка - сообщения из всех файлов
+     * @param capacity Максимальное количество сообщений в буфере подписчика
+     *
+     * @return Подписка
+     */
+    [[nodiscard]] std::unique_ptr<LogSubscription> Subscribe(
+        Level level = Level::Debug,
+        std::string_view source = {},
+        std::size_t capacity = 1024) noexcept;
+
     Logging(const Logging &) = delete;
     Logging(Logging &&) = delete;
     Logging &operator=(const Logging &) = delete;
@@ -181,6 +400,110 @@ private:
     std::unique_ptr<LoggingImpl> impl_;
 };
 
+/**
+ * @brief Подписка на сообщения лога.
+ *
+ * Создается функцией Logging::Subscribe. Чтение сообщений должно выполняться
+ * из одного потока.
+ *
+ * Класс скрывает от пользователя реализацию с помощью идиомы PIMPL
+ * (Pointer to Implementation – указатель на реализацию).
+ */
+class [[gnu::visibility("default")]] LogSubscription final
+{
+public:
+    /**
+     * @brief Сообщение лога.
+     */
+    struct Record
+    {
+        /**
+         * @brief Уровень сообщения.
+         */
+        Logging::Level level{Logging::Level::None};
+
+        /**
+         * @brief Дата и время в формате ГГГГ-ММ-ДД ЧЧ:ММ:СС.
+         */
+        std::string timestamp;
+
+        /**
+         * @brief Название файла.
+         */
+        std::string source;
+
+        /**
+         * @brief Номер строки.
+         */
+        unsigned int line{0};
+
+        /**
+         * @brief Идентификатор потока в формате [0xНОМЕР_ПОТОКА].
+         */
+        std::string thread_id;
+
+        /**
+         * @brief Сообщение.
+         */
+        std::string message;
+
+        /**
+         * @brief Порядковый номер сообщения.
+         */
+        std::uint64_t sequence{0};
+    };
+
+    /**
+     * @brief Конструктор.
+     *
+     * @param impl Реализация подписки
+     */
+    explicit LogSubscription(std::unique_ptr<LogSubscriptionImpl> impl) noexcept;
+
+    /**
+     * @brief Деструктор. Отменяет подписку.
+     */
+    ~LogSubscription() noexcept;
+
+    /**
+     * @brief Чтение сообщения без ожидания.
+     *
+     * @param record Прочитанное сообщение
+     *
+     * @return Результат чтения. false - новых сообщений нет
+     */
+    bool Pop(Record &record) noexcept;
+
+    /**
+     * @brief Чтение сообщения с ожиданием.
+     *
+     * @param record Прочитанное сообщение
+     * @param timeout Максимальное время ожидания
+     *
+     * @return Результат чтения. false - за время ожидания сообщений не было
+     */
+    bool Wait(Record &record, std::chrono::milliseconds timeout) noexcept;
+
+    /**
+     * @brief Запрос количества сообщений, отброшенных из-за переполнения
+     * буфера подписчика.
+     *
+     * @return Количество сообщений
+     */
+    [[nodiscard]] std::uint64_t Dropped() const noexcept;
+
+    LogSubscription(const LogSubscription &) = delete;
+    LogSubscription(LogSubscription &&) = delete;
+    LogSubscription &operator=(const LogSubscription &) = delete;
+    LogSubscription &operator=(LogSubscription &&) = delete;
+
+private:
+    /**
+     * @brief Указатель на реализацию.
+     */
+    std::unique_ptr<LogSubscriptionImpl> impl_;
+};
+
 }  // namespace tasp
 
 #endif  // TASP_LOGGING_HPP_
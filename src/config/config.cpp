@@ -1,14 +1,48 @@
 #include "tasp/config.hpp"
 
 #include "config_impl.hpp"
+#include "tasp/logging.hpp"
 
 using std::make_unique;
+using std::shared_ptr;
+using std::size_t;
 using std::string;
 using std::string_view;
+using std::vector;
 
 namespace tasp
 {
 
+/*------------------------------------------------------------------------------
+    ConfigView
+------------------------------------------------------------------------------*/
+ConfigView::ConfigView(shared_ptr<const void> owner, string_view value) noexcept
+: owner_(std::move(owner))
+, value_(value)
+{
+}
+
+//------------------------------------------------------------------------------
+ConfigView::~ConfigView() noexcept = default;
+
+//------------------------------------------------------------------------------
+ConfigView::ConfigView(const ConfigView &) noexcept = default;
+
+//------------------------------------------------------------------------------
+ConfigView::ConfigView(ConfigView &&) noexcept = default;
+
+//------------------------------------------------------------------------------
+ConfigView &ConfigView::operator=(const ConfigView &) noexcept = default;
+
+//------------------------------------------------------------------------------
+ConfigView &ConfigView::operator=(ConfigView &&) noexcept = default;
+
+//------------------------------------------------------------------------------
+string_view ConfigView::Value() const noexcept
+{
+    return value_;
+}
+
 /*------------------------------------------------------------------------------
     Config
 ------------------------------------------------------------------------------*/
@@ -33,6 +67,24 @@ Type Config::Get(string_view path, const Type &default_value) const noexcept
     return impl_->Get(ConfigNodePath(path), default_value);
 }
 
+//------------------------------------------------------------------------------
+template<typename Type>
+size_t Config::ForEach(
+    string_view path,
+    const std::function<void(const Type &)> &callback) const noexcept
+{
+    return impl_->ForEach(ConfigNodePath(path), callback);
+}
+
+//------------------------------------------------------------------------------
+ConfigView Config::GetView(string_view path,
+                           string_view default_value) const noexcept
+{
+    string_view value{default_value};
+    impl_->GetView(ConfigNodePath(path), value);
+    return ConfigView{nullptr, value};
+}
+
 //------------------------------------------------------------------------------
 template<typename Type>
 void Config::Set(string_view path, const Type &value) noexcept
@@ -58,6 +110,24 @@ bool Config::Save() const noexcept
     return impl_->Save();
 }
 
+//------------------------------------------------------------------------------
+void Config::Begin() noexcept
+{
+    impl_->Begin();
+}
+
+//------------------------------------------------------------------------------
+bool Config::Commit() noexcept
+{
+    return impl_->Commit();
+}
+
+//------------------------------------------------------------------------------
+void Config::Rollback() noexcept
+{
+    impl_->Rollback();
+}
+
 //------------------------------------------------------------------------------
 void Config::Reload() noexcept
 {
@@ -76,12 +146,42 @@ string Config::String() const noexcept
     return impl_->String();
 }
 
+//------------------------------------------------------------------------------
+string Config::String(string_view path) const noexcept
+{
+    return impl_->String(ConfigNodePath(path));
+}
+
 /*------------------------------------------------------------------------------
     ConfigGlobal
 ------------------------------------------------------------------------------*/
 ConfigGlobal &ConfigGlobal::Instance(const fs::path &path) noexcept
 {
     static ConfigGlobal instance{path};
+
+    // Логи настраиваются по глобальному конфигурационному файлу, поэтому
+    // логирование запускается только после его загрузки. Объект удаляется
+    // раньше конфигурационного файла: до этого поток обработки логов
+    // останавливается, чтобы не читать удаленный файл, даже если объект
+    // логирования будет удален позже.
+    static const struct LoggingStart
+    {
+        LoggingStart() noexcept
+        {
+            Logging::Instance().Start();
+        }
+
+        ~LoggingStart() noexcept
+        {
+            Logging::Instance().Stop();
+        }
+
+        LoggingStart(const LoggingStart &) = delete;
+        LoggingStart(LoggingStart &&) = delete;
+        LoggingStart &operator=(const LoggingStart &) = delete;
+        LoggingStart &operator=(LoggingStart &&) = delete;
+    } logging{};
+
     return instance;
 }
 
@@ -93,6 +193,31 @@ Type ConfigGlobal::Get(string_view path,
     return impl_->Get(ConfigNodePath(path), default_value);
 }
 
+//------------------------------------------------------------------------------
+template<typename Type>
+size_t ConfigGlobal::ForEach(
+    string_view path,
+    const std::function<void(const Type &)> &callback) const noexcept
+{
+    return impl_->ForEach(ConfigNodePath(path), callback);
+}
+
+//------------------------------------------------------------------------------
+ConfigView ConfigGlobal::GetView(string_view path,
+                                 string_view default_value) const noexcept
+{
+    // Значение ссылается на память снимка, поэтому снимок сохраняется вместе
+    // с ним.
+    auto snapshot{impl_->Snapshot()};
+    string_view value{};
+    if (!snapshot->GetView(ConfigNodePath(path), value))
+    {
+        return ConfigView{nullptr, default_value};
+    }
+
+    return ConfigView{std::move(snapshot), value};
+}
+
 //------------------------------------------------------------------------------
 void ConfigGlobal::Reload() noexcept
 {
@@ -105,6 +230,39 @@ string ConfigGlobal::String() const noexcept
     return impl_->String();
 }
 
+//------------------------------------------------------------------------------
+string ConfigGlobal::String(string_view path) const noexcept
+{
+    return impl_->String(ConfigNodePath(path));
+}
+
+//------------------------------------------------------------------------------
+void ConfigGlobal::Watch(const std::function<void()> &callback,
+                         std::chrono::milliseconds debounce) noexcept
+{
+    impl_->Watch(callback, debounce);
+}
+
+//------------------------------------------------------------------------------
+std::unique_ptr<ConfigSubscription> ConfigGlobal::Subscribe(
+    string_view prefix,
+    const std::function<void()> &callback) noexcept
+{
+    return make_unique<ConfigSubscription>(make_unique<ConfigSubscriptionImpl>(
+        *impl_, impl_->Subscribe({string{prefix}}, callback)));
+}
+
+//------------------------------------------------------------------------------
+std::unique_ptr<ConfigSubscription> ConfigGlobal::Subscribe(
+    std::initializer_list<string_view> prefixes,
+    const std::function<void()> &callback) noexcept
+{
+    return make_unique<ConfigSubscription>(make_unique<ConfigSubscriptionImpl>(
+        *impl_,
+        impl_->Subscribe(vector<string>(prefixes.begin(), prefixes.end()),
+                         callback)));
+}
+
 //------------------------------------------------------------------------------
 ConfigGlobal::ConfigGlobal(const fs::path &path) noexcept
 : impl_(make_unique<ConfigGlobalImpl>(path))
@@ -114,15 +272,59 @@ ConfigGlobal::ConfigGlobal(const fs::path &path) noexcept
 //------------------------------------------------------------------------------
 ConfigGlobal::~ConfigGlobal() noexcept = default;
 
+/*------------------------------------------------------------------------------
+    ConfigSubscription
+------------------------------------------------------------------------------*/
+ConfigSubscription::ConfigSubscription(
+    std::unique_ptr<ConfigSubscriptionImpl> impl) noexcept
+: impl_(std::move(impl))
+{
+}
+
+//------------------------------------------------------------------------------
+ConfigSubscription::~ConfigSubscription() noexcept = default;
+
+/*------------------------------------------------------------------------------
+    ConfigKey
+------------------------------------------------------------------------------*/
+template<typename Type>
+ConfigKey<Type>::ConfigKey(string_view path, const Type &default_value) noexcept
+: impl_(make_unique<ConfigKeyImpl<Type>>(*ConfigGlobal::Instance().impl_,
+                                         path,
+                                         default_value))
+{
+}
+
+//------------------------------------------------------------------------------
+template<typename Type>
+ConfigKey<Type>::~ConfigKey() noexcept = default;
+
+//------------------------------------------------------------------------------
+template<typename Type>
+Type ConfigKey<Type>::Get() const noexcept
+{
+    return impl_->Get();
+}
+
 //------------------------------------------------------------------------------
 /// \cond NOPE
+#define init_foreach_function(type)                                         \
+    template __attribute__((visibility("default"))) size_t Config::ForEach( \
+        string_view path,                                                   \
+        const std::function<void(const type &)> &callback) const noexcept;  \
+    template __attribute__((visibility("default"))) size_t                  \
+    ConfigGlobal::ForEach(                                                  \
+        string_view path,                                                   \
+        const std::function<void(const type &)> &callback) const noexcept;
 #define init_template_function(type)                                        \
+    init_foreach_function(type)                                             \
     template __attribute__((visibility("default"))) void Config::Set(       \
         string_view path, const type &default_value) noexcept;              \
     template __attribute__((visibility("default"))) type Config::Get(       \
         string_view path, const type &default_value) const noexcept;        \
     template __attribute__((visibility("default"))) type ConfigGlobal::Get( \
-        string_view path, const type &default_value) const noexcept;
+        string_view path, const type &default_value) const noexcept;        \
+    template class __attribute__((visibility("default"))) ConfigKey<type>;
 // clang-format off
 init_template_function(bool)
 init_template_function(int)
@@ -135,9 +337,11 @@ init_template_function(fs::path)
 init_template_function(std::vector<string>)
 init_template_function(std::vector<int>)
 init_template_function(std::chrono::seconds)
+init_foreach_function(string_view)
 // clang-format on
 /// \endcond
 
 #undef init_template_function
+#undef init_foreach_function
 
 }  // namespace tasp
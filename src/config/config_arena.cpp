@@ -0,0 +1,688 @@
+#include "config_arena.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "config_impl.hpp"
+
+using std::length_error;
+using std::shared_ptr;
+using std::size_t;
+using std::string;
+using std::string_view;
+using std::uint32_t;
+using std::uint64_t;
+using std::unordered_map;
+using std::vector;
+
+namespace tasp
+{
+/*------------------------------------------------------------------------------
+    ConfigArena::Builder
+------------------------------------------------------------------------------*/
+class ConfigArena::Builder final
+{
+public:
+    /**
+     * @brief Добавление узла и всех вложенных узлов.
+     *
+     * Узлы добавляются в прямом порядке обхода: вложенные узлы следуют за
+     * родительским.
+     *
+     * @param node Узел
+     *
+     * @return Номер узла
+     *
+     * @throw YAML::Exception При ошибке доступа к узлу
+     */
+    uint32_t AddNode(const YAML::Node &node)
+    {
+        const uint32_t index{Count(nodes_.size() + 1) - 1};
+        nodes_.push_back({});
+
+        Node entry{};
+        entry.type = static_cast<uint8_t>(node.Type());
+        entry.style = static_cast<uint8_t>(node.Style());
+        entry.tag = AddString(node.Tag());
+
+        vector<uint32_t> children{};
+        switch (node.Type())
+        {
+            case YAML::NodeType::Scalar:
+                entry.first = AddString(node.Scalar());
+                break;
+
+            case YAML::NodeType::Sequence:
+                for (const auto &child : node)
+                {
+                    children.push_back(AddNode(child));
+                }
+                entry.size = Count(children.size());
+                break;
+
+            case YAML::NodeType::Map:
+            {
+                for (const auto &child : node)
+                {
+                    children.push_back(AddNode(child.first));
+                    children.push_back(AddNode(child.second));
+                }
+                entry.size = Count(children.size() / 2);
+
+                // Порядок пар по возрастанию ключей. При совпадении ключей
+                // первой остается пара, встреченная раньше, как при поиске
+                // yaml-cpp. Ключи сравниваются после добавления всех узлов:
+                // область символов при добавлении перераспределяется.
+                const auto key = [this, &children](uint32_t pair)
+                { return Key(children[2 * pair]); };
+
+                vector<uint32_t> order(entry.size);
+                std::iota(order.begin(), order.end(), 0);
+                std::stable_sort(order.begin(),
+                                 order.end(),
+                                 [&key](uint32_t left, uint32_t right)
+                                 { return key(left) < key(right); });
+                children.insert(children.end(), order.begin(), order.end());
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        if (!children.empty())
+        {
+            entry.first = Count(children_.size());
+            children_.insert(children_.end(), children.begin(), children.end());
+            Count(children_.size());
+        }
+
+        nodes_[index] = entry;
+        return index;
+    }
+
+    /**
+     * @brief Формирование образа.
+     *
+     * @return Образ
+     */
+    [[nodiscard]] string Image() const
+    {
+        const Header header{Count(nodes_.size()),
+                            Count(children_.size()),
+                            Count(strings_.size()),
+                            Count(characters_.size())};
+
+        string image{};
+        image.reserve(sizeof(header) + nodes_.size() * sizeof(Node) +
+                      children_.size() * sizeof(uint32_t) +
+                      strings_.size() * sizeof(String) + characters_.size());
+
+        const auto append = [&image](const auto &elements)
+        {
+            image.append(reinterpret_cast<const char *>(elements.data()),
+                         elements.size() * sizeof(elements.front()));
+        };
+
+        image.append(reinterpret_cast<const char *>(&header), sizeof(header));
+        append(nodes_);
+        append(children_);
+        append(strings_);
+        append(characters_);
+
+        return image;
+    }
+
+private:
+    /**
+     * @brief Добавление строки.
+     *
+     * Одинаковые строки хранятся в одном экземпляре.
+     *
+     * @param text Строка
+     *
+     * @return Номер строки
+     */
+    uint32_t AddString(const string &text)
+    {
+        const auto found{indexes_.find(text)};
+        if (found != indexes_.end())
+        {
+            return found->second;
+        }
+
+        const uint32_t index{Count(strings_.size())};
+        strings_.push_back({Count(characters_.size()), Count(text.size())});
+        characters_ += text;
+        Count(characters_.size());
+        indexes_.emplace(text, index);
+
+        return index;
+    }
+
+    /**
+     * @brief Запрос ключа пары словаря.
+     *
+     * @param node Номер узла ключа
+     *
+     * @return Ключ. Для нескалярного ключа - пустая строка
+     */
+    [[nodiscard]] string_view Key(uint32_t node) const
+    {
+        if (nodes_[node].type != YAML::NodeType::Scalar)
+        {
+            return {};
+        }
+
+        const String &text{strings_[nodes_[node].first]};
+        return string_view{characters_}.substr(text.offset, text.size);
+    }
+
+    /**
+     * @brief Проверка, что количество помещается в формат образа.
+     *
+     * @param count Количество
+     *
+     * @return Количество
+     *
+     * @throw std::length_error Если количество не помещается в формат
+     */
+    static uint32_t Count(size_t count)
+    {
+        if (count > std::numeric_limits<uint32_t>::max())
+        {
+            throw length_error("конфигурационный файл слишком большой");
+        }
+        return static_cast<uint32_t>(count);
+    }
+
+    /**
+     * @brief Узлы.
+     */
+    vector<Node> nodes_;
+
+    /**
+     * @brief Ссылки на вложенные узлы.
+     */
+    vector<uint32_t> children_;
+
+    /**
+     * @brief Строки.
+     */
+    vector<String> strings_;
+
+    /**
+     * @brief Область символов строк.
+     */
+    string characters_;
+
+    /**
+     * @brief Номера добавленных строк.
+     */
+    unordered_map<string, uint32_t> indexes_;
+};
+
+/*------------------------------------------------------------------------------
+    ConfigArena
+------------------------------------------------------------------------------*/
+ConfigArena::ConfigArena(string image) noexcept
+{
+    auto owned{std::make_shared<const string>(std::move(image))};
+    image_ = *owned;
+    storage_ = std::move(owned);
+
+    Map();
+}
+
+//------------------------------------------------------------------------------
+ConfigArena::ConfigArena(shared_ptr<const void> storage,
+                         string_view image) noexcept
+: storage_(std::move(storage))
+, image_(image)
+{
+    Map();
+}
+
+//------------------------------------------------------------------------------
+ConfigArena::~ConfigArena() noexcept = default;
+
+//------------------------------------------------------------------------------
+string ConfigArena::Build(const YAML::Node &document)
+{
+    Builder builder{};
+    builder.AddNode(document);
+    return builder.Image();
+}
+
+//------------------------------------------------------------------------------
+bool ConfigArena::Valid() const noexcept
+{
+    return header_ != nullptr;
+}
+
+//------------------------------------------------------------------------------
+string_view ConfigArena::Image() const noexcept
+{
+    return image_;
+}
+
+//------------------------------------------------------------------------------
+bool ConfigArena::Find(const ConfigNodePath &path, uint32_t &node) const noexcept
+{
+    uint32_t current{0};
+    for (const auto &key : path)
+    {
+        if (!Lookup(current, key, current))
+        {
+            return false;
+        }
+    }
+
+    node = current;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+YAML::NodeType::value ConfigArena::Type(uint32_t node) const noexcept
+{
+    return static_cast<YAML::NodeType::value>(nodes_[node].type);
+}
+
+//------------------------------------------------------------------------------
+string_view ConfigArena::Scalar(uint32_t node) const noexcept
+{
+    const Node &entry{nodes_[node]};
+    return entry.type == YAML::NodeType::Scalar ? Text(entry.first)
+                                                : string_view{};
+}
+
+//------------------------------------------------------------------------------
+uint32_t ConfigArena::Size(uint32_t node) const noexcept
+{
+    const Node &entry{nodes_[node]};
+    return entry.type == YAML::NodeType::Sequence ||
+                   entry.type == YAML::NodeType::Map
+               ? entry.size
+               : 0;
+}
+
+//------------------------------------------------------------------------------
+uint32_t ConfigArena::Child(uint32_t node, uint32_t index) const noexcept
+{
+    const Node &entry{nodes_[node]};
+    return entry.type == YAML::NodeType::Map
+               ? children_[entry.first + 2 * index + 1]
+               : children_[entry.first + index];
+}
+
+//------------------------------------------------------------------------------
+string_view ConfigArena::Key(uint32_t node, uint32_t index) const noexcept
+{
+    return Scalar(children_[nodes_[node].first + 2 * index]);
+}
+
+//------------------------------------------------------------------------------
+YAML::Node ConfigArena::Restore(uint32_t node) const
+{
+    const Node &entry{nodes_[node]};
+
+    YAML::Node result{};
+    switch (static_cast<YAML::NodeType::value>(entry.type))
+    {
+        case YAML::NodeType::Scalar:
+            result = YAML::Node{string{Text(entry.first)}};
+            break;
+
+        case YAML::NodeType::Sequence:
+            result = YAML::Node{YAML::NodeType::Sequence};
+            for (uint32_t i{0}; i < entry.size; ++i)
+            {
+                result.push_back(Restore(children_[entry.first + i]));
+            }
+            break;
+
+        case YAML::NodeType::Map:
+            result = YAML::Node{YAML::NodeType::Map};
+            // Ключи уникальны, поэтому добавляются без поиска.
+            for (uint32_t i{0}; i < entry.size; ++i)
+            {
+                const uint32_t position{entry.first + 2 * i};
+                result.force_insert(Restore(children_[position]),
+                                    Restore(children_[position + 1]));
+            }
+            break;
+
+        default:
+            result = YAML::Node{YAML::NodeType::Null};
+            break;
+    }
+
+    result.SetTag(string{Text(entry.tag)});
+    result.SetStyle(static_cast<YAML::EmitterStyle::value>(entry.style));
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+vector<string> ConfigArena::Diff(const ConfigArena &other) const noexcept
+{
+    vector<string> changed{};
+    DiffNode(0, other, 0, {}, changed);
+    return changed;
+}
+
+//------------------------------------------------------------------------------
+bool ConfigArena::Map() noexcept
+{
+    if (image_.size() < sizeof(Header))
+    {
+        return false;
+    }
+
+    const auto *header{reinterpret_cast<const Header *>(image_.data())};
+
+    // Размеры вычисляются в 64-битной арифметике: значения из образа не
+    // превышают 2^32, переполнение невозможно.
+    const uint64_t nodes{sizeof(Header)};
+    const uint64_t children{nodes + uint64_t{header->nodes} * sizeof(Node)};
+    const uint64_t strings{children +
+                           uint64_t{header->children} * sizeof(uint32_t)};
+    const uint64_t characters{strings +
+                              uint64_t{header->strings} * sizeof(String)};
+    if (header->nodes == 0 || characters + header->characters != image_.size())
+    {
+        return false;
+    }
+
+    const char *data{image_.data()};
+    const auto *node_array{reinterpret_cast<const Node *>(data + nodes)};
+    const auto *child_array{reinterpret_cast<const uint32_t *>(data + children)};
+    const auto *string_array{reinterpret_cast<const String *>(data + strings)};
+
+    for (uint32_t i{0}; i < header->strings; ++i)
+    {
+        if (uint64_t{string_array[i].offset} + string_array[i].size >
+            header->characters)
+        {
+            return false;
+        }
+    }
+
+    // Ссылка на вложенный узел корректна, если узел следует за родительским:
+    // обход образа не может зациклиться.
+    const auto valid_child = [header, child_array](uint32_t parent,
+                                                   uint64_t position)
+    {
+        return child_array[position] > parent &&
+               child_array[position] < header->nodes;
+    };
+
+    for (uint32_t i{0}; i < header->nodes; ++i)
+    {
+        const Node &node{node_array[i]};
+        if (node.tag >= header->strings)
+        {
+            return false;
+        }
+
+        switch (static_cast<YAML::NodeType::value>(node.type))
+        {
+            case YAML::NodeType::Null:
+                break;
+
+            case YAML::NodeType::Scalar:
+                if (node.first >= header->strings)
+                {
+                    return false;
+                }
+                break;
+
+            case YAML::NodeType::Sequence:
+                if (uint64_t{node.first} + node.size > header->children)
+                {
+                    return false;
+                }
+                for (uint64_t j{0}; j < node.size; ++j)
+                {
+                    if (!valid_child(i, node.first + j))
+                    {
+                        return false;
+                    }
+                }
+                break;
+
+            case YAML::NodeType::Map:
+                if (uint64_t{node.first} + uint64_t{node.size} * 3 >
+                    header->children)
+                {
+                    return false;
+                }
+                for (uint64_t j{0}; j < uint64_t{node.size} * 2; ++j)
+                {
+                    if (!valid_child(i, node.first + j))
+                    {
+                        return false;
+                    }
+                }
+                for (uint64_t j{0}; j < node.size; ++j)
+                {
+                    if (child_array[node.first + 2 * uint64_t{node.size} + j] >=
+                        node.size)
+                    {
+                        return false;
+                    }
+                }
+                break;
+
+            default:
+                return false;
+        }
+    }
+
+    header_ = header;
+    nodes_ = node_array;
+    children_ = child_array;
+    strings_ = string_array;
+    characters_ = data + characters;
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+string_view ConfigArena::Text(uint32_t index) const noexcept
+{
+    const String &text{strings_[index]};
+    return {characters_ + text.offset, text.size};
+}
+
+//------------------------------------------------------------------------------
+bool ConfigArena::Lookup(uint32_t node,
+                         string_view key,
+                         uint32_t &child) const noexcept
+{
+    const Node &entry{nodes_[node]};
+    if (entry.type != YAML::NodeType::Map)
+    {
+        return false;
+    }
+
+    const uint32_t *order{children_ + entry.first + 2 * entry.size};
+    const uint32_t *end{order + entry.size};
+    const uint32_t *found{std::lower_bound(order,
+                                           end,
+                                           key,
+                                           [this, node](uint32_t pair,
+                                                        string_view text)
+                                           { return Key(node, pair) < text; })};
+
+    // Нескалярные ключи упорядочены как пустая строка и не совпадают с
+    // ключом пути.
+    for (; found != end && Key(node, *found) == key; ++found)
+    {
+        if (Type(children_[entry.first + 2 * *found]) ==
+            YAML::NodeType::Scalar)
+        {
+            child = Child(node, *found);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void ConfigArena::DiffNode(uint32_t node,
+                           const ConfigArena &other,
+                           uint32_t other_node,
+                           const string &path,
+                           vector<string> &changed) const noexcept
+{
+    const auto child_path = [&path](string_view key)
+    {
+        return path.empty() ? string{key} : path + '.' + string{key};
+    };
+    const auto dotted = [](string_view key)
+    { return key.find(ConfigNodePath::Delimiter()) != string_view::npos; };
+
+    if (Type(node) != YAML::NodeType::Map ||
+        other.Type(other_node) != YAML::NodeType::Map)
+    {
+        if (!Equal(node, other, other_node))
+        {
+            changed.push_back(path);
+            Collect(node, path, false, changed);
+            other.Collect(other_node, path, false, changed);
+        }
+        return;
+    }
+
+    // Параметры с разделителем в ключе недоступны по пути, поэтому
+    // сравниваются целиком и отмечаются путем к самому параметру.
+    for (uint32_t i{0}; i < Size(node); ++i)
+    {
+        const string_view key{Key(node, i)};
+        uint32_t other_child{0};
+        const bool found{other.Lookup(other_node, key, other_child)};
+
+        if (dotted(key))
+        {
+            if (!found || !Equal(Child(node, i), other, other_child))
+            {
+                changed.push_back(child_path(key));
+            }
+        }
+        else if (found)
+        {
+            DiffNode(Child(node, i), other, other_child, child_path(key), changed);
+        }
+        else
+        {
+            Collect(Child(node, i), child_path(key), true, changed);
+        }
+    }
+
+    for (uint32_t i{0}; i < other.Size(other_node); ++i)
+    {
+        const string_view key{other.Key(other_node, i)};
+        uint32_t child{0};
+        if (Lookup(node, key, child))
+        {
+            continue;
+        }
+
+        if (dotted(key))
+        {
+            changed.push_back(child_path(key));
+        }
+        else
+        {
+            other.Collect(other.Child(other_node, i), child_path(key), true, changed);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void ConfigArena::Collect(uint32_t node,
+                          const string &path,
+                          bool self,
+                          vector<string> &changed) const noexcept
+{
+    if (self)
+    {
+        changed.push_back(path);
+    }
+
+    if (Type(node) != YAML::NodeType::Map)
+    {
+        return;
+    }
+
+    for (uint32_t i{0}; i < Size(node); ++i)
+    {
+        const string_view key{Key(node, i)};
+        if (key.find(ConfigNodePath::Delimiter()) == string_view::npos)
+        {
+            Collect(Child(node, i),
+                    path.empty() ? string{key} : path + '.' + string{key},
+                    true,
+                    changed);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ConfigArena::Equal(uint32_t node,
+                        const ConfigArena &other,
+                        uint32_t other_node) const noexcept
+{
+    const YAML::NodeType::value type{Type(node)};
+    if (type != other.Type(other_node))
+    {
+        return false;
+    }
+
+    switch (type)
+    {
+        case YAML::NodeType::Scalar:
+            return Scalar(node) == other.Scalar(other_node);
+
+        case YAML::NodeType::Sequence:
+            if (Size(node) != other.Size(other_node))
+            {
+                return false;
+            }
+            for (uint32_t i{0}; i < Size(node); ++i)
+            {
+                if (!Equal(Child(node, i), other, other.Child(other_node, i)))
+                {
+                    return false;
+                }
+            }
+            return true;
+
+        case YAML::NodeType::Map:
+            if (Size(node) != other.Size(other_node))
+            {
+                return false;
+            }
+            for (uint32_t i{0}; i < Size(node); ++i)
+            {
+                uint32_t other_child{0};
+                if (!other.Lookup(other_node, Key(node, i), other_child) ||
+                    !Equal(Child(node, i), other, other_child))
+                {
+                    return false;
+                }
+            }
+            return true;
+
+        default:
+            return true;
+    }
+}
+
+}  // namespace tasp
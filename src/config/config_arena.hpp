@@ -0,0 +1,368 @@
+/**
+ * @file
+ * @brief Компактное неизменяемое представление конфигурационного файла.
+ */
+#ifndef TASP_CONFIG_CONFIG_ARENA_HPP_
+#define TASP_CONFIG_CONFIG_ARENA_HPP_
+
+#include <yaml-cpp/yaml.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tasp
+{
+
+class ConfigNodePath;
+
+/**
+ * @brief Компактное неизменяемое представление конфигурационного файла.
+ *
+ * Документ хранится в одном непрерывном блоке памяти (образе): массив узлов
+ * фиксированного размера, массив ссылок на вложенные узлы, таблица строк и
+ * область символов. Одинаковые строки хранятся в одном экземпляре. Элементы
+ * последовательности и пары словаря занимают непрерывный участок массива
+ * ссылок; для словаря за парами следует порядок пар по возрастанию ключей,
+ * по которому ключ ищется двоичным поиском. Вложенные узлы всегда следуют за
+ * родительским. Корневой узел имеет номер 0.
+ *
+ * Образ проверяется при создании, после чего доступ к узлам выполняется без
+ * проверок. Образ не зависит от адреса размещения, поэтому может быть
+ * сохранен в файл и отображен в память (@ref ConfigCache).
+ */
+class ConfigArena final
+{
+public:
+    /**
+     * @brief Конструктор с владением образом.
+     *
+     * @param image Образ
+     */
+    explicit ConfigArena(std::string image) noexcept;
+
+    /**
+     * @brief Конструктор для образа во внешней памяти.
+     *
+     * @param storage Владелец памяти образа
+     * @param image Образ
+     */
+    ConfigArena(std::shared_ptr<const void> storage,
+                std::string_view image) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~ConfigArena() noexcept;
+
+    /**
+     * @brief Построение образа документа.
+     *
+     * @param document Документ
+     *
+     * @return Образ
+     *
+     * @throw YAML::Exception При ошибке доступа к узлу
+     * @throw std::length_error Если документ не помещается в формат образа
+     */
+    static std::string Build(const YAML::Node &document);
+
+    /**
+     * @brief Проверка корректности образа.
+     *
+     * @return Результат проверки
+     */
+    [[nodiscard]] bool Valid() const noexcept;
+
+    /**
+     * @brief Запрос образа.
+     *
+     * @return Образ
+     */
+    [[nodiscard]] std::string_view Image() const noexcept;
+
+    /**
+     * @brief Поиск узла по пути.
+     *
+     * @param path Разобранный путь к узлу
+     * @param node Номер узла
+     *
+     * @return Результат поиска
+     */
+    bool Find(const ConfigNodePath &path, std::uint32_t &node) const noexcept;
+
+    /**
+     * @brief Запрос типа узла.
+     *
+     * @param node Номер узла
+     *
+     * @return Тип узла
+     */
+    [[nodiscard]] YAML::NodeType::value Type(std::uint32_t node) const noexcept;
+
+    /**
+     * @brief Запрос значения скалярного узла.
+     *
+     * @param node Номер узла
+     *
+     * @return Значение. Для других типов узлов - пустая строка
+     */
+    [[nodiscard]] std::string_view Scalar(std::uint32_t node) const noexcept;
+
+    /**
+     * @brief Запрос количества вложенных узлов.
+     *
+     * @param node Номер узла
+     *
+     * @return Количество элементов последовательности или пар словаря
+     */
+    [[nodiscard]] std::uint32_t Size(std::uint32_t node) const noexcept;
+
+    /**
+     * @brief Запрос вложенного узла.
+     *
+     * @param node Номер узла
+     * @param index Порядковый номер элемента последовательности или пары
+     * словаря
+     *
+     * @return Номер элемента последовательности или значения пары словаря
+     */
+    [[nodiscard]] std::uint32_t Child(std::uint32_t node,
+                                      std::uint32_t index) const noexcept;
+
+    /**
+     * @brief Запрос ключа пары словаря.
+     *
+     * @param node Номер узла
+     * @param index Порядковый номер пары
+     *
+     * @return Ключ. Для нескалярного ключа - пустая строка
+     */
+    [[nodiscard]] std::string_view Key(std::uint32_t node,
+                                       std::uint32_t index) const noexcept;
+
+    /**
+     * @brief Восстановление узла в виде документа yaml-cpp.
+     *
+     * @param node Номер узла
+     *
+     * @return Узел со всеми вложенными узлами
+     *
+     * @throw YAML::Exception При ошибке создания узла
+     */
+    [[nodiscard]] YAML::Node Restore(std::uint32_t node) const;
+
+    /**
+     * @brief Сравнение с другим документом.
+     *
+     * Результат совпадает с @ref ConfigImpl::Diff: параметр изменен, если он
+     * есть только в одном из документов, различается тип или значение.
+     * Словари сравниваются по вложенным параметрам.
+     *
+     * @param other Документ
+     *
+     * @return Полные пути к измененным параметрам
+     */
+    [[nodiscard]] std::vector<std::string> Diff(
+        const ConfigArena &other) const noexcept;
+
+    ConfigArena(const ConfigArena &) = delete;
+    ConfigArena(ConfigArena &&) = delete;
+    ConfigArena &operator=(const ConfigArena &) = delete;
+    ConfigArena &operator=(ConfigArena &&) = delete;
+
+private:
+    /**
+     * @brief Заголовок образа.
+     */
+    struct Header
+    {
+        /**
+         * @brief Количество узлов.
+         */
+        std::uint32_t nodes;
+
+        /**
+         * @brief Количество ссылок на вложенные узлы.
+         */
+        std::uint32_t children;
+
+        /**
+         * @brief Количество строк.
+         */
+        std::uint32_t strings;
+
+        /**
+         * @brief Размер области символов строк.
+         */
+        std::uint32_t characters;
+    };
+
+    /**
+     * @brief Узел документа.
+     */
+    struct Node
+    {
+        /**
+         * @brief Тип узла (YAML::NodeType).
+         */
+        std::uint8_t type;
+
+        /**
+         * @brief Стиль вывода узла (YAML::EmitterStyle).
+         */
+        std::uint8_t style;
+
+        /**
+         * @brief Выравнивание.
+         */
+        std::uint16_t reserved;
+
+        /**
+         * @brief Номер строки тега.
+         */
+        std::uint32_t tag;
+
+        /**
+         * @brief Номер строки значения или первой ссылки на вложенный узел.
+         */
+        std::uint32_t first;
+
+        /**
+         * @brief Количество вложенных узлов (для словаря - пар ключ-значение).
+         */
+        std::uint32_t size;
+    };
+
+    /**
+     * @brief Расположение строки в области символов.
+     */
+    struct String
+    {
+        /**
+         * @brief Смещение первого символа.
+         */
+        std::uint32_t offset;
+
+        /**
+         * @brief Количество символов.
+         */
+        std::uint32_t size;
+    };
+
+    /**
+     * @brief Построение образа.
+     */
+    class Builder;
+
+    /**
+     * @brief Разметка и проверка образа.
+     *
+     * @return Результат проверки
+     */
+    bool Map() noexcept;
+
+    /**
+     * @brief Запрос строки.
+     *
+     * @param index Номер строки
+     *
+     * @return Строка
+     */
+    [[nodiscard]] std::string_view Text(std::uint32_t index) const noexcept;
+
+    /**
+     * @brief Сравнение узлов.
+     *
+     * @param node Номер узла
+     * @param other Документ
+     * @param other_node Номер узла в другом документе
+     * @param path Полный путь к узлу
+     * @param changed Полные пути к измененным параметрам
+     */
+    void DiffNode(std::uint32_t node,
+                  const ConfigArena &other,
+                  std::uint32_t other_node,
+                  const std::string &path,
+                  std::vector<std::string> &changed) const noexcept;
+
+    /**
+     * @brief Добавление пути к узлу и путей ко всем вложенным параметрам.
+     *
+     * @param node Номер узла
+     * @param path Полный путь к узлу
+     * @param self Добавлять путь к самому узлу
+     * @param changed Полные пути к измененным параметрам
+     */
+    void Collect(std::uint32_t node,
+                 const std::string &path,
+                 bool self,
+                 std::vector<std::string> &changed) const noexcept;
+
+    /**
+     * @brief Полное сравнение узлов.
+     *
+     * @param node Номер узла
+     * @param other Документ
+     * @param other_node Номер узла в другом документе
+     *
+     * @return Результат сравнения. true - узлы совпадают
+     */
+    [[nodiscard]] bool Equal(std::uint32_t node,
+                             const ConfigArena &other,
+                             std::uint32_t other_node) const noexcept;
+
+    /**
+     * @brief Поиск пары словаря по ключу.
+     *
+     * @param node Номер узла словаря
+     * @param key Ключ
+     * @param child Номер значения пары
+     *
+     * @return Результат поиска
+     */
+    bool Lookup(std::uint32_t node,
+                std::string_view key,
+                std::uint32_t &child) const noexcept;
+
+    /**
+     * @brief Владелец памяти образа.
+     */
+    std::shared_ptr<const void> storage_;
+
+    /**
+     * @brief Образ.
+     */
+    std::string_view image_;
+
+    /**
+     * @brief Заголовок.
+     */
+    const Header *header_{nullptr};
+
+    /**
+     * @brief Узлы.
+     */
+    const Node *nodes_{nullptr};
+
+    /**
+     * @brief Ссылки на вложенные узлы.
+     */
+    const std::uint32_t *children_{nullptr};
+
+    /**
+     * @brief Строки.
+     */
+    const String *strings_{nullptr};
+
+    /**
+     * @brief Область символов строк.
+     */
+    const char *characters_{nullptr};
+};
+
+}  // namespace tasp
+
+#endif  // TASP_CONFIG_CONFIG_ARENA_HPP_
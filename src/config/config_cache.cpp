@@ -0,0 +1,276 @@
+#include "config_cache.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#include "config_arena.hpp"
+#include "include_cache.hpp"
+#include "tasp/logging.hpp"
+
+using std::exception;
+using std::int64_t;
+using std::ofstream;
+using std::shared_ptr;
+using std::size_t;
+using std::string;
+using std::string_view;
+using std::uint32_t;
+using std::uint64_t;
+using std::vector;
+
+namespace tasp
+{
+/*------------------------------------------------------------------------------
+    ConfigCache
+------------------------------------------------------------------------------*/
+ConfigCache::ConfigCache(const fs::path &path) noexcept
+{
+    const int descriptor{open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (descriptor == -1)
+    {
+        return;
+    }
+
+    struct stat info
+    {
+    };
+    if (fstat(descriptor, &info) == -1 ||
+        static_cast<size_t>(info.st_size) < sizeof(Header))
+    {
+        close(descriptor);
+        return;
+    }
+
+    const auto size{static_cast<size_t>(info.st_size)};
+    void *memory{mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0)};
+    close(descriptor);
+    if (memory == MAP_FAILED)
+    {
+        return;
+    }
+
+    try
+    {
+        // Отображение освобождается вместе с последней ссылкой на документ.
+        const shared_ptr<const void> storage{
+            memory,
+            [size](const void *mapped)
+            { munmap(const_cast<void *>(mapped), size); }};
+
+        const string_view image{static_cast<const char *>(memory), size};
+        std::memcpy(&header_, image.data(), sizeof(header_));
+
+        const uint64_t arena{sizeof(Header) + uint64_t{header_.paths}};
+        if (header_.magic != magic_ || header_.version != version_ ||
+            arena > size || header_.checksum != Checksum(image) ||
+            !ParseFiles(image.substr(sizeof(Header), header_.paths),
+                        header_.files))
+        {
+            Logging::Warning("Некорректный файл кэша конфигурационного файла {}",
+                             path);
+            files_.clear();
+            return;
+        }
+
+        auto document{
+            std::make_shared<const ConfigArena>(storage, image.substr(arena))};
+        if (!document->Valid())
+        {
+            Logging::Warning("Некорректный документ в файле кэша "
+                             "конфигурационного файла {}",
+                             path);
+            files_.clear();
+            return;
+        }
+
+        arena_ = std::move(document);
+    }
+    catch (const exception &exception)
+    {
+        Logging::Warning("Ошибка открытия файла кэша конфигурационного файла "
+                         "{}: {}",
+                         path,
+                         exception.what());
+        files_.clear();
+    }
+}
+
+//------------------------------------------------------------------------------
+ConfigCache::~ConfigCache() noexcept = default;
+
+//------------------------------------------------------------------------------
+bool ConfigCache::Valid() const noexcept
+{
+    return arena_ != nullptr;
+}
+
+//------------------------------------------------------------------------------
+uint64_t ConfigCache::Key() const noexcept
+{
+    return Valid() ? header_.key : 0;
+}
+
+//------------------------------------------------------------------------------
+size_t ConfigCache::Hash() const noexcept
+{
+    return Valid() ? header_.hash : 0;
+}
+
+//------------------------------------------------------------------------------
+const vector<fs::path> &ConfigCache::Files() const noexcept
+{
+    return files_;
+}
+
+//------------------------------------------------------------------------------
+shared_ptr<const ConfigArena> ConfigCache::Arena() const noexcept
+{
+    return arena_;
+}
+
+//------------------------------------------------------------------------------
+uint64_t ConfigCache::Key(const vector<fs::path> &files,
+                          string_view salt,
+                          int64_t &modified) noexcept
+{
+    modified = 0;
+
+    string key{salt};
+    key.push_back('\0');
+
+    for (const auto &file : files)
+    {
+        // Отсутствующий файл также входит в ключ: его появление делает кэш
+        // недействительным.
+        IncludeCache::Version version{};
+        IncludeCache::Stat(file, version);
+        modified = std::max(modified, version.mtime);
+
+        key += file.string();
+        key.push_back('\0');
+        key.append(reinterpret_cast<const char *>(&version), sizeof(version));
+    }
+
+    return std::hash<string>{}(key);
+}
+
+//------------------------------------------------------------------------------
+bool ConfigCache::Write(const fs::path &path,
+                        uint64_t key,
+                        string_view image,
+                        const vector<fs::path> &files,
+                        size_t hash) noexcept
+{
+    // Имя временного файла уникально для процесса и вызова: кэш может
+    // сохраняться одновременно несколькими процессами.
+    static std::atomic<unsigned int> counter{0};
+    const fs::path temporary{path.string() + '.' + std::to_string(getpid()) +
+                             '.' + std::to_string(counter++) + ".tmp"};
+
+    try
+    {
+        string paths{};
+        for (const auto &file : files)
+        {
+            paths += file.string();
+            paths.push_back('\0');
+        }
+        paths.resize((paths.size() + alignment_ - 1) / alignment_ * alignment_,
+                     '\0');
+
+        if (paths.size() > std::numeric_limits<uint32_t>::max())
+        {
+            Logging::Debug("Слишком много файлов для сохранения в кэш {}",
+                           path);
+            return false;
+        }
+
+        Header header{magic_, version_, key, hash};
+        header.files = static_cast<uint32_t>(files.size());
+        header.paths = static_cast<uint32_t>(paths.size());
+
+        string content(sizeof(Header), '\0');
+        content.reserve(sizeof(Header) + paths.size() + image.size());
+        content += paths;
+        content += image;
+
+        header.checksum = Checksum(content);
+        std::memcpy(content.data(), &header, sizeof(header));
+
+        fs::create_directories(path.parent_path());
+
+        ofstream output{temporary, std::ios::binary | std::ios::trunc};
+        if (!output)
+        {
+            Logging::Debug("Не удалось создать файл кэша конфигурационного "
+                           "файла {}",
+                           temporary);
+            return false;
+        }
+
+        output.write(content.data(),
+                     static_cast<std::streamsize>(content.size()));
+        output.close();
+        if (!output)
+        {
+            Logging::Debug("Ошибка записи файла кэша конфигурационного "
+                           "файла {}",
+                           temporary);
+            fs::remove(temporary);
+            return false;
+        }
+
+        fs::rename(temporary, path);
+    }
+    catch (const exception &exception)
+    {
+        Logging::Debug("Ошибка сохранения кэша конфигурационного файла {}: "
+                       "{}",
+                       path,
+                       exception.what());
+        std::error_code error{};
+        fs::remove(temporary, error);
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+uint64_t ConfigCache::Checksum(string_view image) noexcept
+{
+    image.remove_prefix(sizeof(Header));
+    return std::hash<string_view>{}(image);
+}
+
+//------------------------------------------------------------------------------
+bool ConfigCache::ParseFiles(string_view paths, uint32_t count)
+{
+    files_.clear();
+    files_.reserve(std::min<size_t>(count, paths.size()));
+
+    for (uint32_t i{0}; i < count; ++i)
+    {
+        const size_t end{paths.find('\0')};
+        if (end == string_view::npos)
+        {
+            return false;
+        }
+
+        files_.emplace_back(string{paths.substr(0, end)});
+        paths.remove_prefix(end + 1);
+    }
+
+    // Остаток области - выравнивание.
+    return paths.find_first_not_of('\0') == string_view::npos;
+}
+
+}  // namespace tasp
@@ -0,0 +1,220 @@
+/**
+ * @file
+ * @brief Двоичный кэш загруженного конфигурационного файла.
+ */
+#ifndef TASP_CONFIG_CONFIG_CACHE_HPP_
+#define TASP_CONFIG_CONFIG_CACHE_HPP_
+
+#include <cstdint>
+#include <experimental/filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::experimental::filesystem;
+
+namespace tasp
+{
+
+class ConfigArena;
+
+/**
+ * @brief Двоичный кэш загруженного конфигурационного файла.
+ *
+ * Файл кэша содержит пути к исходным файлам и образ документа после слияния
+ * всех включаемых файлов в компактном представлении (@ref ConfigArena).
+ *
+ * Кэш действителен, пока не изменились исходные файлы: ключ кэша вычисляется
+ * по пути, времени изменения, размеру, устройству и inode каждого файла.
+ * Файл кэша открывается через mmap и проверяется по контрольной сумме,
+ * документ читается из отображенного файла без разбора YAML. Отображение
+ * остается открытым, пока используется документ, поэтому процессы с одним
+ * конфигурационным файлом разделяют страницы кэша в памяти.
+ */
+class ConfigCache final
+{
+public:
+    /**
+     * @brief Конструктор. Открывает файл кэша и проверяет его заголовок.
+     *
+     * @param path Путь к файлу кэша
+     */
+    explicit ConfigCache(const fs::path &path) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~ConfigCache() noexcept;
+
+    /**
+     * @brief Проверка корректного открытия файла кэша.
+     *
+     * @return Результат проверки
+     */
+    [[nodiscard]] bool Valid() const noexcept;
+
+    /**
+     * @brief Запрос ключа, с которым сохранен кэш.
+     *
+     * @return Ключ кэша (@ref Key)
+     */
+    [[nodiscard]] std::uint64_t Key() const noexcept;
+
+    /**
+     * @brief Запрос хэша содержимого исходных файлов.
+     *
+     * @return Хэш содержимого (@ref ConfigImpl::Hash)
+     */
+    [[nodiscard]] std::size_t Hash() const noexcept;
+
+    /**
+     * @brief Запрос исходных файлов.
+     *
+     * @return Пути к исходным файлам в порядке чтения
+     */
+    [[nodiscard]] const std::vector<fs::path> &Files() const noexcept;
+
+    /**
+     * @brief Запрос документа.
+     *
+     * @return Документ или nullptr, если файл кэша не открыт
+     */
+    [[nodiscard]] std::shared_ptr<const ConfigArena> Arena() const noexcept;
+
+    /**
+     * @brief Вычисление ключа кэша.
+     *
+     * @param files Пути к исходным файлам
+     * @param salt Дополнительные данные, от которых зависит документ
+     * @param modified Наибольшее время изменения исходных файлов в
+     * наносекундах
+     *
+     * @return Ключ кэша
+     */
+    static std::uint64_t Key(const std::vector<fs::path> &files,
+                             std::string_view salt,
+                             std::int64_t &modified) noexcept;
+
+    /**
+     * @brief Сохранение образа документа в файл кэша.
+     *
+     * Документ записывается во временный файл, который затем переименовывается,
+     * поэтому читатели не видят частично записанный кэш.
+     *
+     * @param path Путь к файлу кэша
+     * @param key Ключ кэша
+     * @param image Образ документа (@ref ConfigArena::Build)
+     * @param files Пути к исходным файлам
+     * @param hash Хэш содержимого исходных файлов
+     *
+     * @return Результат сохранения
+     */
+    static bool Write(const fs::path &path,
+                      std::uint64_t key,
+                      std::string_view image,
+                      const std::vector<fs::path> &files,
+                      std::size_t hash) noexcept;
+
+    ConfigCache(const ConfigCache &) = delete;
+    ConfigCache(ConfigCache &&) = delete;
+    ConfigCache &operator=(const ConfigCache &) = delete;
+    ConfigCache &operator=(ConfigCache &&) = delete;
+
+private:
+    /**
+     * @brief Заголовок файла кэша.
+     */
+    struct Header
+    {
+        /**
+         * @brief Признак файла кэша.
+         */
+        std::uint32_t magic;
+
+        /**
+         * @brief Версия формата файла.
+         */
+        std::uint32_t version;
+
+        /**
+         * @brief Ключ кэша.
+         */
+        std::uint64_t key;
+
+        /**
+         * @brief Хэш содержимого исходных файлов.
+         */
+        std::uint64_t hash;
+
+        /**
+         * @brief Контрольная сумма данных после заголовка.
+         */
+        std::uint64_t checksum{0};
+
+        /**
+         * @brief Количество исходных файлов.
+         */
+        std::uint32_t files{0};
+
+        /**
+         * @brief Размер области путей к исходным файлам с выравниванием.
+         */
+        std::uint32_t paths{0};
+    };
+
+    /**
+     * @brief Вычисление контрольной суммы образа файла.
+     *
+     * @param image Образ файла вместе с заголовком
+     *
+     * @return Контрольная сумма данных после заголовка
+     */
+    static std::uint64_t Checksum(std::string_view image) noexcept;
+
+    /**
+     * @brief Разбор области путей к исходным файлам.
+     *
+     * @param paths Область путей
+     * @param count Количество путей
+     *
+     * @return Результат разбора
+     *
+     * @throw std::bad_alloc При ошибке выделения памяти
+     */
+    bool ParseFiles(std::string_view paths, std::uint32_t count);
+
+    /**
+     * @brief Признак файла кэша.
+     */
+    static constexpr std::uint32_t magic_{0x54415343};
+
+    /**
+     * @brief Версия формата файла кэша.
+     */
+    static constexpr std::uint32_t version_{2};
+
+    /**
+     * @brief Выравнивание образа документа в файле.
+     */
+    static constexpr std::size_t alignment_{8};
+
+    /**
+     * @brief Заголовок.
+     */
+    Header header_{};
+
+    /**
+     * @brief Пути к исходным файлам.
+     */
+    std::vector<fs::path> files_;
+
+    /**
+     * @brief Документ.
+     */
+    std::shared_ptr<const ConfigArena> arena_;
+};
+
+}  // namespace tasp
+
+#endif  // TASP_CONFIG_CONFIG_CACHE_HPP_
@@ -1,21 +1,44 @@
 #include "config_impl.hpp"
 
+#include <fcntl.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
+#include <future>
 #include <utility>
 
+#include "config_arena.hpp"
+#include "config_cache.hpp"
+#include "config_watcher.hpp"
+#include "include_cache.hpp"
+
 using std::error_code;
 using std::exception;
-using std::getline;
+using std::future;
+using std::ifstream;
+using std::int64_t;
+using std::make_shared;
+using std::make_unique;
 using std::ofstream;
 using std::scoped_lock;
+using std::shared_ptr;
 using std::size_t;
 using std::string;
 using std::string_view;
-using std::stringstream;
 using std::system_category;
+using std::uint32_t;
+using std::uint64_t;
+using std::unique_ptr;
 using std::vector;
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+using std::chrono::system_clock;
 
 namespace tasp
 {
@@ -64,9 +87,66 @@ vector<string> ConfigImpl::Get<vector<string>>(
 {
     vector<string> value{default_value};
 
+    if (arena_ != nullptr)
+    {
+        uint32_t node{0};
+        const bool found{arena_->Find(path, node)};
+        const YAML::NodeType::value type{found ? arena_->Type(node)
+                                               : YAML::NodeType::Undefined};
+
+        // Последовательность со вложенными узлами преобразуется через
+        // yaml-cpp, который сообщает об ошибке.
+        const auto scalars = [this, node]()
+        {
+            for (uint32_t i{0}; i < arena_->Size(node); ++i)
+            {
+                if (arena_->Type(arena_->Child(node, i)) !=
+                    YAML::NodeType::Scalar)
+                {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        if (type == YAML::NodeType::Map ||
+            (type == YAML::NodeType::Sequence && scalars()))
+        {
+            try
+            {
+                value.clear();
+                value.reserve(arena_->Size(node));
+                for (uint32_t i{0}; i < arena_->Size(node); ++i)
+                {
+                    value.emplace_back(
+                        type == YAML::NodeType::Map
+                            ? arena_->Key(node, i)
+                            : arena_->Scalar(arena_->Child(node, i)));
+                }
+            }
+            catch (const exception &exception)
+            {
+                Logging::Error("Ошибка при при конвертации данных из "
+                               "конфигурационного файла в массив: {}",
+                               exception.what());
+                value = default_value;
+            }
+            return value;
+        }
+    }
+    else if (indexed_)
+    {
+        // Ключи словарей сохраняются при построении индекса.
+        const auto entry{index_.find(path.String())};
+        if (entry != index_.end() && entry->second.node.IsMap())
+        {
+            return entry->second.keys;
+        }
+    }
+
     try
     {
-        const YAML::Node node{GetNode(path)};
+        const YAML::Node node{FindNode(path)};
         if (node.Type() != YAML::NodeType::Undefined)
         {
             if (node.Type() == YAML::NodeType::Map)
@@ -108,6 +188,11 @@ const fs::path &ConfigImpl::GetPath() const noexcept
 //------------------------------------------------------------------------------
 bool ConfigImpl::Save() const noexcept
 {
+    if (transaction_ != 0)
+    {
+        return true;
+    }
+
     const fs::path dir{fullpath_.parent_path()};
 
     try
@@ -125,33 +210,140 @@ bool ConfigImpl::Save() const noexcept
         return false;
     }
 
-    ofstream output{fullpath_};
-    if (!output)
+    string content{};
+    try
     {
-        const error_code error{errno, system_category()};
-        Logging::Error("Ошибка при сохранении файла: {}", error.message());
+        content = YAML::Dump(arena_ != nullptr ? arena_->Restore(0)
+                                               : document_);
+    }
+    catch (const exception &exception)
+    {
+        Logging::Error("Ошибка при сохранении файла {}: {}",
+                       fullpath_,
+                       exception.what());
         return false;
     }
 
-    output << document_;
-    return true;
+    // Запись с синхронизацией дороже чтения, поэтому неизмененный файл не
+    // перезаписывается.
+    ifstream input{fullpath_, std::ios::binary};
+    if (input)
+    {
+        const string current{std::istreambuf_iterator<char>{input},
+                             std::istreambuf_iterator<char>{}};
+        if (current == content)
+        {
+            return true;
+        }
+    }
+
+    return WriteFile(fullpath_, content);
+}
+
+//------------------------------------------------------------------------------
+void ConfigImpl::Begin() noexcept
+{
+    if (transaction_ == 0)
+    {
+        try
+        {
+            backup_ = YAML::Clone(document_);
+        }
+        catch (const exception &exception)
+        {
+            Logging::Error("Ошибка при начале изменения конфигурационного "
+                           "файла {}: {}",
+                           fullpath_,
+                           exception.what());
+        }
+    }
+
+    ++transaction_;
+}
+
+//------------------------------------------------------------------------------
+bool ConfigImpl::Commit() noexcept
+{
+    if (transaction_ == 0)
+    {
+        Logging::Error("Завершение изменения конфигурационного файла {} без "
+                       "начала",
+                       fullpath_);
+        return false;
+    }
+
+    if (--transaction_ != 0)
+    {
+        return true;
+    }
+
+    backup_.reset();
+    return Save();
+}
+
+//------------------------------------------------------------------------------
+void ConfigImpl::Rollback() noexcept
+{
+    if (transaction_ == 0)
+    {
+        return;
+    }
+
+    transaction_ = 0;
+    ResetIndex();
+    document_ = backup_;
+    backup_.reset();
 }
 
 //------------------------------------------------------------------------------
 void ConfigImpl::Reload() noexcept
 {
-    Logging::Debug("Загрузка конфигурационного файла {}", fullpath_);
+    Load(false);
+}
 
-    try
+//------------------------------------------------------------------------------
+void ConfigImpl::Load(bool cached) noexcept
+{
+    ResetIndex();
+    arena_.reset();
+    files_ = {fullpath_};
+    hash_ = 0;
+
+    // Версия файла запрашивается до чтения: если файл изменится во время
+    // чтения, версия в кэше не совпадет с текущей.
+    IncludeCache::Version version{};
+    const bool stat{cached && IncludeCache::Stat(fullpath_, version)};
+    if (stat && IncludeCache::Instance().Find(fullpath_, version, document_, hash_))
     {
-        document_ = YAML::LoadFile(fullpath_);
+        return;
     }
-    catch (const YAML::BadFile &exception)
+
+    Logging::Debug("Загрузка конфигурационного файла {}", fullpath_);
+
+    try
     {
-        document_ = YAML::Load("");
-        Logging::Error("Конфигурационный {} файл не найден. {}",
-                       fullpath_,
-                       exception.what());
+        // Файл читается в строку, чтобы хэш содержимого соответствовал
+        // разобранному документу.
+        ifstream input{fullpath_};
+        if (!input)
+        {
+            const error_code error{errno, system_category()};
+            document_ = YAML::Load("");
+            Logging::Error("Конфигурационный {} файл не найден. {}",
+                           fullpath_,
+                           error.message());
+            return;
+        }
+
+        const string content{std::istreambuf_iterator<char>{input},
+                             std::istreambuf_iterator<char>{}};
+        hash_ = std::hash<string>{}(content);
+        document_ = YAML::Load(content);
+
+        if (stat && !IncludeCache::Recent(version))
+        {
+            IncludeCache::Instance().Store(fullpath_, version, document_, hash_);
+        }
     }
     catch (const YAML::ParserException &exception)
     {
@@ -170,6 +362,11 @@ void ConfigImpl::Reload() noexcept
 //------------------------------------------------------------------------------
 bool ConfigImpl::Valid() const noexcept
 {
+    if (arena_ != nullptr)
+    {
+        return arena_->Type(0) != YAML::NodeType::Null;
+    }
+
     bool result{false};
     try
     {
@@ -189,9 +386,23 @@ bool ConfigImpl::Valid() const noexcept
 //------------------------------------------------------------------------------
 void ConfigImpl::Include() noexcept
 {
+    Include({GetPath()});
+}
+
+//------------------------------------------------------------------------------
+void ConfigImpl::Include(const vector<fs::path> &chain) noexcept
+{
+    ResetIndex();
+
     const fs::path config_path{GetPath().parent_path()};
 
-    auto include{Get<vector<fs::path>>(ConfigNodePath("include"))};
+    const auto include{Get<vector<fs::path>>(ConfigNodePath("include"))};
+
+    // Файлы верхнего уровня читаются и разбираются параллельно, слияние
+    // выполняется последовательно в порядке перечисления.
+    vector<unique_ptr<ConfigImpl>> configs{};
+    configs.reserve(include.size());
+
     for (auto path : include)
     {
         if (!path.is_absolute())
@@ -199,183 +410,835 @@ void ConfigImpl::Include() noexcept
             path = config_path / path;
         }
 
-        ConfigImpl included_config{path};
-        if (included_config.Valid())
+        auto config{make_unique<ConfigImpl>()};
+        config->SetPath(path);
+
+        if (std::find(chain.begin(), chain.end(), config->GetPath()) !=
+            chain.end())
         {
-            included_config.Include();
-            MergeNode(document_, included_config.document_);
+            Logging::Error("Циклическое включение конфигурационного файла {} "
+                           "в {}",
+                           config->GetPath(),
+                           GetPath());
+            continue;
         }
-    }
-}
 
-//------------------------------------------------------------------------------
-string ConfigImpl::String() const noexcept
-{
-    return YAML::Dump(document_);
-}
+        configs.push_back(std::move(config));
+    }
 
-//------------------------------------------------------------------------------
-void ConfigImpl::MergeNode(YAML::Node &destination,
-                           const YAML::Node &source) noexcept
-{
-    for (const auto &node : source)
+    // Файлы распределяются между потоками по очереди. Вложенные включения
+    // загружаются в том же потоке, поэтому количество потоков не зависит от
+    // глубины включений.
+    std::atomic<size_t> next{0};
+    auto load = [&configs, &chain, &next]()
     {
-        YAML::Node find_node{};
-        YAML::NodeType::value type{YAML::NodeType::Null};
-        try
-        {
-            find_node = destination[node.first.as<string>()];
-            type = node.second.Type();
-        }
-        catch (const exception &exception)
-        {
-            Logging::Error("Ошибка при поиске элемента в конфигурационном "
-                           "файле при слиянии: {}",
-                           exception.what());
-        }
-
-        if (!find_node || type != YAML::NodeType::Map)
+        for (size_t i{next++}; i < configs.size(); i = next++)
         {
-            try
-            {
-                find_node = node.second;
-            }
-            catch (const exception &exception)
+            auto &config{configs[i]};
+            config->Load(true);
+            if (config->Valid())
             {
-                Logging::Error(
-                    "Ошибка при слиянии значения в конфигурационном файле: {}",
-                    exception.what());
+                vector<fs::path> included_chain{chain};
+                included_chain.push_back(config->GetPath());
+                config->Include(included_chain);
             }
         }
-        else
-        {
-            MergeNode(find_node, node.second);
-        }
-    }
-}
+    };
 
-//------------------------------------------------------------------------------
-YAML::Node ConfigImpl::GetNode(const ConfigNodePath &path) const noexcept
-{
-    vector<YAML::Node> nodes{document_};
-    nodes.reserve(path.Size());
+    const size_t threads{chain.size() == 1
+                             ? std::min(configs.size(), include_threads_)
+                             : 1};
 
-    for (const auto &key : path)
+    vector<future<void>> loads{};
+    for (size_t i{1}; i < threads; ++i)
     {
-        // защита от преобразования YAML::NodeType::Sequence в
-        // YAML::NodeType::Map (yaml-cpp версии 0.6.2-4): если
-        // nodes.back().IsSequence, и в ней нет ключа key, то nodes.back()[key]
-        // преобразует nodes.back() в Map...
-        // (https://github.com/jbeder/yaml-cpp/blob/master/docs/Tutorial.md#how-sequences-turn-into-maps)
-        // (https://github.com/jbeder/yaml-cpp/issues/825)
-
-        // при отсутствии элемента функция должна возвращать пустой node, для
-        // которого !node -> true и node == nullptr -> true;
-        // ниже, если элемент с ключом key не найден, child превращается в
-        // "zombie", и для него !child -> true; но, если получено исключение,то
-        // child{}: !child -> false;
-        // поэтому для предсказуемости результата в качестве пустого элемента
-        // возвращаем всегда node{YAML::NodeType::Undefined}: !node -> true
-        YAML::Node child{};
         try
         {
-            // nodes.back().IsX() будет бросать исключения, только если
-            // nodes.back() - невалидный YAML::Node (yaml-cpp версии 0.6.2-4)
-            if (!nodes.back().IsMap() && !nodes.back().IsNull())
-            {
-                throw exception();
-            }
-            // nodes.back()[key] будет бросать исключения, только если
-            // nodes.back() - невалидный YAML::Node (yaml-cpp версии 0.6.2-4)
-            child = nodes.back()[key];
+            loads.push_back(std::async(std::launch::async, load));
         }
         catch (const exception &exception)
         {
-            Logging::Error(
-                "Ошибка при поиске элемента {} в конфигурационном файле: "
-                "недопустимая структура родителя узла {}",
-                path.String(),
-                key);
-            return YAML::Node{YAML::NodeType::Undefined};
+            // Поток не создан, оставшиеся файлы загружаются в текущем и уже
+            // запущенных потоках.
+            break;
         }
+    }
 
-        // проверяем child на "zombie"
-        if (!child)
+    load();
+
+    for (auto &loading : loads)
+    {
+        loading.wait();
+    }
+
+    for (const auto &config : configs)
+    {
+        if (config->Valid())
         {
-            return YAML::Node{YAML::NodeType::Undefined};
+            MergeNode(document_, config->document_);
         }
 
-        nodes.push_back(child);
+        // Отсутствующие и некорректные файлы также учитываются, чтобы их
+        // появление или исправление изменяло хэш.
+        files_.insert(files_.end(), config->files_.begin(), config->files_.end());
+        const size_t golden_ratio{0x9e3779b97f4a7c15};
+        const size_t left_shift{6};
+        const size_t right_shift{2};
+        hash_ ^= config->hash_ + golden_ratio + (hash_ << left_shift) +
+                 (hash_ >> right_shift);
     }
-
-    return nodes.back();
 }
 
 //------------------------------------------------------------------------------
-YAML::Node ConfigImpl::CreateNode(const ConfigNodePath &path) noexcept
+vector<string> ConfigImpl::Diff(const ConfigImpl &other) const noexcept
 {
-    vector<YAML::Node> nodes{document_};
-    nodes.reserve(path.Size());
+    if (arena_ != nullptr && other.arena_ != nullptr)
+    {
+        return arena_->Diff(*other.arena_);
+    }
 
-    for (const auto &key : path)
+    if (!indexed_ || !other.indexed_)
     {
-        YAML::Node child{};
-        try
+        return {string{}};
+    }
+
+    vector<string> changed{};
+
+    try
+    {
+        for (const auto &[path, entry] : index_)
         {
-            if (!nodes.back().IsMap() &&
-                !nodes.back().IsNull())  // последовательности (sequences) не
-                                         // допускаются
+            const auto other_entry{other.index_.find(path)};
+            if (other_entry == other.index_.end())
             {
-                throw exception();
+                changed.push_back(path);
+                continue;
             }
-            child = nodes.back()[key];
-        }
-        catch (const exception &exception)
-        {
-            Logging::Error("Ошибка при создании нового значения {} в "
-                           "конфигурационном файле: недопустимая структура "
-                           "родителя узла {}",
-                           path.String(),
-                           key);
-            return YAML::Node{YAML::NodeType::Undefined};
-        }
 
-        if (!child)
-        {
-            try
+            // Вложенные параметры словарей сравниваются по индексу.
+            const YAML::Node &node{entry.node};
+            const YAML::Node &other_node{other_entry->second.node};
+            if (node.IsMap() && other_node.IsMap())
             {
-                child = YAML::Node(YAML::NodeType::Null);
+                if (entry.dotted || other_entry->second.dotted)
+                {
+                    DiffDotted(path, node, other_node, changed);
+                }
             }
-            catch (const exception &exception)
+            else if (!Equal(node, other_node))
             {
-                Logging::Error("Ошибка при создании нового значения {} в "
-                               "конфигурационном файле: недопустимая структура "
-                               "узла {}",
-                               path.String(),
-                               key);
-                return YAML::Node{YAML::NodeType::Undefined};
+                changed.push_back(path);
             }
         }
 
-        nodes.push_back(child);
+        for (const auto &entry : other.index_)
+        {
+            if (index_.count(entry.first) == 0)
+            {
+                changed.push_back(entry.first);
+            }
+        }
+    }
+    catch (const exception &exception)
+    {
+        Logging::Error("Ошибка при сравнении конфигурационных файлов: {}",
+                       exception.what());
+        return {string{}};
     }
 
-    return nodes.back();
+    return changed;
 }
 
-/*------------------------------------------------------------------------------
-    ConfigGlobalImpl
-------------------------------------------------------------------------------*/
-ConfigGlobalImpl::ConfigGlobalImpl(const fs::path &path) noexcept
+//------------------------------------------------------------------------------
+bool ConfigImpl::Restore(const ConfigCache &cache) noexcept
 {
-    const fs::path config_path{path.empty() ? DefaultPath() : path};
-
-    SetPath(config_path);
-    ConfigImpl::Reload();
-
-    InitBaseParams();
-    Include();
-}
+    auto arena{cache.Arena()};
+    if (arena == nullptr)
+    {
+        return false;
+    }
+
+    try
+    {
+        files_ = cache.Files();
+    }
+    catch (const exception &exception)
+    {
+        Logging::Error("Ошибка при загрузке конфигурационного файла {} из "
+                       "кэша: {}",
+                       fullpath_,
+                       exception.what());
+        return false;
+    }
+
+    ResetIndex();
+    document_.reset();
+    arena_ = std::move(arena);
+    hash_ = cache.Hash();
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool ConfigImpl::Store(const fs::path &path, uint64_t key) const noexcept
+{
+    if (arena_ != nullptr)
+    {
+        return ConfigCache::Write(path, key, arena_->Image(), files_, hash_);
+    }
+
+    string image{};
+    try
+    {
+        image = ConfigArena::Build(document_);
+    }
+    catch (const exception &exception)
+    {
+        Logging::Warning("Конфигурационный файл {} не сохранен в кэш: {}",
+                         fullpath_,
+                         exception.what());
+        return false;
+    }
+
+    return ConfigCache::Write(path, key, image, files_, hash_);
+}
+
+//------------------------------------------------------------------------------
+void ConfigImpl::Compact() noexcept
+{
+    if (arena_ != nullptr)
+    {
+        return;
+    }
+
+    try
+    {
+        auto arena{make_shared<const ConfigArena>(ConfigArena::Build(document_))};
+        if (!arena->Valid())
+        {
+            Logging::Error("Ошибка построения компактного представления "
+                           "конфигурационного файла {}",
+                           fullpath_);
+            return;
+        }
+
+        ResetIndex();
+        document_.reset();
+        backup_.reset();
+        arena_ = std::move(arena);
+    }
+    catch (const exception &exception)
+    {
+        Logging::Error("Ошибка построения компактного представления "
+                       "конфигурационного файла {}: {}",
+                       fullpath_,
+                       exception.what());
+    }
+}
+
+//------------------------------------------------------------------------------
+void ConfigImpl::Expand() noexcept
+{
+    if (arena_ == nullptr)
+    {
+        return;
+    }
+
+    try
+    {
+        document_ = arena_->Restore(0);
+        arena_.reset();
+    }
+    catch (const exception &exception)
+    {
+        Logging::Error("Ошибка восстановления конфигурационного файла {} из "
+                       "компактного представления: {}",
+                       fullpath_,
+                       exception.what());
+    }
+}
+
+//------------------------------------------------------------------------------
+const vector<fs::path> &ConfigImpl::Files() const noexcept
+{
+    return files_;
+}
+
+//------------------------------------------------------------------------------
+size_t ConfigImpl::Hash() const noexcept
+{
+    return hash_;
+}
+
+//------------------------------------------------------------------------------
+string ConfigImpl::String() const noexcept
+{
+    if (arena_ == nullptr)
+    {
+        return YAML::Dump(document_);
+    }
+
+    try
+    {
+        return YAML::Dump(arena_->Restore(0));
+    }
+    catch (const exception &exception)
+    {
+        Logging::Error("Ошибка при конвертации конфигурационного файла {} в "
+                       "текст: {}",
+                       fullpath_,
+                       exception.what());
+    }
+
+    return {};
+}
+
+//------------------------------------------------------------------------------
+string ConfigImpl::String(const ConfigNodePath &path) const noexcept
+{
+    const YAML::Node node{FindNode(path)};
+    if (node.Type() == YAML::NodeType::Undefined)
+    {
+        return {};
+    }
+
+    return YAML::Dump(node);
+}
+
+//------------------------------------------------------------------------------
+void ConfigImpl::BuildIndex() noexcept
+{
+    ResetIndex();
+
+    // Компактное представление не требует индекса: поиск по пути выполняется
+    // двоичным поиском в словарях.
+    if (arena_ != nullptr)
+    {
+        return;
+    }
+
+    if (IndexNode(document_, {}))
+    {
+        indexed_ = true;
+    }
+    else
+    {
+        ResetIndex();
+    }
+}
+
+//------------------------------------------------------------------------------
+void ConfigImpl::MergeNode(YAML::Node &destination,
+                           const YAML::Node &source) noexcept
+{
+    for (const auto &node : source)
+    {
+        YAML::Node find_node{};
+        YAML::NodeType::value type{YAML::NodeType::Null};
+        try
+        {
+            find_node = destination[node.first.as<string>()];
+            type = node.second.Type();
+        }
+        catch (const exception &exception)
+        {
+            Logging::Error("Ошибка при поиске элемента в конфигурационном "
+                           "файле при слиянии: {}",
+                           exception.what());
+        }
+
+        if (!find_node || type != YAML::NodeType::Map)
+        {
+            try
+            {
+                find_node = node.second;
+            }
+            catch (const exception &exception)
+            {
+                Logging::Error(
+                    "Ошибка при слиянии значения в конфигурационном файле: {}",
+                    exception.what());
+            }
+        }
+        else
+        {
+            MergeNode(find_node, node.second);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+YAML::Node ConfigImpl::GetNode(const ConfigNodePath &path) const noexcept
+{
+    vector<YAML::Node> nodes{document_};
+    nodes.reserve(path.Size());
+
+    for (const auto &key : path)
+    {
+        // защита от преобразования YAML::NodeType::Sequence в
+        // YAML::NodeType::Map (yaml-cpp версии 0.6.2-4): если
+        // nodes.back().IsSequence, и в ней нет ключа key, то nodes.back()[key]
+        // преобразует nodes.back() в Map...
+        // (https://github.com/jbeder/yaml-cpp/blob/master/docs/Tutorial.md#how-sequences-turn-into-maps)
+        // (https://github.com/jbeder/yaml-cpp/issues/825)
+
+        // при отсутствии элемента функция должна возвращать пустой node, для
+        // которого !node -> true и node == nullptr -> true;
+        // ниже, если элемент с ключом key не найден, child превращается в
+        // "zombie", и для него !child -> true; но, если получено исключение,то
+        // child{}: !child -> false;
+        // поэтому для предсказуемости результата в качестве пустого элемента
+        // возвращаем всегда node{YAML::NodeType::Undefined}: !node -> true
+        YAML::Node child{};
+        try
+        {
+            // nodes.back().IsX() будет бросать исключения, только если
+            // nodes.back() - невалидный YAML::Node (yaml-cpp версии 0.6.2-4)
+            if (!nodes.back().IsMap() && !nodes.back().IsNull())
+            {
+                throw exception();
+            }
+            // nodes.back()[key] будет бросать исключения, только если
+            // nodes.back() - невалидный YAML::Node (yaml-cpp версии 0.6.2-4).
+            // Поиск выполняется через константный узел: неконстантный
+            // operator[] добавляет в узел отсутствующий ключ, что недопустимо
+            // при одновременном чтении снимка из нескольких потоков.
+            const YAML::Node &parent{nodes.back()};
+            const YAML::Node found{parent[key]};
+
+            // Константный operator[] возвращает для отсутствующего ключа
+            // "zombie", присваивание которого бросает исключение.
+            if (!found)
+            {
+                return YAML::Node{YAML::NodeType::Undefined};
+            }
+            child = found;
+        }
+        catch (const exception &exception)
+        {
+            Logging::Error(
+                "Ошибка при поиске элемента {} в конфигурационном файле: "
+                "недопустимая структура родителя узла {}",
+                path.String(),
+                key);
+            return YAML::Node{YAML::NodeType::Undefined};
+        }
+
+        // проверяем child на "zombie"
+        if (!child)
+        {
+            return YAML::Node{YAML::NodeType::Undefined};
+        }
+
+        nodes.push_back(child);
+    }
+
+    return nodes.back();
+}
+
+//------------------------------------------------------------------------------
+YAML::Node ConfigImpl::FindNode(const ConfigNodePath &path) const noexcept
+{
+    if (arena_ != nullptr)
+    {
+        uint32_t node{0};
+        if (!arena_->Find(path, node))
+        {
+            return YAML::Node{YAML::NodeType::Undefined};
+        }
+
+        try
+        {
+            return arena_->Restore(node);
+        }
+        catch (const exception &exception)
+        {
+            Logging::Error("Ошибка при запросе элемента {} из "
+                           "конфигурационного файла: {}",
+                           path.String(),
+                           exception.what());
+            return YAML::Node{YAML::NodeType::Undefined};
+        }
+    }
+
+    if (!indexed_)
+    {
+        return GetNode(path);
+    }
+
+    const auto entry{index_.find(path.String())};
+    if (entry == index_.end())
+    {
+        return YAML::Node{YAML::NodeType::Undefined};
+    }
+
+    return entry->second.node;
+}
+
+//------------------------------------------------------------------------------
+bool ConfigImpl::FindInteger(const ConfigNodePath &path,
+                             int64_t &number) const noexcept
+{
+    if (arena_ != nullptr)
+    {
+        uint32_t node{0};
+        return arena_->Find(path, node) &&
+               arena_->Type(node) == YAML::NodeType::Scalar &&
+               ParseInteger(arena_->Scalar(node), number);
+    }
+
+    if (!indexed_)
+    {
+        return false;
+    }
+
+    const auto entry{index_.find(path.String())};
+    if (entry == index_.end() || !entry->second.integer)
+    {
+        return false;
+    }
+
+    number = entry->second.number;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool ConfigImpl::GetView(const ConfigNodePath &path,
+                         string_view &value) const noexcept
+{
+    if (arena_ != nullptr)
+    {
+        uint32_t node{0};
+        if (!arena_->Find(path, node) ||
+            arena_->Type(node) != YAML::NodeType::Scalar)
+        {
+            return false;
+        }
+
+        value = arena_->Scalar(node);
+        return true;
+    }
+
+    // Значение хранится в документе, поэтому ссылка на него действительна
+    // после удаления копии узла.
+    const YAML::Node node{FindNode(path)};
+    if (!node.IsScalar())
+    {
+        return false;
+    }
+
+    value = node.Scalar();
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool ConfigImpl::IndexNode(const YAML::Node &node, const string &path) noexcept
+{
+    try
+    {
+        auto &entry{index_[path]};
+        entry.node = node;
+
+        if (node.IsScalar())
+        {
+            entry.integer = ParseInteger(node.Scalar(), entry.number);
+        }
+
+        if (!node.IsMap())
+        {
+            return true;
+        }
+
+        entry.keys.reserve(node.size());
+        for (const auto &child : node)
+        {
+            const string key{child.first.as<string>()};
+            entry.keys.push_back(key);
+
+            // Ключ с разделителем недоступен при обходе узлов по пути,
+            // поэтому не индексируется.
+            if (key.find(ConfigNodePath::Delimiter()) != string::npos)
+            {
+                entry.dotted = true;
+                continue;
+            }
+
+            if (!IndexNode(child.second, path.empty() ? key : path + '.' + key))
+            {
+                return false;
+            }
+        }
+    }
+    catch (const exception &exception)
+    {
+        Logging::Error(
+            "Ошибка при построении индекса конфигурационного файла {}: {}",
+            fullpath_,
+            exception.what());
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void ConfigImpl::DiffDotted(const string &path,
+                            const YAML::Node &left,
+                            const YAML::Node &right,
+                            vector<string> &changed)
+{
+    // Параметры с разделителем в ключе не индексируются, поэтому
+    // сравниваются вместе со словарем.
+    const auto compare = [&path, &changed](const YAML::Node &node,
+                                           const YAML::Node &other,
+                                           bool both)
+    {
+        for (const auto &child : node)
+        {
+            const string &key{child.first.Scalar()};
+            if (key.find(ConfigNodePath::Delimiter()) == string::npos)
+            {
+                continue;
+            }
+
+            const YAML::Node other_node{other[key]};
+            if (!other_node || (both && !Equal(child.second, other_node)))
+            {
+                changed.push_back(path.empty() ? key : path + '.' + key);
+            }
+        }
+    };
+
+    compare(left, right, true);
+    compare(right, left, false);
+}
+
+//------------------------------------------------------------------------------
+bool ConfigImpl::Equal(const YAML::Node &left, const YAML::Node &right)
+{
+    if (left.Type() != right.Type())
+    {
+        return false;
+    }
+
+    switch (left.Type())
+    {
+        case YAML::NodeType::Scalar:
+            return left.Scalar() == right.Scalar();
+
+        case YAML::NodeType::Sequence:
+            if (left.size() != right.size())
+            {
+                return false;
+            }
+            for (size_t i{0}; i < left.size(); ++i)
+            {
+                if (!Equal(left[i], right[i]))
+                {
+                    return false;
+                }
+            }
+            return true;
+
+        case YAML::NodeType::Map:
+            if (left.size() != right.size())
+            {
+                return false;
+            }
+            for (const auto &child : left)
+            {
+                const YAML::Node right_node{right[child.first.Scalar()]};
+                if (!right_node || !Equal(child.second, right_node))
+                {
+                    return false;
+                }
+            }
+            return true;
+
+        default:
+            return true;
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ConfigImpl::ParseInteger(string_view text, int64_t &number) noexcept
+{
+    // Разбирается только десятичная запись без ведущих нулей: yaml-cpp
+    // интерпретирует числа с префиксами 0 и 0x как восьмеричные и
+    // шестнадцатеричные, такие значения преобразуются через yaml-cpp.
+    const string_view digits{
+        !text.empty() && text.front() == '-' ? text.substr(1) : text};
+    if (digits.empty() || (digits.front() == '0' && digits.size() != 1))
+    {
+        return false;
+    }
+
+    const auto [end, error]{
+        std::from_chars(text.data(), text.data() + text.size(), number)};
+    return error == std::errc{} && end == text.data() + text.size();
+}
+
+//------------------------------------------------------------------------------
+void ConfigImpl::ResetIndex() noexcept
+{
+    index_.clear();
+    indexed_ = false;
+}
+
+//------------------------------------------------------------------------------
+bool ConfigImpl::WriteFile(const fs::path &path, string_view content) noexcept
+{
+    // Временный файл создается в той же директории: переименование атомарно
+    // только в пределах одной файловой системы.
+    static std::atomic<unsigned int> counter{0};
+    const fs::path temporary{path.string() + '.' + std::to_string(getpid()) +
+                             '.' + std::to_string(counter++) + ".tmp"};
+
+    // Созданный временный файл удаляется при любой ошибке.
+    int descriptor{-1};
+    const auto fail = [&temporary, &descriptor](const char *operation)
+    {
+        const error_code error{errno, system_category()};
+        Logging::Error("Ошибка при сохранении файла {} ({}): {}",
+                       temporary,
+                       operation,
+                       error.message());
+        if (descriptor != -1)
+        {
+            close(descriptor);
+        }
+        unlink(temporary.c_str());
+        return false;
+    };
+
+    // Права доступа как у std::ofstream: с учетом umask.
+    const mode_t mode{S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH};
+    descriptor =
+        open(temporary.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, mode);
+    if (descriptor == -1)
+    {
+        const error_code error{errno, system_category()};
+        Logging::Error("Ошибка при сохранении файла {}: {}",
+                       temporary,
+                       error.message());
+        return false;
+    }
+
+    struct stat info
+    {
+    };
+    if (stat(path.c_str(), &info) == 0 &&
+        fchmod(descriptor, info.st_mode & ALLPERMS) == -1)
+    {
+        return fail("fchmod");
+    }
+
+    while (!content.empty())
+    {
+        const ssize_t written{
+            write(descriptor, content.data(), content.size())};
+        if (written == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return fail("write");
+        }
+        content.remove_prefix(static_cast<size_t>(written));
+    }
+
+    if (fsync(descriptor) == -1)
+    {
+        return fail("fsync");
+    }
+
+    const int result{close(descriptor)};
+    descriptor = -1;
+    if (result == -1)
+    {
+        return fail("close");
+    }
+
+    if (rename(temporary.c_str(), path.c_str()) == -1)
+    {
+        return fail("rename");
+    }
+
+    // Синхронизация директории фиксирует переименование.
+    const int directory{
+        open(path.parent_path().c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)};
+    if (directory != -1)
+    {
+        fsync(directory);
+        close(directory);
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+YAML::Node ConfigImpl::CreateNode(const ConfigNodePath &path) noexcept
+{
+    vector<YAML::Node> nodes{document_};
+    nodes.reserve(path.Size());
+
+    for (const auto &key : path)
+    {
+        YAML::Node child{};
+        try
+        {
+            if (!nodes.back().IsMap() &&
+                !nodes.back().IsNull())  // последовательности (sequences) не
+                                         // допускаются
+            {
+                throw exception();
+            }
+            child = nodes.back()[key];
+        }
+        catch (const exception &exception)
+        {
+            Logging::Error("Ошибка при создании нового значения {} в "
+                           "конфигурационном файле: недопустимая структура "
+                           "родителя узла {}",
+                           path.String(),
+                           key);
+            return YAML::Node{YAML::NodeType::Undefined};
+        }
+
+        if (!child)
+        {
+            try
+            {
+                child = YAML::Node(YAML::NodeType::Null);
+            }
+            catch (const exception &exception)
+            {
+                Logging::Error("Ошибка при создании нового значения {} в "
+                               "конфигурационном файле: недопустимая структура "
+                               "узла {}",
+                               path.String(),
+                               key);
+                return YAML::Node{YAML::NodeType::Undefined};
+            }
+        }
+
+        nodes.push_back(child);
+    }
+
+    return nodes.back();
+}
+
+/*------------------------------------------------------------------------------
+    ConfigGlobalImpl
+------------------------------------------------------------------------------*/
+ConfigGlobalImpl::ConfigGlobalImpl(const fs::path &path) noexcept
+: path_(path.empty() ? DefaultPath() : path)
+, cache_path_(CachePath(path_, CacheSalt()))
+{
+    snapshot_ = Load(true);
+    current_ = snapshot_.get();
+}
 
 //------------------------------------------------------------------------------
 ConfigGlobalImpl::~ConfigGlobalImpl() noexcept = default;
@@ -383,29 +1246,400 @@ ConfigGlobalImpl::~ConfigGlobalImpl() noexcept = default;
 //------------------------------------------------------------------------------
 void ConfigGlobalImpl::Reload() noexcept
 {
-    const scoped_lock lock{mutex_};
+    vector<shared_ptr<Subscriber>> subscribers;
+    {
+        const scoped_lock lock{reload_mutex_};
+
+        auto snapshot{Load(false)};
+        if (snapshot == nullptr)
+        {
+            Logging::Error("Конфигурационный файл {} не перезагружен, "
+                           "используются ранее загруженные параметры",
+                           path_);
+            return;
+        }
+
+        const auto previous{snapshot_};
+        {
+            const scoped_lock snapshot_lock{snapshot_mutex_};
+            snapshot_ = snapshot;
+        }
+        current_ = snapshot.get();
+
+        ++generation_;
+
+        retired_.push_back(previous);
+        Reclaim();
+
+        subscribers = Changed(*previous, *snapshot);
+    }
+
+    Notify(subscribers);
+}
+
+//------------------------------------------------------------------------------
+uint64_t ConfigGlobalImpl::Generation() const noexcept
+{
+    return generation_;
+}
+
+//------------------------------------------------------------------------------
+const fs::path &ConfigGlobalImpl::Path() const noexcept
+{
+    return path_;
+}
+
+//------------------------------------------------------------------------------
+size_t ConfigGlobalImpl::Hash() const noexcept
+{
+    return hash_;
+}
+
+//------------------------------------------------------------------------------
+void ConfigGlobalImpl::Watch(const std::function<void()> &callback,
+                             std::chrono::milliseconds debounce) noexcept
+{
+    watcher_.reset();
+
+    if (callback)
+    {
+        watcher_ = std::make_unique<ConfigWatcher>(*this, callback, debounce);
+    }
+}
+
+//------------------------------------------------------------------------------
+shared_ptr<ConfigGlobalImpl::Subscriber> ConfigGlobalImpl::Subscribe(
+    vector<string> prefixes,
+    const std::function<void()> &callback) noexcept
+{
+    auto subscriber{std::make_shared<Subscriber>(
+        Subscriber{std::move(prefixes), callback})};
+
+    const scoped_lock lock{subscribers_mutex_};
+    subscribers_.push_back(subscriber);
+
+    return subscriber;
+}
+
+//------------------------------------------------------------------------------
+void ConfigGlobalImpl::Unsubscribe(const Subscriber *subscriber) noexcept
+{
+    {
+        const scoped_lock lock{subscribers_mutex_};
+        subscribers_.erase(
+            std::remove_if(subscribers_.begin(),
+                           subscribers_.end(),
+                           [subscriber](const auto &element)
+                           {
+                               return element.get() == subscriber;
+                           }),
+            subscribers_.end());
+    }
+
+    // Ожидание завершения функции оповещения в другом потоке.
+    const scoped_lock lock{notify_mutex_};
+}
+
+//------------------------------------------------------------------------------
+vector<shared_ptr<ConfigGlobalImpl::Subscriber>> ConfigGlobalImpl::Changed(
+    const ConfigImpl &previous,
+    const ConfigImpl &current) noexcept
+{
+    const scoped_lock lock{subscribers_mutex_};
+    if (subscribers_.empty())
+    {
+        return {};
+    }
+
+    const vector<string> changed{previous.Diff(current)};
+    if (changed.empty())
+    {
+        return {};
+    }
+
+    // Узел подписчика изменен, если изменен он сам, вложенный параметр или
+    // корневой узел.
+    const auto match = [&changed](const string &prefix)
+    {
+        return std::any_of(
+            changed.begin(),
+            changed.end(),
+            [&prefix](const string &path)
+            {
+                return prefix.empty() || path.empty() ||
+                       (path.compare(0, prefix.size(), prefix) == 0 &&
+                        (path.size() == prefix.size() ||
+                         path[prefix.size()] == ConfigNodePath::Delimiter()));
+            });
+    };
+
+    vector<shared_ptr<Subscriber>> subscribers;
+    for (const auto &subscriber : subscribers_)
+    {
+        if (std::any_of(subscriber->prefixes.begin(),
+                        subscriber->prefixes.end(),
+                        match))
+        {
+            subscribers.push_back(subscriber);
+        }
+    }
+
+    return subscribers;
+}
+
+//------------------------------------------------------------------------------
+void ConfigGlobalImpl::Notify(
+    const vector<shared_ptr<Subscriber>> &subscribers) noexcept
+{
+    if (subscribers.empty())
+    {
+        return;
+    }
 
-    ConfigImpl::Reload();
+    const scoped_lock lock{notify_mutex_};
+    for (const auto &subscriber : subscribers)
+    {
+        // Функция оповещения может удалить подписку, поэтому наличие
+        // подписчика проверяется перед каждым вызовом.
+        {
+            const scoped_lock subscribers_lock{subscribers_mutex_};
+            if (std::find(subscribers_.begin(),
+                          subscribers_.end(),
+                          subscriber) == subscribers_.end())
+            {
+                continue;
+            }
+        }
 
-    InitBaseParams();
-    Include();
+        subscriber->callback();
+    }
 }
 
 //------------------------------------------------------------------------------
 string ConfigGlobalImpl::String() const noexcept
 {
-    const scoped_lock lock{mutex_};
-    return ConfigImpl::String();
+    return Visit([](const ConfigImpl &snapshot) { return snapshot.String(); });
+}
+
+//------------------------------------------------------------------------------
+string ConfigGlobalImpl::String(const ConfigNodePath &path) const noexcept
+{
+    return Visit([&path](const ConfigImpl &snapshot)
+                 { return snapshot.String(path); });
+}
+
+//------------------------------------------------------------------------------
+shared_ptr<const ConfigImpl> ConfigGlobalImpl::Snapshot() const noexcept
+{
+    const scoped_lock lock{snapshot_mutex_};
+    return snapshot_;
+}
+
+//------------------------------------------------------------------------------
+ConfigGlobalImpl::LocalSnapshot &ConfigGlobalImpl::Local() noexcept
+{
+    thread_local LocalSnapshot local{};
+    return local;
+}
+
+//------------------------------------------------------------------------------
+ConfigGlobalImpl::LocalSnapshots &ConfigGlobalImpl::Locals() noexcept
+{
+    static auto *locals{new LocalSnapshots{}};
+    return *locals;
+}
+
+//------------------------------------------------------------------------------
+void ConfigGlobalImpl::Reclaim() noexcept
+{
+    vector<const ConfigImpl *> used{};
+    {
+        auto &locals{Locals()};
+        const scoped_lock lock{locals.mutex};
+        for (const auto *local : locals.locals)
+        {
+            const ConfigImpl *snapshot{local->snapshot};
+            if (snapshot != nullptr)
+            {
+                used.push_back(snapshot);
+            }
+        }
+    }
+
+    retired_.erase(std::remove_if(retired_.begin(),
+                                  retired_.end(),
+                                  [&used](const auto &snapshot)
+                                  {
+                                      return std::find(used.begin(),
+                                                       used.end(),
+                                                       snapshot.get()) ==
+                                             used.end();
+                                  }),
+                   retired_.end());
+}
+
+//------------------------------------------------------------------------------
+shared_ptr<const ConfigImpl> ConfigGlobalImpl::Load(bool initial) noexcept
+{
+    // Кэш используется только при запуске: перезагрузка выполняется после
+    // изменения файлов, когда кэш недействителен.
+    if (initial)
+    {
+        auto cached{LoadCache()};
+        if (cached != nullptr)
+        {
+            hash_ = cached->Hash();
+            Prepare(*cached);
+            return cached;
+        }
+    }
+
+    const int64_t started{
+        duration_cast<nanoseconds>(system_clock::now().time_since_epoch())
+            .count()};
+
+    auto config{std::make_shared<ConfigImpl>(path_)};
+    if (!initial && !config->Valid())
+    {
+        hash_ = config->Hash();
+        return nullptr;
+    }
+
+    InitBaseParams(*config);
+    config->Include();
+    hash_ = config->Hash();
+    Prepare(*config);
+
+    StoreCache(*config, started);
+
+    return config;
+}
+
+//------------------------------------------------------------------------------
+shared_ptr<ConfigImpl> ConfigGlobalImpl::LoadCache() const noexcept
+{
+    const ConfigCache cache{cache_path_};
+    if (!cache.Valid())
+    {
+        return nullptr;
+    }
+
+    auto config{std::make_shared<ConfigImpl>()};
+    config->SetPath(path_);
+    if (!config->Restore(cache))
+    {
+        return nullptr;
+    }
+
+    int64_t modified{0};
+    if (cache.Key() != ConfigCache::Key(config->Files(), CacheSalt(), modified))
+    {
+        Logging::Debug("Кэш конфигурационного файла {} устарел", path_);
+        return nullptr;
+    }
+
+    Logging::Debug("Конфигурационный файл {} загружен из кэша {}",
+                   path_,
+                   cache_path_);
+
+    return config;
+}
+
+//------------------------------------------------------------------------------
+void ConfigGlobalImpl::StoreCache(const ConfigImpl &config,
+                                  int64_t started) const noexcept
+{
+    error_code error{};
+
+    if (!config.Get<bool>(ConfigNodePath("config.cache.enabled"), false))
+    {
+        fs::remove(cache_path_, error);
+        return;
+    }
+
+    int64_t modified{0};
+    const uint64_t key{ConfigCache::Key(config.Files(), CacheSalt(), modified)};
+
+    const int64_t precision{
+        duration_cast<nanoseconds>(std::chrono::seconds{1}).count()};
+    if (modified + precision > started)
+    {
+        Logging::Debug("Кэш конфигурационного файла {} не сохранен: файлы "
+                       "изменены во время загрузки",
+                       path_);
+        fs::remove(cache_path_, error);
+        return;
+    }
+
+    config.Store(cache_path_, key);
+}
+
+//------------------------------------------------------------------------------
+void ConfigGlobalImpl::Prepare(ConfigImpl &config) noexcept
+{
+    if (config.Get<bool>(ConfigNodePath("config.compact"), false))
+    {
+        // Разобранные включаемые файлы занимают больше памяти, чем
+        // компактное представление всего конфигурационного файла.
+        config.Compact();
+        IncludeCache::Instance().Clear();
+        return;
+    }
+
+    // Снимок из кэша находится в компактном представлении.
+    config.Expand();
+    config.BuildIndex();
+}
+
+//------------------------------------------------------------------------------
+string ConfigGlobalImpl::CacheSalt() const noexcept
+{
+    const fs::path program{fs::canonical(program_invocation_name)};
+
+    return path_.string() + '\n' + program.string() + '\n' +
+           (getppid() == 1 ? "systemd" : "user");
+}
+
+//------------------------------------------------------------------------------
+fs::path ConfigGlobalImpl::CachePath(const fs::path &path,
+                                     string_view salt) noexcept
+{
+    string key{fs::absolute(path).string()};
+    key += '\n';
+    key += salt;
+
+    std::array<char, sizeof(size_t) * 2 + 1> hash{};
+    std::snprintf(
+        hash.data(), hash.size(), "%016zx", std::hash<string>{}(key));
+
+    fs::path directory{};
+    if (const char *variable{std::getenv("TASP_CACHE_DIR")};
+        variable != nullptr && *variable != '\0')
+    {
+        directory = variable;
+    }
+    else if (const char *xdg{std::getenv("XDG_CACHE_HOME")};
+             xdg != nullptr && *xdg != '\0')
+    {
+        directory = fs::path{xdg} / "tasp";
+    }
+    else
+    {
+        directory = fs::canonical(program_invocation_name).parent_path();
+        directory /= "cache";
+    }
+
+    return directory / (path.stem().string() + '-' + hash.data() + ".cache");
 }
 
 //------------------------------------------------------------------------------
-void ConfigGlobalImpl::InitBaseParams() noexcept
+void ConfigGlobalImpl::InitBaseParams(ConfigImpl &config) noexcept
 {
     const fs::path program{fs::canonical(program_invocation_name)};
 
-    Set(ConfigNodePath("program.name"), program.filename());
-    Set(ConfigNodePath("program.path"), program.parent_path());
-    Set(ConfigNodePath("program.systemd"), getppid() == 1);
+    config.Set(ConfigNodePath("program.name"), program.filename());
+    config.Set(ConfigNodePath("program.path"), program.parent_path());
+    config.Set(ConfigNodePath("program.systemd"), getppid() == 1);
 }
 
 //------------------------------------------------------------------------------
@@ -431,18 +1665,67 @@ fs::path ConfigGlobalImpl::DefaultPath() noexcept
     return config_path;
 }
 
+/*------------------------------------------------------------------------------
+    ConfigGlobalImpl::LocalSnapshot
+------------------------------------------------------------------------------*/
+ConfigGlobalImpl::LocalSnapshot::LocalSnapshot() noexcept
+{
+    auto &locals{Locals()};
+    const scoped_lock lock{locals.mutex};
+    locals.locals.push_back(this);
+}
+
+//------------------------------------------------------------------------------
+ConfigGlobalImpl::LocalSnapshot::~LocalSnapshot() noexcept
+{
+    auto &locals{Locals()};
+    const scoped_lock lock{locals.mutex};
+    locals.locals.erase(
+        std::remove(locals.locals.begin(), locals.locals.end(), this),
+        locals.locals.end());
+}
+
+/*------------------------------------------------------------------------------
+    ConfigSubscriptionImpl
+------------------------------------------------------------------------------*/
+ConfigSubscriptionImpl::ConfigSubscriptionImpl(
+    ConfigGlobalImpl &config,
+    shared_ptr<ConfigGlobalImpl::Subscriber> subscriber) noexcept
+: config_(config)
+, subscriber_(std::move(subscriber))
+{
+}
+
+//------------------------------------------------------------------------------
+ConfigSubscriptionImpl::~ConfigSubscriptionImpl() noexcept
+{
+    config_.Unsubscribe(subscriber_.get());
+}
+
 /*------------------------------------------------------------------------------
     ConfigNodePath
 ------------------------------------------------------------------------------*/
 ConfigNodePath::ConfigNodePath(string_view path) noexcept
 : path_(path)
 {
-    string element;
-    stringstream stream{path.data()};
+    // Разбор повторяет std::getline: пустой ключ в конце пути не
+    // добавляется.
+    while (!path.empty())
+    {
+        const size_t position{path.find(delimiter_)};
+        keys_.emplace_back(path.substr(0, position));
+        if (position == string_view::npos)
+        {
+            break;
+        }
+        path.remove_prefix(position + 1);
+    }
 
-    while (getline(stream, element, delimiter_))
+    // Полный путь совпадает с ключами индекса: отброшенный пустой ключ
+    // удаляется и из него.
+    if (!path_.empty() && path_.back() == delimiter_)
     {
-        keys_.push_back(element);
+        path_.pop_back();
     }
 }
 
@@ -456,11 +1739,17 @@ size_t ConfigNodePath::Size() const noexcept
 }
 
 //------------------------------------------------------------------------------
-std::string ConfigNodePath::String() const noexcept
+const string &ConfigNodePath::String() const noexcept
 {
     return path_;
 }
 
+//------------------------------------------------------------------------------
+char ConfigNodePath::Delimiter() noexcept
+{
+    return delimiter_;
+}
+
 // Выключается проверка стиля наименований для этого участка, т.к. это
 // методы для использования в стандартной библиотеке c++.
 // NOLINTBEGIN(readability-identifier-naming)
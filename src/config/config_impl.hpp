@@ -7,9 +7,17 @@
 
 #include <yaml-cpp/yaml.h>
 
+#include <atomic>
+#include <chrono>
 #include <experimental/filesystem>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <mutex>
+#include <type_traits>
+#include <unordered_map>
 
+#include "config_arena.hpp"
 #include "tasp/logging.hpp"
 
 namespace fs = std::experimental::filesystem;
@@ -17,7 +25,9 @@ namespace fs = std::experimental::filesystem;
 namespace tasp
 {
 
+class ConfigCache;
 class ConfigNodePath;
+class ConfigWatcher;
 
 /**
  * @brief Реализация интерфейса для работы с конфигурационным файлом.
@@ -66,6 +76,37 @@ public:
     Type Get(const ConfigNodePath &path,
              const Type &default_value = {}) const noexcept;
 
+    /**
+     * @brief Обход элементов последовательности.
+     *
+     * Элементы передаются в функцию по порядку без создания массива. Для
+     * типа std::string_view элемент передается без копирования; десятичные
+     * числа разбираются без преобразования yaml-cpp. Элементы, которые не
+     * удалось преобразовать к типу, пропускаются.
+     *
+     * @param path Полный путь к последовательности
+     * @param callback Функция обработки элемента
+     *
+     * @return Количество обработанных элементов
+     */
+    template<typename Type>
+    std::size_t ForEach(
+        const ConfigNodePath &path,
+        const std::function<void(const Type &)> &callback) const noexcept;
+
+    /**
+     * @brief Запрос скалярного значения без копирования.
+     *
+     * @param path Полный путь к значению
+     * @param value Значение. Действительно, пока конфигурационный файл не
+     * изменен и не перезагружен
+     *
+     * @return Результат запроса. false - параметр отсутствует или не является
+     * скалярным
+     */
+    bool GetView(const ConfigNodePath &path,
+                 std::string_view &value) const noexcept;
+
     /**
      * @brief Установка нового значения в конфигурационном файле.
      *
@@ -97,10 +138,42 @@ public:
     /**
      * @brief Сохранение значений в конфигурационный файл.
      *
+     * Содержимое записывается во временный файл в той же директории, который
+     * синхронизируется с устройством хранения и переименовывается в
+     * конфигурационный файл. При сбое файл содержит либо старое, либо новое
+     * содержимое. Если содержимое файла совпадает с сохраняемым, файл не
+     * перезаписывается. Внутри пакетного изменения (@ref Begin) сохранение
+     * откладывается до @ref Commit.
+     *
      * @return Результат сохранения файла
      */
     bool Save() const noexcept;
 
+    /**
+     * @brief Начало пакетного изменения.
+     *
+     * Изменения (@ref Set) накапливаются в памяти, вызовы @ref Save не
+     * записывают файл. Пакетные изменения могут быть вложенными, файл
+     * записывается при завершении внешнего.
+     */
+    void Begin() noexcept;
+
+    /**
+     * @brief Завершение пакетного изменения с сохранением файла.
+     *
+     * @return Результат сохранения файла. Для вложенного пакетного изменения
+     * всегда true
+     */
+    bool Commit() noexcept;
+
+    /**
+     * @brief Отмена пакетного изменения.
+     *
+     * Восстанавливаются значения на момент начала внешнего пакетного
+     * изменения, вложенные пакетные изменения также отменяются.
+     */
+    void Rollback() noexcept;
+
     /**
      * @brief Перезагрузка конфигурационного файла.
      *
@@ -122,8 +195,12 @@ public:
      *
      * В конфигурационном файле может присутствовать пути к другим
      * конфигурационным файлам в параметре include. При вызове этой функции
-     * перечисленные конфигурационные файлы будет последовательно прочитаны и
-     * слиты с текущим.
+     * перечисленные конфигурационные файлы будут параллельно прочитаны и
+     * последовательно, в порядке перечисления, слиты с текущим.
+     *
+     * Разобранные включаемые файлы сохраняются в кэше (@ref IncludeCache) и
+     * повторно не читаются, пока не изменятся. Файл, который включает сам
+     * себя напрямую или через другие файлы, пропускается.
      */
     void Include() noexcept;
 
@@ -132,7 +209,104 @@ public:
      *
      * @return Конфигурационный файл в виде текста
      */
-    virtual std::string String() const noexcept;
+    [[nodiscard]] std::string String() const noexcept;
+
+    /**
+     * @brief Конвертация узла конфигурационного файла в текстовый формат.
+     *
+     * @param path Путь к узлу
+     *
+     * @return Узел в виде текста или пустая строка, если узел отсутствует
+     */
+    [[nodiscard]] std::string String(const ConfigNodePath &path) const noexcept;
+
+    /**
+     * @brief Построение индекса параметров конфигурационного файла.
+     *
+     * Индекс сопоставляет полному пути к каждому узлу сам узел и список
+     * ключей вложенных параметров. После построения запрос значения
+     * выполняется поиском в индексе без последовательного обхода узлов.
+     * Изменение конфигурационного файла (@ref Set, @ref Reload, @ref Include)
+     * удаляет индекс, после чего значения запрашиваются обходом узлов до
+     * следующего построения.
+     */
+    void BuildIndex() noexcept;
+
+    /**
+     * @brief Запрос списка прочитанных файлов.
+     *
+     * @return Основной конфигурационный файл и все файлы из параметра
+     * include, в том числе отсутствующие
+     */
+    [[nodiscard]] const std::vector<fs::path> &Files() const noexcept;
+
+    /**
+     * @brief Запрос хэша содержимого прочитанных файлов.
+     *
+     * Хэш вычисляется по содержимому основного файла и файлов из параметра
+     * include в порядке чтения. Хэш отсутствующего файла равен 0.
+     *
+     * @return Хэш содержимого
+     */
+    [[nodiscard]] std::size_t Hash() const noexcept;
+
+    /**
+     * @brief Сравнение с другим конфигурационным файлом.
+     *
+     * Сравниваются элементы индексов: параметр изменен, если он есть только
+     * в одном из файлов, различается тип или значение узла. Словари
+     * сравниваются по вложенным параметрам, поэтому добавление параметра не
+     * отмечает изменение родительских узлов.
+     *
+     * @param other Конфигурационный файл
+     *
+     * @return Полные пути к измененным параметрам. Если индекс одного из
+     * файлов не построен, возвращается корневой узел (пустой путь)
+     */
+    [[nodiscard]] std::vector<std::string> Diff(
+        const ConfigImpl &other) const noexcept;
+
+    /**
+     * @brief Загрузка конфигурационного файла из двоичного кэша.
+     *
+     * Документ, список прочитанных файлов и хэш содержимого заменяются
+     * сохраненными в кэше. Проверка действительности кэша выполняется до
+     * вызова.
+     *
+     * @param cache Кэш
+     *
+     * @return Результат загрузки. false - файл кэша поврежден, конфигурационный
+     * файл не изменен
+     */
+    bool Restore(const ConfigCache &cache) noexcept;
+
+    /**
+     * @brief Сохранение конфигурационного файла в двоичный кэш.
+     *
+     * @param path Путь к файлу кэша
+     * @param key Ключ кэша (@ref ConfigCache::Key)
+     *
+     * @return Результат сохранения
+     */
+    bool Store(const fs::path &path, std::uint64_t key) const noexcept;
+
+    /**
+     * @brief Преобразование в компактное неизменяемое представление.
+     *
+     * Документ переносится в непрерывный блок памяти (@ref ConfigArena), а
+     * дерево узлов yaml-cpp и индекс удаляются. Значения запрашиваются из
+     * компактного представления, изменение конфигурационного файла
+     * становится недоступным.
+     */
+    void Compact() noexcept;
+
+    /**
+     * @brief Восстановление документа yaml-cpp из компактного представления.
+     *
+     * Если документ не находится в компактном представлении, ничего не
+     * выполняется.
+     */
+    void Expand() noexcept;
 
     ConfigImpl(const ConfigImpl &) = delete;
     ConfigImpl(ConfigImpl &&) = delete;
@@ -140,6 +314,29 @@ public:
     ConfigImpl &operator=(ConfigImpl &&) = delete;
 
 private:
+    /**
+     * @brief Загрузка конфигурационного файла.
+     *
+     * @param cached Использовать кэш разобранных включаемых файлов
+     */
+    void Load(bool cached) noexcept;
+
+    /**
+     * @brief Загрузка сторонних конфигурационных файлов из параметра include.
+     *
+     * Файлы верхнего уровня читаются параллельно не более чем в
+     * @ref include_threads_ потоках, вложенные включения читаются
+     * последовательно в потоке включающего файла.
+     *
+     * @param chain Цепочка файлов, включивших текущий, вместе с текущим
+     */
+    void Include(const std::vector<fs::path> &chain) noexcept;
+
+    /**
+     * @brief Максимальное количество потоков чтения включаемых файлов.
+     */
+    static constexpr std::size_t include_threads_{4};
+
     /**
      * @brief Слитие двух веток конфигурационного файла.
      *
@@ -158,6 +355,144 @@ private:
      */
     YAML::Node GetNode(const ConfigNodePath &path) const noexcept;
 
+    /**
+     * @brief Запрос параметра из индекса или, если индекс не построен, из
+     * конфигурационного файла.
+     *
+     * @param path Разобранный путь к параметру
+     *
+     * @return Запрошенный параметр или пустой элемент в случае отсутствия
+     * параметра
+     */
+    YAML::Node FindNode(const ConfigNodePath &path) const noexcept;
+
+    /**
+     * @brief Запрос целочисленного значения без преобразования yaml-cpp.
+     *
+     * @param path Разобранный путь к параметру
+     * @param value Значение
+     *
+     * @return Результат запроса. false - значение не найдено (@ref
+     * FindInteger) или не помещается в тип
+     */
+    template<typename Type>
+    bool GetInteger(const ConfigNodePath &path, Type &value) const noexcept;
+
+    /**
+     * @brief Приведение числа к целочисленному типу с проверкой диапазона.
+     *
+     * @param number Число
+     * @param value Значение
+     *
+     * @return Результат приведения. false - число не помещается в тип
+     */
+    template<typename Type>
+    static bool Narrow(std::int64_t number, Type &value) noexcept;
+
+    /**
+     * @brief Преобразование элемента последовательности.
+     *
+     * @param path Разобранный путь к последовательности
+     * @param scalar Признак скалярного элемента
+     * @param text Значение скалярного элемента
+     * @param node Функция запроса узла элемента для преобразования yaml-cpp
+     * @param value Значение
+     *
+     * @return Результат преобразования
+     */
+    template<typename Type, typename Node>
+    static bool Convert(const ConfigNodePath &path,
+                        bool scalar,
+                        std::string_view text,
+                        const Node &node,
+                        Type &value) noexcept;
+
+    /**
+     * @brief Запрос значения в виде десятичного числа из индекса или
+     * компактного представления.
+     *
+     * @param path Разобранный путь к параметру
+     * @param number Число
+     *
+     * @return Результат запроса. false - индекс не построен и документ не
+     * находится в компактном представлении, параметр отсутствует или не
+     * является десятичным числом
+     */
+    bool FindInteger(const ConfigNodePath &path,
+                     std::int64_t &number) const noexcept;
+
+    /**
+     * @brief Добавление узла и всех вложенных узлов в индекс.
+     *
+     * @param node Узел
+     * @param path Полный путь к узлу
+     *
+     * @return Результат добавления
+     */
+    bool IndexNode(const YAML::Node &node, const std::string &path) noexcept;
+
+    /**
+     * @brief Сравнение параметров словарей с разделителем в ключе.
+     *
+     * Такие параметры не индексируются. Пути к отличающимся параметрам
+     * добавляются в список измененных.
+     *
+     * @param path Полный путь к словарям
+     * @param left Словарь
+     * @param right Словарь
+     * @param changed Полные пути к измененным параметрам
+     *
+     * @throw YAML::Exception При ошибке доступа к узлу
+     */
+    static void DiffDotted(const std::string &path,
+                           const YAML::Node &left,
+                           const YAML::Node &right,
+                           std::vector<std::string> &changed);
+
+    /**
+     * @brief Полное сравнение узлов.
+     *
+     * @param left Узел
+     * @param right Узел
+     *
+     * @return Результат сравнения. true - узлы совпадают
+     *
+     * @throw YAML::Exception При ошибке доступа к узлу
+     */
+    static bool Equal(const YAML::Node &left, const YAML::Node &right);
+
+    /**
+     * @brief Разбор значения в виде десятичного числа.
+     *
+     * @param text Значение
+     * @param number Число
+     *
+     * @return Результат разбора
+     */
+    static bool ParseInteger(std::string_view text,
+                             std::int64_t &number) noexcept;
+
+    /**
+     * @brief Удаление индекса после изменения конфигурационного файла.
+     */
+    void ResetIndex() noexcept;
+
+    /**
+     * @brief Атомарная запись файла.
+     *
+     * Содержимое записывается во временный файл, синхронизируется с
+     * устройством хранения и переименовывается в целевой файл, после чего
+     * синхронизируется директория. Права доступа существующего файла
+     * сохраняются.
+     *
+     * @param path Путь к файлу
+     * @param content Содержимое
+     *
+     * @return Результат записи
+     */
+    static bool WriteFile(const fs::path &path,
+                          std::string_view content) noexcept;
+
     /**
      * @brief Создание параметра в конфигурационном файле.
      *
@@ -178,6 +513,73 @@ private:
      * Корневой элемент конфигурационного файла.
      */
     YAML::Node document_;
+
+    /**
+     * @brief Прочитанные файлы.
+     */
+    std::vector<fs::path> files_;
+
+    /**
+     * @brief Хэш содержимого прочитанных файлов.
+     */
+    std::size_t hash_{0};
+
+    /**
+     * @brief Элемент индекса параметров.
+     */
+    struct IndexEntry
+    {
+        /**
+         * @brief Узел конфигурационного файла.
+         */
+        YAML::Node node;
+
+        /**
+         * @brief Ключи вложенных параметров, если узел - словарь.
+         */
+        std::vector<std::string> keys;
+
+        /**
+         * @brief Признак вложенных параметров с разделителем в ключе.
+         */
+        bool dotted{false};
+
+        /**
+         * @brief Признак значения в виде десятичного числа.
+         */
+        bool integer{false};
+
+        /**
+         * @brief Значение, если узел - десятичное число.
+         */
+        std::int64_t number{0};
+    };
+
+    /**
+     * @brief Индекс параметров по полному пути.
+     */
+    std::unordered_map<std::string, IndexEntry> index_;
+
+    /**
+     * @brief Признак построенного индекса.
+     */
+    bool indexed_{false};
+
+    /**
+     * @brief Глубина вложенности пакетных изменений.
+     */
+    unsigned int transaction_{0};
+
+    /**
+     * @brief Копия документа на момент начала пакетного изменения.
+     */
+    YAML::Node backup_;
+
+    /**
+     * @brief Компактное представление документа. Если задано, дерево узлов
+     * yaml-cpp не используется.
+     */
+    std::shared_ptr<const ConfigArena> arena_;
 };
 
 /**
@@ -187,10 +589,31 @@ private:
  * в конструкторе конфигурационный файл или, в случае пустого значения, ищет
  * конфигурационный файл НАЗВАНИЕ_ПРОГРАММЫ.yml по пути /etc/tasp
  * или в директории с программой.
+ *
+ * Загруженный файл хранится в виде неизменяемого снимка, который публикуется
+ * через атомарный указатель. Чтение выполняется из текущего снимка без
+ * блокировок. При перезагрузке новый снимок собирается отдельно и заменяет
+ * текущий; читатели, получившие старый снимок, продолжают работать с ним.
  */
-class ConfigGlobalImpl final : public ConfigImpl
+class ConfigGlobalImpl final
 {
 public:
+    /**
+     * @brief Подписчик на изменение части конфигурационного файла.
+     */
+    struct Subscriber
+    {
+        /**
+         * @brief Пути к узлам конфигурационного файла.
+         */
+        std::vector<std::string> prefixes;
+
+        /**
+         * @brief Функция оповещения.
+         */
+        std::function<void()> callback;
+    };
+
     /**
      * @brief Конструктор.
      *
@@ -204,7 +627,7 @@ public:
     /**
      * @brief Деструктор.
      */
-    ~ConfigGlobalImpl() noexcept override;
+    ~ConfigGlobalImpl() noexcept;
 
     /**
      * @brief Запрос значения из конфигурационного файла.
@@ -225,10 +648,30 @@ public:
     Type Get(const ConfigNodePath &path,
              const Type &default_value = {}) const noexcept;
 
+    /**
+     * @brief Обход элементов последовательности в текущем снимке.
+     *
+     * Снимок сохраняется до завершения обхода, поэтому значения типа
+     * std::string_view действительны внутри функции обработки даже при
+     * одновременной перезагрузке.
+     *
+     * @param path Полный путь к последовательности
+     * @param callback Функция обработки элемента
+     *
+     * @return Количество обработанных элементов
+     */
+    template<typename Type>
+    std::size_t ForEach(
+        const ConfigNodePath &path,
+        const std::function<void(const Type &)> &callback) const noexcept;
+
     /**
      * @brief Перезагрузка конфигурационного файла.
      *
-     * Конфигурационный файл перечитывает. Вся старая информация удаляется.
+     * Конфигурационный файл перечитывается в новый снимок, который заменяет
+     * текущий после загрузки всех включаемых файлов. Чтение во время
+     * перезагрузки не блокируется. Если основной конфигурационный файл не
+     * найден или содержит ошибки, текущий снимок сохраняется.
      */
     void Reload() noexcept;
 
@@ -237,97 +680,459 @@ public:
      *
      * @return Конфигурационный файл в виде текста
      */
-    [[nodiscard]] std::string String() const noexcept override;
+    [[nodiscard]] std::string String() const noexcept;
 
-    ConfigGlobalImpl(const ConfigGlobalImpl &) = delete;
-    ConfigGlobalImpl(ConfigGlobalImpl &&) = delete;
-    ConfigGlobalImpl &operator=(const ConfigGlobalImpl &) = delete;
-    ConfigGlobalImpl &operator=(ConfigGlobalImpl &&) = delete;
+    /**
+     * @brief Конвертация узла конфигурационного файла в текстовый формат.
+     *
+     * @param path Путь к узлу
+     *
+     * @return Узел в виде текста или пустая строка, если узел отсутствует
+     */
+    [[nodiscard]] std::string String(const ConfigNodePath &path) const noexcept;
 
-private:
     /**
-     * @brief Добавление стандартных параметров для каждой программы.
+     * @brief Запрос текущего снимка конфигурационного файла.
      *
-     * Параметры:
-     * program.name - название программы
-     * program.path - пусть запуска программы
-     * program.systemd - тип запуска. Пользовательская программа или сервис.
+     * @return Снимок
      */
-    void InitBaseParams() noexcept;
+    [[nodiscard]] std::shared_ptr<const ConfigImpl> Snapshot() const noexcept;
 
     /**
-     * @brief Поиск конфигурационного файла в стандартных местах размещения.
+     * @brief Запрос номера загрузки конфигурационного файла.
      *
-     * @return Полный путь к найденному файлу
+     * Номер увеличивается после каждой перезагрузки.
+     *
+     * @return Номер загрузки
      */
-    static fs::path DefaultPath() noexcept;
+    [[nodiscard]] std::uint64_t Generation() const noexcept;
 
     /**
-     * @brief Мьютекс для синхронизации чтения и перезагрузки файла.
+     * @brief Запрос пути к конфигурационному файлу.
+     *
+     * @return Путь, переданный в конструкторе или найденный в стандартных
+     * местах размещения
      */
-    mutable std::mutex mutex_;
-};
+    [[nodiscard]] const fs::path &Path() const noexcept;
 
-/**
- * @brief Класс пути к параметрам в конфигурационном файле.
- */
-class ConfigNodePath final
-{
-public:
     /**
-     * @brief Конструктор.
+     * @brief Запрос хэша содержимого файлов при последней загрузке.
      *
-     * Путь состоит из последовательных значений ключей разделенных знаком ".".
-     * Путь разделяется на элементы и помещается в вектор для последовательного
-     * доступа по ключам конфигурационного файла.
+     * Учитывается и загрузка, при которой снимок не был заменен из-за ошибки
+     * в основном конфигурационном файле.
      *
-     * @param path Полный путь к значению
+     * @return Хэш содержимого (@ref ConfigImpl::Hash)
      */
-    explicit ConfigNodePath(std::string_view path) noexcept;
+    [[nodiscard]] std::size_t Hash() const noexcept;
 
     /**
-     * @brief Деструктор.
+     * @brief Включение отслеживания изменений конфигурационных файлов.
+     *
+     * Ранее запущенное отслеживание останавливается.
+     *
+     * @param callback Функция оповещения об изменении содержимого файлов.
+     * Пустая функция - отслеживание выключается
+     * @param debounce Время без событий, после которого проверяется
+     * содержимое файлов
      */
-    ~ConfigNodePath() noexcept;
+    void Watch(const std::function<void()> &callback,
+               std::chrono::milliseconds debounce) noexcept;
 
     /**
-     * @brief Запрос количества ключей в пути.
+     * @brief Добавление подписчика на изменение части конфигурационного
+     * файла.
      *
-     * @return Количество ключей
+     * @param prefixes Пути к узлам конфигурационного файла
+     * @param callback Функция оповещения
+     *
+     * @return Подписчик
      */
-    [[nodiscard]] std::size_t Size() const noexcept;
+    [[nodiscard]] std::shared_ptr<Subscriber> Subscribe(
+        std::vector<std::string> prefixes,
+        const std::function<void()> &callback) noexcept;
 
     /**
-     * @brief Запрос пути в виде строки.
+     * @brief Удаление подписчика.
+     *
+     * Если функция оповещения выполняется в другом потоке, ожидает ее
+     * завершения.
      *
-     * @return Путь в виде строки
+     * @param subscriber Подписчик
      */
-    [[nodiscard]] std::string String() const noexcept;
+    void Unsubscribe(const Subscriber *subscriber) noexcept;
 
-    // Выключается проверка стиля наименований для этого участка, т.к. это
-    // методы для использования в стандартной библиотеке c++.
-    // NOLINTBEGIN(readability-identifier-naming)
+    ConfigGlobalImpl(const ConfigGlobalImpl &) = delete;
+    ConfigGlobalImpl(ConfigGlobalImpl &&) = delete;
+    ConfigGlobalImpl &operator=(const ConfigGlobalImpl &) = delete;
+    ConfigGlobalImpl &operator=(ConfigGlobalImpl &&) = delete;
 
+private:
     /**
-     * @brief Запрос итератора первого элемента.
+     * @brief Загрузка нового снимка конфигурационного файла.
      *
-     * @return Итератор
+     * @param initial Первая загрузка. При перезагрузке снимок не создается,
+     * если основной конфигурационный файл не найден или содержит ошибки
+     *
+     * @return Снимок или nullptr
      */
-    [[nodiscard]] std::vector<std::string>::const_iterator begin()
-        const noexcept;
+    [[nodiscard]] std::shared_ptr<const ConfigImpl> Load(bool initial) noexcept;
 
     /**
-     * @brief Запрос итератора последнего элемента.
+     * @brief Загрузка снимка конфигурационного файла из двоичного кэша.
      *
-     * @return Итератор
+     * @return Снимок или nullptr, если кэш отсутствует или недействителен
      */
-    [[nodiscard]] std::vector<std::string>::const_iterator end() const noexcept;
-    // NOLINTEND(readability-identifier-naming)
+    [[nodiscard]] std::shared_ptr<ConfigImpl> LoadCache() const noexcept;
 
-    ConfigNodePath(const ConfigNodePath &) = delete;
-    ConfigNodePath(ConfigNodePath &&) = delete;
-    ConfigNodePath &operator=(const ConfigNodePath &) = delete;
-    ConfigNodePath &operator=(ConfigNodePath &&) = delete;
+    /**
+     * @brief Сохранение снимка в двоичный кэш или удаление кэша.
+     *
+     * Кэш сохраняется, если включен параметр config.cache.enabled, иначе
+     * файл кэша удаляется. Если исходный файл изменен позже начала загрузки
+     * (с запасом в 1 секунду на точность времени изменения), кэш не
+     * сохраняется: содержимое могло быть прочитано до изменения.
+     *
+     * @param config Снимок
+     * @param started Время начала загрузки в наносекундах
+     */
+    void StoreCache(const ConfigImpl &config,
+                    std::int64_t started) const noexcept;
+
+    /**
+     * @brief Подготовка снимка к запросам значений.
+     *
+     * Если включен параметр config.compact, снимок преобразуется в
+     * компактное представление (@ref ConfigImpl::Compact), а кэш включаемых
+     * файлов очищается. Иначе строится индекс параметров.
+     *
+     * @param config Снимок
+     */
+    static void Prepare(ConfigImpl &config) noexcept;
+
+    /**
+     * @brief Запрос дополнительных данных для ключа кэша.
+     *
+     * Кэш зависит от стандартных параметров программы (@ref InitBaseParams)
+     * и пути к конфигурационному файлу.
+     *
+     * @return Дополнительные данные
+     */
+    [[nodiscard]] std::string CacheSalt() const noexcept;
+
+    /**
+     * @brief Запрос пути к файлу кэша.
+     *
+     * Директория кэша должна быть известна до разбора конфигурационного
+     * файла, поэтому задается переменной окружения TASP_CACHE_DIR. Если она не
+     * задана, используется директория tasp в $XDG_CACHE_HOME, иначе - cache в
+     * директории с программой. Название файла включает хэш полного пути к
+     * конфигурационному файлу и дополнительных данных ключа кэша, чтобы
+     * разные программы и типы запуска с одним конфигурационным файлом не
+     * перезаписывали кэш друг друга.
+     *
+     * @param path Путь к конфигурационному файлу
+     * @param salt Дополнительные данные для ключа кэша (@ref CacheSalt)
+     *
+     * @return Путь к файлу кэша
+     */
+    static fs::path CachePath(const fs::path &path,
+                              std::string_view salt) noexcept;
+
+    /**
+     * @brief Добавление стандартных параметров для каждой программы.
+     *
+     * Параметры:
+     * program.name - название программы
+     * program.path - пусть запуска программы
+     * program.systemd - тип запуска. Пользовательская программа или сервис.
+     *
+     * @param config Конфигурационный файл
+     */
+    static void InitBaseParams(ConfigImpl &config) noexcept;
+
+    /**
+     * @brief Поиск подписчиков, узлы которых изменились.
+     *
+     * Снимки сравниваются, только если есть подписчики. Подписчик попадает в
+     * список один раз, даже если изменились несколько его узлов.
+     *
+     * @param previous Предыдущий снимок
+     * @param current Новый снимок
+     *
+     * @return Подписчики для оповещения
+     */
+    [[nodiscard]] std::vector<std::shared_ptr<Subscriber>> Changed(
+        const ConfigImpl &previous,
+        const ConfigImpl &current) noexcept;
+
+    /**
+     * @brief Оповещение подписчиков.
+     *
+     * Вызывается без захваченных @ref reload_mutex_ и
+     * @ref subscribers_mutex_, поэтому функции оповещения могут перезагружать
+     * файл и изменять подписки. Функция удаленного подписчика не вызывается.
+     *
+     * @param subscribers Подписчики для оповещения
+     */
+    void Notify(
+        const std::vector<std::shared_ptr<Subscriber>> &subscribers) noexcept;
+
+    /**
+     * @brief Поиск конфигурационного файла в стандартных местах размещения.
+     *
+     * @return Полный путь к найденному файлу
+     */
+    static fs::path DefaultPath() noexcept;
+
+    /**
+     * @brief Полный путь к конфигурационному файлу.
+     */
+    fs::path path_;
+
+    /**
+     * @brief Путь к файлу двоичного кэша.
+     */
+    fs::path cache_path_;
+
+    /**
+     * @brief Снимок, используемый потоком (hazard pointer).
+     *
+     * Объект регистрируется в общем списке при первом обращении потока к
+     * конфигурационному файлу и удаляется из него при завершении потока.
+     */
+    struct LocalSnapshot
+    {
+        /**
+         * @brief Конструктор. Регистрирует объект в общем списке.
+         */
+        LocalSnapshot() noexcept;
+
+        /**
+         * @brief Деструктор. Удаляет объект из общего списка.
+         */
+        ~LocalSnapshot() noexcept;
+
+        /**
+         * @brief Идентификатор конфигурационного файла, которому принадлежит
+         * используемый снимок.
+         */
+        std::uint64_t owner{0};
+
+        /**
+         * @brief Глубина вложенных обращений к снимку.
+         */
+        std::size_t depth{0};
+
+        /**
+         * @brief Используемый снимок. nullptr - поток не обращается к
+         * снимку. Снимок не удаляется при перезагрузке, пока указатель на
+         * него установлен.
+         */
+        std::atomic<const ConfigImpl *> snapshot{nullptr};
+
+        LocalSnapshot(const LocalSnapshot &) = delete;
+        LocalSnapshot(LocalSnapshot &&) = delete;
+        LocalSnapshot &operator=(const LocalSnapshot &) = delete;
+        LocalSnapshot &operator=(LocalSnapshot &&) = delete;
+    };
+
+    /**
+     * @brief Список снимков, используемых потоками.
+     */
+    struct LocalSnapshots
+    {
+        /**
+         * @brief Мьютекс для изменения и обхода списка.
+         */
+        std::mutex mutex;
+
+        /**
+         * @brief Снимки потоков.
+         */
+        std::vector<const LocalSnapshot *> locals;
+    };
+
+    /**
+     * @brief Обращение к текущему снимку.
+     *
+     * Снимок читается без блокировок и без изменения общего счетчика ссылок:
+     * поток публикует указатель на снимок в @ref LocalSnapshot, а перезагрузка
+     * удаляет замененный снимок, только когда ни один поток его не
+     * использует. Поэтому поток, переставший читать параметры, не удерживает
+     * устаревший снимок.
+     *
+     * @param function Функция, получающая ссылку на снимок
+     *
+     * @return Результат функции
+     */
+    template<typename Function>
+    auto Visit(Function &&function) const noexcept;
+
+    /**
+     * @brief Запрос снимка, используемого текущим потоком.
+     *
+     * @return Снимок потока
+     */
+    static LocalSnapshot &Local() noexcept;
+
+    /**
+     * @brief Запрос списка снимков, используемых потоками.
+     *
+     * Список не удаляется при завершении программы, т.к. потоки могут
+     * завершаться после удаления статических объектов.
+     *
+     * @return Список снимков потоков
+     */
+    static LocalSnapshots &Locals() noexcept;
+
+    /**
+     * @brief Удаление замененных снимков, которые не используются потоками.
+     *
+     * Вызывается при захваченном @ref reload_mutex_.
+     */
+    void Reclaim() noexcept;
+
+    /**
+     * @brief Счетчик созданных конфигурационных файлов.
+     */
+    inline static std::atomic<std::uint64_t> instances_{0};
+
+    /**
+     * @brief Идентификатор конфигурационного файла для снимков потоков.
+     */
+    const std::uint64_t id_{++instances_};
+
+    /**
+     * @brief Текущий снимок конфигурационного файла.
+     *
+     * Изменяется при захваченных @ref reload_mutex_ и @ref snapshot_mutex_.
+     */
+    std::shared_ptr<const ConfigImpl> snapshot_;
+
+    /**
+     * @brief Мьютекс для копирования @ref snapshot_.
+     */
+    mutable std::mutex snapshot_mutex_;
+
+    /**
+     * @brief Указатель на текущий снимок для чтения без блокировок.
+     */
+    std::atomic<const ConfigImpl *> current_{nullptr};
+
+    /**
+     * @brief Замененные снимки, которые могут использоваться потоками.
+     */
+    std::vector<std::shared_ptr<const ConfigImpl>> retired_;
+
+    /**
+     * @brief Мьютекс для синхронизации перезагрузок файла.
+     */
+    std::mutex reload_mutex_;
+
+    /**
+     * @brief Номер загрузки конфигурационного файла.
+     */
+    std::atomic<std::uint64_t> generation_{1};
+
+    /**
+     * @brief Хэш содержимого файлов при последней загрузке.
+     */
+    std::atomic<std::size_t> hash_{0};
+
+    /**
+     * @brief Подписчики на изменение частей конфигурационного файла.
+     */
+    std::vector<std::shared_ptr<Subscriber>> subscribers_;
+
+    /**
+     * @brief Мьютекс для синхронизации доступа к подписчикам.
+     */
+    std::mutex subscribers_mutex_;
+
+    /**
+     * @brief Мьютекс для синхронизации оповещений.
+     *
+     * Захватывается на время вызова функций оповещения, чтобы после удаления
+     * подписчика его функция не выполнялась. Рекурсивный: функция оповещения
+     * может перезагрузить файл или удалить подписку.
+     */
+    std::recursive_mutex notify_mutex_;
+
+    /**
+     * @brief Отслеживание изменений конфигурационных файлов.
+     *
+     * Удаляется первым: поток отслеживания обращается к снимку.
+     */
+    std::unique_ptr<ConfigWatcher> watcher_{nullptr};
+};
+
+/**
+ * @brief Класс пути к параметрам в конфигурационном файле.
+ */
+class ConfigNodePath final
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * Путь состоит из последовательных значений ключей разделенных знаком ".".
+     * Путь разделяется на элементы и помещается в вектор для последовательного
+     * доступа по ключам конфигурационного файла.
+     *
+     * @param path Полный путь к значению
+     */
+    explicit ConfigNodePath(std::string_view path) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~ConfigNodePath() noexcept;
+
+    /**
+     * @brief Запрос количества ключей в пути.
+     *
+     * @return Количество ключей
+     */
+    [[nodiscard]] std::size_t Size() const noexcept;
+
+    /**
+     * @brief Запрос пути в виде строки.
+     *
+     * @return Путь в виде строки без разделителя в конце
+     */
+    [[nodiscard]] const std::string &String() const noexcept;
+
+    /**
+     * @brief Запрос символа разделителя ключей в пути.
+     *
+     * @return Символ разделителя
+     */
+    [[nodiscard]] static char Delimiter() noexcept;
+
+    // Выключается проверка стиля наименований для этого участка, т.к. это
+    // методы для использования в стандартной библиотеке c++.
+    // NOLINTBEGIN(readability-identifier-naming)
+
+    /**
+     * @brief Запрос итератора первого элемента.
+     *
+     * @return Итератор
+     */
+    [[nodiscard]] std::vector<std::string>::const_iterator begin()
+        const noexcept;
+
+    /**
+     * @brief Запрос итератора последнего элемента.
+     *
+     * @return Итератор
+     */
+    [[nodiscard]] std::vector<std::string>::const_iterator end() const noexcept;
+    // NOLINTEND(readability-identifier-naming)
+
+    ConfigNodePath(const ConfigNodePath &) = delete;
+    ConfigNodePath(ConfigNodePath &&) = delete;
+    ConfigNodePath &operator=(const ConfigNodePath &) = delete;
+    ConfigNodePath &operator=(ConfigNodePath &&) = delete;
 
 private:
     /**
@@ -346,6 +1151,131 @@ private:
     std::vector<std::string> keys_;
 };
 
+/**
+ * @brief Реализация подписки на изменение части глобального
+ * конфигурационного файла.
+ */
+class ConfigSubscriptionImpl final
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * @param config Глобальный конфигурационный файл
+     * @param subscriber Подписчик
+     */
+    ConfigSubscriptionImpl(
+        ConfigGlobalImpl &config,
+        std::shared_ptr<ConfigGlobalImpl::Subscriber> subscriber) noexcept;
+
+    /**
+     * @brief Деструктор. Удаляет подписчика.
+     */
+    ~ConfigSubscriptionImpl() noexcept;
+
+    ConfigSubscriptionImpl(const ConfigSubscriptionImpl &) = delete;
+    ConfigSubscriptionImpl(ConfigSubscriptionImpl &&) = delete;
+    ConfigSubscriptionImpl &operator=(const ConfigSubscriptionImpl &) = delete;
+    ConfigSubscriptionImpl &operator=(ConfigSubscriptionImpl &&) = delete;
+
+private:
+    /**
+     * @brief Глобальный конфигурационный файл.
+     */
+    ConfigGlobalImpl &config_;
+
+    /**
+     * @brief Подписчик.
+     */
+    std::shared_ptr<ConfigGlobalImpl::Subscriber> subscriber_;
+};
+
+/**
+ * @brief Реализация ключа глобального конфигурационного файла с кэшированием
+ * значения.
+ */
+template<typename Type>
+class ConfigKeyImpl final
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * @param config Глобальный конфигурационный файл
+     * @param path Полный путь к значению
+     * @param default_value Значение по умолчанию
+     */
+    ConfigKeyImpl(const ConfigGlobalImpl &config,
+                  std::string_view path,
+                  const Type &default_value) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~ConfigKeyImpl() noexcept = default;
+
+    /**
+     * @brief Запрос значения.
+     *
+     * Если номер загрузки сохраненного значения совпадает с текущим,
+     * возвращается сохраненное значение без блокировок. Иначе значение
+     * запрашивается из конфигурационного файла и сохраняется.
+     *
+     * @return Значение
+     */
+    [[nodiscard]] Type Get() const noexcept;
+
+    ConfigKeyImpl(const ConfigKeyImpl &) = delete;
+    ConfigKeyImpl(ConfigKeyImpl &&) = delete;
+    ConfigKeyImpl &operator=(const ConfigKeyImpl &) = delete;
+    ConfigKeyImpl &operator=(ConfigKeyImpl &&) = delete;
+
+private:
+    /**
+     * @brief Глобальный конфигурационный файл.
+     */
+    const ConfigGlobalImpl &config_;
+
+    /**
+     * @brief Разобранный путь к значению.
+     */
+    ConfigNodePath path_;
+
+    /**
+     * @brief Значение по умолчанию.
+     */
+    Type default_value_;
+
+    /**
+     * @brief Номер загрузки конфигурационного файла, из которой получено
+     * сохраненное значение.
+     *
+     * Записывается после значения.
+     */
+    mutable std::atomic<std::uint64_t> generation_{0};
+
+    /**
+     * @brief Сохраненное значение.
+     *
+     * Указывает на элемент values_ и читается без блокировок.
+     */
+    mutable std::atomic<const Type *> value_{nullptr};
+
+    /**
+     * @brief Мьютекс для синхронизации обновления значения.
+     */
+    mutable std::mutex mutex_;
+
+    /**
+     * @brief Полученные значения.
+     *
+     * Прежние значения не освобождаются до удаления ключа, так как могут
+     * читаться из других потоков. Новое значение добавляется только при его
+     * изменении, а не при каждой перезагрузке.
+     */
+    mutable std::vector<std::unique_ptr<const Type>> values_;
+};
+
 /*------------------------------------------------------------------------------
     ConfigImpl
 ------------------------------------------------------------------------------*/
@@ -355,9 +1285,40 @@ Type ConfigImpl::Get(const ConfigNodePath &path,
 {
     Type value{default_value};
 
+    // Числа разбираются при построении индекса, так как преобразование
+    // yaml-cpp через поток занимает большую часть времени запроса.
+    if constexpr (std::is_integral_v<Type> && !std::is_same_v<Type, bool>)
+    {
+        if (GetInteger(path, value))
+        {
+            return value;
+        }
+    }
+
+    // Строки копируются из узла без преобразования yaml-cpp.
+    if constexpr (std::is_same_v<Type, std::string> ||
+                  std::is_same_v<Type, fs::path>)
+    {
+        std::string_view scalar{};
+        if (GetView(path, scalar))
+        {
+            try
+            {
+                return Type{std::string{scalar}};
+            }
+            catch (const std::exception &exception)
+            {
+                Logging::Error("Ошибка при конвертации значения из "
+                               "конфигурационного файла: {}",
+                               exception.what());
+                return value;
+            }
+        }
+    }
+
     try
     {
-        const YAML::Node node{GetNode(path)};
+        const YAML::Node node{FindNode(path)};
         if (node.Type() != YAML::NodeType::Undefined)
         {
             value = node.as<Type>();
@@ -377,6 +1338,17 @@ Type ConfigImpl::Get(const ConfigNodePath &path,
 template<typename Type>
 void ConfigImpl::Set(const ConfigNodePath &path, const Type &value) noexcept
 {
+    if (arena_ != nullptr)
+    {
+        Logging::Error("Изменение параметра {} недоступно: конфигурационный "
+                       "файл {} в компактном представлении",
+                       path.String(),
+                       fullpath_);
+        return;
+    }
+
+    ResetIndex();
+
     try
     {
         YAML::Node node{GetNode(path)};
@@ -397,6 +1369,155 @@ void ConfigImpl::Set(const ConfigNodePath &path, const Type &value) noexcept
     }
 }
 
+//------------------------------------------------------------------------------
+template<typename Type>
+bool ConfigImpl::GetInteger(const ConfigNodePath &path,
+                            Type &value) const noexcept
+{
+    std::int64_t number{0};
+    return FindInteger(path, number) && Narrow(number, value);
+}
+
+//------------------------------------------------------------------------------
+template<typename Type>
+bool ConfigImpl::Narrow(std::int64_t number, Type &value) noexcept
+{
+    if constexpr (std::is_unsigned_v<Type>)
+    {
+        if (number < 0 ||
+            static_cast<std::uint64_t>(number) >
+                std::numeric_limits<Type>::max())
+        {
+            return false;
+        }
+    }
+    else
+    {
+        if (number < std::numeric_limits<Type>::min() ||
+            number > std::numeric_limits<Type>::max())
+        {
+            return false;
+        }
+    }
+
+    value = static_cast<Type>(number);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+template<typename Type>
+std::size_t ConfigImpl::ForEach(
+    const ConfigNodePath &path,
+    const std::function<void(const Type &)> &callback) const noexcept
+{
+    std::size_t count{0};
+    Type value{};
+
+    // Элементы компактного представления преобразуются без восстановления
+    // узлов yaml-cpp, если тип это позволяет.
+    if (arena_ != nullptr)
+    {
+        std::uint32_t node{0};
+        if (!arena_->Find(path, node) ||
+            arena_->Type(node) != YAML::NodeType::Sequence)
+        {
+            return 0;
+        }
+
+        for (std::uint32_t i{0}; i < arena_->Size(node); ++i)
+        {
+            const std::uint32_t child{arena_->Child(node, i)};
+            if (Convert(path,
+                        arena_->Type(child) == YAML::NodeType::Scalar,
+                        arena_->Scalar(child),
+                        [this, child]() { return arena_->Restore(child); },
+                        value))
+            {
+                callback(value);
+                ++count;
+            }
+        }
+
+        return count;
+    }
+
+    const YAML::Node node{FindNode(path)};
+    if (node.Type() != YAML::NodeType::Sequence)
+    {
+        return 0;
+    }
+
+    // Значение скалярного узла хранится в документе, поэтому ссылка на него
+    // действительна после удаления копии узла.
+    for (const auto &element : node)
+    {
+        const bool scalar{element.IsScalar()};
+        if (Convert(path,
+                    scalar,
+                    scalar ? std::string_view{element.Scalar()}
+                           : std::string_view{},
+                    [&element]() { return YAML::Node{element}; },
+                    value))
+        {
+            callback(value);
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+//------------------------------------------------------------------------------
+template<typename Type, typename Node>
+bool ConfigImpl::Convert(const ConfigNodePath &path,
+                         bool scalar,
+                         std::string_view text,
+                         const Node &node,
+                         Type &value) noexcept
+{
+    if constexpr (std::is_same_v<Type, std::string_view>)
+    {
+        value = text;
+        return scalar;
+    }
+    else
+    {
+        if constexpr (std::is_integral_v<Type> && !std::is_same_v<Type, bool>)
+        {
+            std::int64_t number{0};
+            if (scalar && ParseInteger(text, number) && Narrow(number, value))
+            {
+                return true;
+            }
+        }
+
+        try
+        {
+            if constexpr (std::is_same_v<Type, std::string> ||
+                          std::is_same_v<Type, fs::path>)
+            {
+                if (scalar)
+                {
+                    value = std::string{text};
+                    return true;
+                }
+            }
+
+            value = node().template as<Type>();
+        }
+        catch (const std::exception &exception)
+        {
+            Logging::Error("Ошибка при конвертации элемента {} из "
+                           "конфигурационного файла: {}",
+                           path.String(),
+                           exception.what());
+            return false;
+        }
+
+        return true;
+    }
+}
+
 /*------------------------------------------------------------------------------
     ConfigGlobalImpl
 ------------------------------------------------------------------------------*/
@@ -404,8 +1525,104 @@ template<typename Type>
 Type ConfigGlobalImpl::Get(const ConfigNodePath &path,
                            const Type &default_value) const noexcept
 {
+    return Visit([&path, &default_value](const ConfigImpl &snapshot)
+                 { return snapshot.Get(path, default_value); });
+}
+
+//------------------------------------------------------------------------------
+template<typename Type>
+std::size_t ConfigGlobalImpl::ForEach(
+    const ConfigNodePath &path,
+    const std::function<void(const Type &)> &callback) const noexcept
+{
+    return Visit([&path, &callback](const ConfigImpl &snapshot)
+                 { return snapshot.ForEach(path, callback); });
+}
+
+//------------------------------------------------------------------------------
+template<typename Function>
+auto ConfigGlobalImpl::Visit(Function &&function) const noexcept
+{
+    auto &local{Local()};
+
+    if (local.depth != 0)
+    {
+        // Во вложенном обращении к тому же файлу используется снимок
+        // внешнего обращения. Указатель потока занят внешним обращением,
+        // поэтому снимок другого файла копируется под мьютексом.
+        if (local.owner == id_)
+        {
+            return function(*local.snapshot.load(std::memory_order_relaxed));
+        }
+
+        const auto snapshot{Snapshot()};
+        return function(*snapshot);
+    }
+
+    // После публикации указателя снимок проверяется повторно: если он был
+    // заменен до публикации, перезагрузка могла его уже удалить.
+    const ConfigImpl *snapshot{current_.load()};
+    local.snapshot = snapshot;
+    for (const ConfigImpl *check{current_.load()}; check != snapshot;
+         check = current_.load())
+    {
+        snapshot = check;
+        local.snapshot = snapshot;
+    }
+    local.owner = id_;
+
+    ++local.depth;
+    auto result{function(*snapshot)};
+    --local.depth;
+
+    local.snapshot.store(nullptr, std::memory_order_release);
+
+    return result;
+}
+
+/*------------------------------------------------------------------------------
+    ConfigKeyImpl
+------------------------------------------------------------------------------*/
+template<typename Type>
+ConfigKeyImpl<Type>::ConfigKeyImpl(const ConfigGlobalImpl &config,
+                                   std::string_view path,
+                                   const Type &default_value) noexcept
+: config_(config)
+, path_(path)
+, default_value_(default_value)
+{
+}
+
+//------------------------------------------------------------------------------
+template<typename Type>
+Type ConfigKeyImpl<Type>::Get() const noexcept
+{
+    const std::uint64_t generation{config_.Generation()};
+    if (generation_ == generation)
+    {
+        return *value_;
+    }
+
     const std::scoped_lock lock{mutex_};
-    return ConfigImpl::Get(path, default_value);
+
+    // Номер загрузки запрашивается до значения: если перезагрузка произойдет
+    // между запросами, новое значение будет запрошено повторно при следующем
+    // вызове.
+    if (generation_ != generation)
+    {
+        auto value{config_.Get(path_, default_value_)};
+
+        const Type *current{value_};
+        if (current == nullptr || !(*current == value))
+        {
+            values_.push_back(std::make_unique<const Type>(std::move(value)));
+            value_ = values_.back().get();
+        }
+
+        generation_ = generation;
+    }
+
+    return *value_;
 }
 
 }  // namespace tasp
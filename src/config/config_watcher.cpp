@@ -0,0 +1,271 @@
+#include "config_watcher.hpp"
+
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <system_error>
+
+#include "../daemon/signal_stack.hpp"
+#include "config_impl.hpp"
+#include "tasp/logging.hpp"
+
+using std::array;
+using std::error_code;
+using std::function;
+using std::make_unique;
+using std::size_t;
+using std::system_category;
+using std::thread;
+using std::uint32_t;
+using std::uint64_t;
+using std::vector;
+using std::chrono::duration_cast;
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+namespace tasp
+{
+/*------------------------------------------------------------------------------
+    ConfigWatcher
+------------------------------------------------------------------------------*/
+ConfigWatcher::ConfigWatcher(const ConfigGlobalImpl &config,
+                             function<void()> callback,
+                             milliseconds debounce) noexcept
+: config_(config)
+, callback_(std::move(callback))
+, debounce_(debounce)
+{
+    inotify_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    stop_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (inotify_ == -1 || stop_ == -1)
+    {
+        const error_code error{errno, system_category()};
+        Logging::Error("Не удалось запустить отслеживание изменений "
+                       "конфигурационного файла: {}",
+                       error.message());
+        return;
+    }
+
+    thread_ = make_unique<thread>(&ConfigWatcher::Worker, this);
+}
+
+//------------------------------------------------------------------------------
+ConfigWatcher::~ConfigWatcher() noexcept
+{
+    if (thread_ != nullptr)
+    {
+        const uint64_t value{1};
+        if (write(stop_, &value, sizeof(value)) != sizeof(value))
+        {
+            const error_code error{errno, system_category()};
+            Logging::Error("Ошибка при остановке отслеживания изменений "
+                           "конфигурационного файла: {}",
+                           error.message());
+        }
+        thread_->join();
+    }
+
+    // Закрытие дескриптора inotify удаляет все отслеживания.
+    if (inotify_ != -1)
+    {
+        close(inotify_);
+    }
+    if (stop_ != -1)
+    {
+        close(stop_);
+    }
+}
+
+//------------------------------------------------------------------------------
+void ConfigWatcher::Worker() noexcept
+{
+    const SignalStack signal_stack{};
+
+    pthread_setname_np(pthread_self(), "tasp-config");
+
+    // Перезагрузка не вызывает событий inotify, поэтому номер загрузки
+    // проверяется периодически.
+    const milliseconds check_interval{1000};
+
+    uint64_t generation{config_.Generation()};
+    Watch(config_.Snapshot()->Files());
+
+    // Файлы могли измениться после загрузки снимка до начала отслеживания.
+    Check();
+
+    bool pending{false};
+    auto last_event{steady_clock::now()};
+
+    while (true)
+    {
+        if (generation != config_.Generation())
+        {
+            generation = config_.Generation();
+            Watch(config_.Snapshot()->Files());
+        }
+
+        milliseconds timeout{check_interval};
+        if (pending)
+        {
+            const auto elapsed{
+                duration_cast<milliseconds>(steady_clock::now() - last_event)};
+            if (elapsed >= debounce_)
+            {
+                pending = false;
+                Check();
+                continue;
+            }
+            timeout = debounce_ - elapsed;
+        }
+
+        array<pollfd, 2> descriptors{
+            {{inotify_, POLLIN, 0}, {stop_, POLLIN, 0}}};
+        if (poll(descriptors.data(),
+                 descriptors.size(),
+                 static_cast<int>(timeout.count())) == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            const error_code error{errno, system_category()};
+            Logging::Error("Ошибка отслеживания изменений конфигурационного "
+                           "файла: {}",
+                           error.message());
+            return;
+        }
+
+        if ((descriptors[1].revents & POLLIN) != 0)
+        {
+            return;
+        }
+
+        if ((descriptors[0].revents & POLLIN) != 0 && ReadEvents())
+        {
+            pending = true;
+            last_event = steady_clock::now();
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void ConfigWatcher::Watch(const vector<fs::path> &files) noexcept
+{
+    for (const auto &directory : directories_)
+    {
+        inotify_rm_watch(inotify_, directory.first);
+    }
+    directories_.clear();
+
+    const uint32_t mask{IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM |
+                        IN_CREATE | IN_DELETE};
+    for (const auto &file : files)
+    {
+        const fs::path path{file.parent_path()};
+        const int descriptor{inotify_add_watch(inotify_, path.c_str(), mask)};
+        if (descriptor == -1)
+        {
+            const error_code error{errno, system_category()};
+            Logging::Warning("Не удалось отслеживать изменения в директории "
+                             "{}: {}",
+                             path,
+                             error.message());
+            continue;
+        }
+
+        auto &directory{directories_[descriptor]};
+        directory.path = path;
+        directory.names.insert(file.filename().string());
+
+        error_code error{};
+        if (fs::is_symlink(file, error))
+        {
+            directory.all = true;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ConfigWatcher::ReadEvents() noexcept
+{
+    bool changed{false};
+
+    alignas(inotify_event) array<char, 4096> buffer{};
+    while (true)
+    {
+        const ssize_t size{read(inotify_, buffer.data(), buffer.size())};
+        if (size <= 0)
+        {
+            if (size == -1 && errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        for (size_t offset{0}; offset < static_cast<size_t>(size);)
+        {
+            const auto *event{
+                reinterpret_cast<const inotify_event *>(&buffer[offset])};
+            offset += sizeof(inotify_event) + event->len;
+
+            // При переполнении очереди события потеряны, содержимое
+            // проверяется в любом случае.
+            if ((event->mask & IN_Q_OVERFLOW) != 0)
+            {
+                changed = true;
+                continue;
+            }
+
+            const auto directory{directories_.find(event->wd)};
+            if (directory == directories_.end())
+            {
+                continue;
+            }
+
+            // Директория удалена, отслеживание снято.
+            if ((event->mask & IN_IGNORED) != 0)
+            {
+                directories_.erase(directory);
+                changed = true;
+                continue;
+            }
+
+            if (directory->second.all ||
+                (event->len != 0 &&
+                 directory->second.names.count(event->name) != 0))
+            {
+                changed = true;
+            }
+        }
+    }
+
+    return changed;
+}
+
+//------------------------------------------------------------------------------
+void ConfigWatcher::Check() noexcept
+{
+    ConfigImpl config{config_.Path()};
+    config.Include();
+
+    const size_t hash{config.Hash()};
+    if (hash == config_.Hash() || hash == notified_hash_)
+    {
+        return;
+    }
+
+    notified_hash_ = hash;
+
+    Logging::Info("Изменен конфигурационный файл {}", config.GetPath());
+
+    callback_();
+}
+
+}  // namespace tasp
@@ -0,0 +1,160 @@
+/**
+ * @file
+ * @brief Отслеживание изменений конфигурационных файлов.
+ */
+#ifndef TASP_CONFIG_CONFIG_WATCHER_HPP_
+#define TASP_CONFIG_CONFIG_WATCHER_HPP_
+
+#include <chrono>
+#include <experimental/filesystem>
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::experimental::filesystem;
+
+namespace tasp
+{
+
+class ConfigGlobalImpl;
+
+/**
+ * @brief Отслеживание изменений конфигурационных файлов.
+ *
+ * Отдельный поток через inotify отслеживает директории основного
+ * конфигурационного файла и всех файлов из параметра include. Отслеживаются
+ * директории, а не файлы, так как редакторы и системы управления
+ * конфигурацией заменяют файл переименованием временного.
+ *
+ * После события выполняется ожидание, пока события не прекратятся на время
+ * задержки. Затем файлы читаются заново, и функция оповещения вызывается,
+ * только если хэш содержимого отличается от хэша последней загрузки (в том
+ * числе неудачной, чтобы некорректный файл не перезагружался повторно).
+ * Содержимое также проверяется при запуске потока. Список отслеживаемых
+ * файлов обновляется после перезагрузки конфигурационного файла.
+ */
+class ConfigWatcher final
+{
+public:
+    /**
+     * @brief Конструктор. Запускает поток отслеживания.
+     *
+     * @param config Глобальный конфигурационный файл
+     * @param callback Функция оповещения об изменении файлов. Вызывается из
+     * потока отслеживания
+     * @param debounce Время без событий, после которого проверяется
+     * содержимое файлов
+     */
+    ConfigWatcher(const ConfigGlobalImpl &config,
+                  std::function<void()> callback,
+                  std::chrono::milliseconds debounce) noexcept;
+
+    /**
+     * @brief Деструктор. Останавливает поток отслеживания.
+     */
+    ~ConfigWatcher() noexcept;
+
+    ConfigWatcher(const ConfigWatcher &) = delete;
+    ConfigWatcher(ConfigWatcher &&) = delete;
+    ConfigWatcher &operator=(const ConfigWatcher &) = delete;
+    ConfigWatcher &operator=(ConfigWatcher &&) = delete;
+
+private:
+    /**
+     * @brief Отслеживаемая директория.
+     */
+    struct Directory
+    {
+        /**
+         * @brief Путь к директории.
+         */
+        fs::path path;
+
+        /**
+         * @brief Названия отслеживаемых файлов в директории.
+         */
+        std::set<std::string> names;
+
+        /**
+         * @brief Признак отслеживания всех событий директории.
+         *
+         * Устанавливается, если отслеживаемый файл - символическая ссылка:
+         * при замене цели ссылки события приходят для других файлов.
+         */
+        bool all{false};
+    };
+
+    /**
+     * @brief Функция потока отслеживания.
+     */
+    void Worker() noexcept;
+
+    /**
+     * @brief Установка отслеживания директорий файлов.
+     *
+     * Ранее установленное отслеживание удаляется.
+     *
+     * @param files Отслеживаемые файлы
+     */
+    void Watch(const std::vector<fs::path> &files) noexcept;
+
+    /**
+     * @brief Чтение событий inotify.
+     *
+     * @return Признак события для отслеживаемого файла
+     */
+    bool ReadEvents() noexcept;
+
+    /**
+     * @brief Проверка изменения содержимого файлов и оповещение.
+     */
+    void Check() noexcept;
+
+    /**
+     * @brief Глобальный конфигурационный файл.
+     */
+    const ConfigGlobalImpl &config_;
+
+    /**
+     * @brief Функция оповещения об изменении файлов.
+     */
+    std::function<void()> callback_;
+
+    /**
+     * @brief Время без событий до проверки содержимого файлов.
+     */
+    std::chrono::milliseconds debounce_;
+
+    /**
+     * @brief Дескриптор inotify.
+     */
+    int inotify_{-1};
+
+    /**
+     * @brief Дескриптор eventfd для остановки потока.
+     */
+    int stop_{-1};
+
+    /**
+     * @brief Отслеживаемые директории по дескриптору отслеживания.
+     */
+    std::unordered_map<int, Directory> directories_;
+
+    /**
+     * @brief Хэш содержимого, о котором уже отправлено оповещение.
+     */
+    std::size_t notified_hash_{0};
+
+    /**
+     * @brief Поток отслеживания.
+     */
+    std::unique_ptr<std::thread> thread_{nullptr};
+};
+
+}  // namespace tasp
+
+#endif  // TASP_CONFIG_CONFIG_WATCHER_HPP_
@@ -0,0 +1,137 @@
+#include "include_cache.hpp"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <ctime>
+
+#include "tasp/logging.hpp"
+
+using std::exception;
+using std::int64_t;
+using std::scoped_lock;
+using std::size_t;
+using std::uint64_t;
+
+namespace tasp
+{
+/*------------------------------------------------------------------------------
+    IncludeCache
+------------------------------------------------------------------------------*/
+IncludeCache::IncludeCache() noexcept = default;
+
+//------------------------------------------------------------------------------
+IncludeCache::~IncludeCache() noexcept = default;
+
+//------------------------------------------------------------------------------
+IncludeCache &IncludeCache::Instance() noexcept
+{
+    static IncludeCache instance{};
+    return instance;
+}
+
+//------------------------------------------------------------------------------
+bool IncludeCache::Stat(const fs::path &path, Version &version) noexcept
+{
+    struct stat info
+    {
+    };
+    if (stat(path.c_str(), &info) == -1)
+    {
+        return false;
+    }
+
+    const int64_t nanoseconds{1'000'000'000};
+    version.mtime = static_cast<int64_t>(info.st_mtim.tv_sec) * nanoseconds +
+                    static_cast<int64_t>(info.st_mtim.tv_nsec);
+    version.size = static_cast<uint64_t>(info.st_size);
+    version.device = static_cast<uint64_t>(info.st_dev);
+    version.inode = static_cast<uint64_t>(info.st_ino);
+    version.ctime = static_cast<int64_t>(info.st_ctim.tv_sec) * nanoseconds +
+                    static_cast<int64_t>(info.st_ctim.tv_nsec);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool IncludeCache::Recent(const Version &version) noexcept
+{
+    timespec now{};
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    const int64_t nanoseconds{1'000'000'000};
+    const int64_t current{static_cast<int64_t>(now.tv_sec) * nanoseconds +
+                          static_cast<int64_t>(now.tv_nsec)};
+
+    return current - std::max(version.mtime, version.ctime) < recent_interval_;
+}
+
+//------------------------------------------------------------------------------
+bool IncludeCache::Find(const fs::path &path,
+                        const Version &version,
+                        YAML::Node &document,
+                        size_t &hash) const noexcept
+{
+    const scoped_lock lock{mutex_};
+
+    const auto entry{entries_.find(path.string())};
+    if (entry == entries_.end() || !(entry->second.version == version))
+    {
+        return false;
+    }
+
+    try
+    {
+        document = YAML::Clone(entry->second.document);
+    }
+    catch (const exception &exception)
+    {
+        Logging::Error("Ошибка при копировании конфигурационного файла {} из "
+                       "кэша: {}",
+                       path,
+                       exception.what());
+        return false;
+    }
+
+    hash = entry->second.hash;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void IncludeCache::Store(const fs::path &path,
+                         const Version &version,
+                         const YAML::Node &document,
+                         size_t hash) noexcept
+{
+    try
+    {
+        Entry entry{version, YAML::Clone(document), hash};
+
+        const scoped_lock lock{mutex_};
+        entries_[path.string()] = std::move(entry);
+    }
+    catch (const exception &exception)
+    {
+        Logging::Error("Ошибка при сохранении конфигурационного файла {} в "
+                       "кэш: {}",
+                       path,
+                       exception.what());
+    }
+}
+
+//------------------------------------------------------------------------------
+void IncludeCache::Clear() noexcept
+{
+    const scoped_lock lock{mutex_};
+    entries_.clear();
+}
+
+//------------------------------------------------------------------------------
+bool IncludeCache::Version::operator==(const Version &other) const noexcept
+{
+    return mtime == other.mtime && size == other.size &&
+           device == other.device && inode == other.inode &&
+           ctime == other.ctime;
+}
+
+}  // namespace tasp
@@ -0,0 +1,197 @@
+/**
+ * @file
+ * @brief Кэш разобранных включаемых конфигурационных файлов.
+ */
+#ifndef TASP_CONFIG_INCLUDE_CACHE_HPP_
+#define TASP_CONFIG_INCLUDE_CACHE_HPP_
+
+#include <yaml-cpp/yaml.h>
+
+#include <experimental/filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace fs = std::experimental::filesystem;
+
+namespace tasp
+{
+
+/**
+ * @brief Кэш разобранных включаемых конфигурационных файлов.
+ *
+ * Хранит разобранные документы файлов из параметра include вместе с версией
+ * файла (время изменения содержимого и метаданных, размер, устройство и
+ * inode). Пока версия файла не изменилась, документ выдается из кэша без
+ * чтения и разбора файла. Недавно измененные файлы в кэш не сохраняются, так
+ * как повторное изменение в пределах точности времени файловой системы не
+ * изменит версию.
+ *
+ * Документы в кэше не изменяются: при сохранении и выдаче создается копия,
+ * так как при слиянии узлы документа изменяются. Класс потокобезопасный.
+ */
+class IncludeCache final
+{
+public:
+    /**
+     * @brief Версия файла.
+     */
+    struct Version
+    {
+        /**
+         * @brief Время изменения в наносекундах.
+         */
+        std::int64_t mtime{0};
+
+        /**
+         * @brief Размер в байтах.
+         */
+        std::uint64_t size{0};
+
+        /**
+         * @brief Номер устройства.
+         */
+        std::uint64_t device{0};
+
+        /**
+         * @brief Номер inode.
+         */
+        std::uint64_t inode{0};
+
+        /**
+         * @brief Время изменения метаданных в наносекундах.
+         *
+         * В отличие от времени изменения не может быть установлено
+         * пользователем, поэтому обнаруживает замену содержимого с
+         * восстановлением времени изменения и размера.
+         */
+        std::int64_t ctime{0};
+
+        /**
+         * @brief Сравнение версий.
+         *
+         * @param other Версия
+         *
+         * @return Результат сравнения. true - версии совпадают
+         */
+        bool operator==(const Version &other) const noexcept;
+    };
+
+    /**
+     * @brief Запрос ссылки на кэш.
+     *
+     * @return Ссылка на кэш
+     */
+    static IncludeCache &Instance() noexcept;
+
+    /**
+     * @brief Запрос версии файла.
+     *
+     * @param path Путь к файлу
+     * @param version Версия файла
+     *
+     * @return Результат запроса. false - файл недоступен
+     */
+    static bool Stat(const fs::path &path, Version &version) noexcept;
+
+    /**
+     * @brief Проверка, что файл изменен недавно.
+     *
+     * @param version Версия файла
+     *
+     * @return Результат проверки. true - файл изменен менее
+     * @ref recent_interval_ назад и не должен сохраняться в кэш
+     */
+    static bool Recent(const Version &version) noexcept;
+
+    /**
+     * @brief Поиск документа в кэше.
+     *
+     * @param path Путь к файлу
+     * @param version Текущая версия файла
+     * @param document Копия документа
+     * @param hash Хэш содержимого файла
+     *
+     * @return Результат поиска. false - документа нет в кэше или версия
+     * файла изменилась
+     */
+    bool Find(const fs::path &path,
+              const Version &version,
+              YAML::Node &document,
+              std::size_t &hash) const noexcept;
+
+    /**
+     * @brief Сохранение документа в кэш.
+     *
+     * @param path Путь к файлу
+     * @param version Версия файла, из которой прочитан документ
+     * @param document Документ
+     * @param hash Хэш содержимого файла
+     */
+    void Store(const fs::path &path,
+               const Version &version,
+               const YAML::Node &document,
+               std::size_t hash) noexcept;
+
+    /**
+     * @brief Удаление всех документов из кэша.
+     */
+    void Clear() noexcept;
+
+    IncludeCache(const IncludeCache &) = delete;
+    IncludeCache(IncludeCache &&) = delete;
+    IncludeCache &operator=(const IncludeCache &) = delete;
+    IncludeCache &operator=(IncludeCache &&) = delete;
+
+private:
+    /**
+     * @brief Конструктор.
+     */
+    IncludeCache() noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~IncludeCache() noexcept;
+
+    /**
+     * @brief Элемент кэша.
+     */
+    struct Entry
+    {
+        /**
+         * @brief Версия файла.
+         */
+        Version version;
+
+        /**
+         * @brief Разобранный документ.
+         */
+        YAML::Node document;
+
+        /**
+         * @brief Хэш содержимого файла.
+         */
+        std::size_t hash{0};
+    };
+
+    /**
+     * @brief Интервал в наносекундах, в течение которого файл считается
+     * недавно измененным.
+     */
+    static constexpr std::int64_t recent_interval_{2'000'000'000};
+
+    /**
+     * @brief Элементы кэша по пути к файлу.
+     */
+    std::unordered_map<std::string, Entry> entries_;
+
+    /**
+     * @brief Мьютекс для синхронизации доступа к кэшу.
+     */
+    mutable std::mutex mutex_;
+};
+
+}  // namespace tasp
+
+#endif  // TASP_CONFIG_INCLUDE_CACHE_HPP_
@@ -1,9 +1,11 @@
 #include "daemon_impl.hpp"
 
-#include <execinfo.h>
+#include <unistd.h>
 
 #include <string>
 
+#include "signal_stack.hpp"
+
 #include "tasp/arguments.hpp"
 #include "tasp/config.hpp"
 #include "tasp/logging.hpp"
@@ -12,7 +14,7 @@ using std::array;
 using std::function;
 using std::make_unique;
 using std::string;
-using std::unique_ptr;
+using std::chrono::milliseconds;
 
 namespace tasp
 {
@@ -28,11 +30,6 @@ DaemonImpl::DaemonImpl(int argc, const char **argv) noexcept
         config_name = arguments.Get("--config");
     }
 
-    ConfigGlobal::Instance(config_name);
-    Logging::Instance();
-
-    pid_ = make_unique<PID>();
-
     sigemptyset(&sigset_);
 
     sigaddset(&sigset_, SIGINT);
@@ -42,12 +39,29 @@ DaemonImpl::DaemonImpl(int argc, const char **argv) noexcept
     sigaddset(&sigset_, SIGUSR1);
     sigaddset(&sigset_, SIGUSR2);
 
-    if (signal(SIGSEGV, DaemonImpl::SigsegvHandler) == SIG_ERR)
-    {
-        Logging::Error("Не удалось установить обработчик ошибок SIGSEGV");
-    }
-
+    // Сигналы блокируются до запуска потоков: потоки наследуют маску, и
+    // сигналы принимаются только в Exec.
     pthread_sigmask(SIG_BLOCK, &sigset_, nullptr);
+
+    // Логирование запускается после загрузки конфигурационного файла. Логи
+    // открываются в потоке обработки и не задерживают запуск демона.
+    ConfigGlobal::Instance(config_name);
+    Logging::Instance().Start();
+
+    pid_ = make_unique<PID>();
+
+    InstallCrashHandler();
+
+    ReloadWatch();
+
+    // Параметры логов зависят также от названия и пути программы.
+    auto &config{ConfigGlobal::Instance()};
+    logging_subscription_ = config.Subscribe({"logging", "program"},
+                                             []()
+                                             {
+                                                 Logging::Instance().Reload();
+                                             });
+    watch_subscription_ = config.Subscribe("config.watch", ReloadWatch);
 }
 
 //------------------------------------------------------------------------------
@@ -62,20 +76,34 @@ int DaemonImpl::Exec() const noexcept
     if (pid_->SecondLaunch())
     {
         Logging::Info("Повторный запуск запрещен");
+        Logging::Instance().Flush();
         return 1;
     }
 
-    int signo{0};
     while (true)
     {
-        sigwait(&sigset_, &signo);
+        siginfo_t info{};
+        const int signo{sigwaitinfo(&sigset_, &info)};
+        if (signo == -1)
+        {
+            continue;
+        }
 
         Logging::Info("Получен сигнал: {}", signo);
 
         if (signo == SIGUSR1 || signo == SIGUSR2)
         {
+            // Логирование и отслеживание изменений перезагружаются
+            // подписками, если изменились их параметры.
             ConfigGlobal::Instance().Reload();
-            Logging::Instance().Reload();
+
+            // Внешний сигнал также переоткрывает логи (например, после
+            // ротации файлов logrotate). Сигнал от отслеживания изменений
+            // конфигурационного файла отправляется самим процессом.
+            if (info.si_pid != getpid())
+            {
+                Logging::Instance().Reopen();
+            }
 
             if (reload_)
             {
@@ -88,6 +116,8 @@ int DaemonImpl::Exec() const noexcept
         }
     }
 
+    Logging::Instance().Flush();
+
     return 0;
 }
 
@@ -98,21 +128,62 @@ void DaemonImpl::Reload(const function<void()> &func) noexcept
 }
 
 //------------------------------------------------------------------------------
-void DaemonImpl::SigsegvHandler(int signum) noexcept
+void DaemonImpl::CrashHandler(int signum) noexcept
 {
-    Logging::Error("Программа упала! Код: {}", signum);
+    Logging::Instance().Emergency(signum);
 
-    array<void *, 50> trace_elems{};
-    const int size = backtrace(trace_elems.data(), 50);
+    // Обработчик сброшен на действие по умолчанию флагом SA_RESETHAND.
+    // Сигнал будет доставлен после выхода из обработчика.
+    raise(signum);
+}
 
-    const unique_ptr<char *, decltype(&std::free)> messages(
-        backtrace_symbols(trace_elems.data(), size), &std::free);
-    for (int i = 0; i < size; ++i)
+//------------------------------------------------------------------------------
+void DaemonImpl::InstallCrashHandler() noexcept
+{
+    // Потоки, создаваемые библиотекой, устанавливают свой стек
+    // (см. SignalStack).
+    static array<char, SignalStack::size_> alternate_stack{};
+
+    stack_t stack{};
+    stack.ss_sp = alternate_stack.data();
+    stack.ss_size = alternate_stack.size();
+    if (sigaltstack(&stack, nullptr) == -1)
     {
-        Logging::Error("[bt]: {}", messages.get()[i]);
+        Logging::Warning("Не удалось установить стек для обработчика сигналов");
     }
 
-    std::quick_exit(EXIT_FAILURE);
+    struct sigaction action
+    {
+    };
+    action.sa_handler = DaemonImpl::CrashHandler;
+    action.sa_flags = static_cast<int>(SA_ONSTACK | SA_RESETHAND);
+    sigemptyset(&action.sa_mask);
+
+    for (const int signum : crash_signals_)
+    {
+        if (sigaction(signum, &action, nullptr) == -1)
+        {
+            Logging::Error("Не удалось установить обработчик сигнала {}",
+                           signum);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void DaemonImpl::ReloadWatch() noexcept
+{
+    auto &config{ConfigGlobal::Instance()};
+    if (!config.Get<bool>("config.watch.enabled", false))
+    {
+        config.Watch(nullptr);
+        return;
+    }
+
+    const unsigned int default_debounce{500};
+    const milliseconds debounce{
+        config.Get<unsigned int>("config.watch.debounce", default_debounce)};
+
+    config.Watch([]() { kill(getpid(), SIGUSR1); }, debounce);
 }
 
 }  // namespace tasp
@@ -5,9 +5,11 @@
 #ifndef TASP_DAEMON_DAEMON_IMPL_HPP_
 #define TASP_DAEMON_DAEMON_IMPL_HPP_
 
+#include <array>
 #include <csignal>
 #include <functional>
 
+#include "tasp/config.hpp"
 #include "tasp/pid.hpp"
 
 namespace tasp
@@ -17,7 +19,13 @@ namespace tasp
  * @brief Реализация интерфейса для создания демона.
  *
  * Сигналы завершающие выполнение: SIGINT, SIGTERM, SIGQUIT, SIGKILL
- * Сигналы для обновление конфигурации: SIGUSR1, SIGUSR2
+ * Сигналы для обновление конфигурации: SIGUSR1, SIGUSR2. По внешнему сигналу
+ * логи переоткрываются; при перезагрузке по изменению файла логирование
+ * перезагружается, только если изменились параметры logging или program.
+ * Сигналы падения программы: SIGSEGV, SIGABRT, SIGBUS, SIGFPE
+ *
+ * При включенном параметре config.watch.enabled конфигурационный файл
+ * перезагружается также при изменении его содержимого.
  */
 class DaemonImpl final
 {
@@ -62,9 +70,41 @@ private:
      * @brief Обработка падения программы для записи в лог всей накопленной
      * информации.
      *
+     * Вывод выполняется через @ref Logging::Emergency без выделения памяти и
+     * захвата блокировок. После вывода сигнал отправляется повторно с
+     * обработчиком по умолчанию, чтобы программа завершилась с исходным кодом
+     * сигнала (и сохранением core dump, если он разрешен).
+     *
      * @param signum Номер сигнала
      */
-    static void SigsegvHandler(int signum) noexcept;
+    static void CrashHandler(int signum) noexcept;
+
+    /**
+     * @brief Установка обработчика сигналов падения программы.
+     *
+     * Обработчик выполняется на отдельном стеке, чтобы корректно обработать
+     * переполнение стека. Здесь стек устанавливается для главного потока,
+     * потоки библиотеки устанавливают свой стек при запуске (@ref
+     * SignalStack). Потоки, созданные программой напрямую, обрабатывают
+     * сигнал на собственном стеке, если не установили отдельный.
+     */
+    static void InstallCrashHandler() noexcept;
+
+    /**
+     * @brief Настройка отслеживания изменений конфигурационного файла.
+     *
+     * Параметры config.watch.enabled и config.watch.debounce читаются из
+     * глобального конфигурационного файла. При изменении содержимого файлов
+     * процессу отправляется сигнал SIGUSR1, и перезагрузка выполняется в
+     * @ref Exec так же, как по внешнему сигналу, но без переоткрытия логов.
+     */
+    static void ReloadWatch() noexcept;
+
+    /**
+     * @brief Сигналы падения программы.
+     */
+    static constexpr std::array<int, 4> crash_signals_{
+        {SIGSEGV, SIGABRT, SIGBUS, SIGFPE}};
 
     /**
      * @brief Список сигналов для перехвата.
@@ -80,6 +120,17 @@ private:
      * @brief Идентификатор процесса.
      */
     std::unique_ptr<PID> pid_{nullptr};
+
+    /**
+     * @brief Подписка на изменение параметров логирования и программы.
+     */
+    std::unique_ptr<ConfigSubscription> logging_subscription_{nullptr};
+
+    /**
+     * @brief Подписка на изменение параметров отслеживания конфигурационного
+     * файла.
+     */
+    std::unique_ptr<ConfigSubscription> watch_subscription_{nullptr};
 };
 
 }  // namespace tasp
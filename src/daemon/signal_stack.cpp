@@ -0,0 +1,44 @@
+#include "signal_stack.hpp"
+
+#include <csignal>
+
+namespace tasp
+{
+/*------------------------------------------------------------------------------
+    SignalStack
+------------------------------------------------------------------------------*/
+SignalStack::SignalStack() noexcept
+{
+    stack_t current{};
+    if (sigaltstack(nullptr, &current) == -1 ||
+        (current.ss_flags & SS_DISABLE) == 0)
+    {
+        return;
+    }
+
+    auto memory{std::make_unique<char[]>(size_)};
+
+    stack_t stack{};
+    stack.ss_sp = memory.get();
+    stack.ss_size = size_;
+    if (sigaltstack(&stack, nullptr) == 0)
+    {
+        stack_ = std::move(memory);
+    }
+}
+
+//------------------------------------------------------------------------------
+SignalStack::~SignalStack() noexcept
+{
+    if (stack_ == nullptr)
+    {
+        return;
+    }
+
+    // Память освобождается только после снятия стека.
+    stack_t stack{};
+    stack.ss_flags = SS_DISABLE;
+    sigaltstack(&stack, nullptr);
+}
+
+}  // namespace tasp
@@ -0,0 +1,56 @@
+/**
+ * @file
+ * @brief Отдельный стек обработчика сигналов для потоков библиотеки.
+ */
+#ifndef TASP_DAEMON_SIGNAL_STACK_HPP_
+#define TASP_DAEMON_SIGNAL_STACK_HPP_
+
+#include <cstddef>
+#include <memory>
+
+namespace tasp
+{
+
+/**
+ * @brief Установка отдельного стека обработчика сигналов для текущего потока.
+ *
+ * Стек, установленный функцией sigaltstack, действует только в потоке,
+ * который его установил, поэтому обработчик падения программы с флагом
+ * SA_ONSTACK выполняется на отдельном стеке только в главном потоке демона.
+ * Объект создается в начале функции каждого потока, создаваемого
+ * библиотекой, и снимает стек при завершении потока. Если у потока уже есть
+ * отдельный стек, он не заменяется.
+ */
+class SignalStack final
+{
+public:
+    /**
+     * @brief Конструктор. Устанавливает стек для текущего потока.
+     */
+    SignalStack() noexcept;
+
+    /**
+     * @brief Деструктор. Снимает установленный стек.
+     */
+    ~SignalStack() noexcept;
+
+    /**
+     * @brief Размер стека в байтах.
+     */
+    static constexpr std::size_t size_{64 * 1024};
+
+    SignalStack(const SignalStack &) = delete;
+    SignalStack(SignalStack &&) = delete;
+    SignalStack &operator=(const SignalStack &) = delete;
+    SignalStack &operator=(SignalStack &&) = delete;
+
+private:
+    /**
+     * @brief Память стека. nullptr - стек не установлен.
+     */
+    std::unique_ptr<char[]> stack_;
+};
+
+}  // namespace tasp
+
+#endif  // TASP_DAEMON_SIGNAL_STACK_HPP_
@@ -0,0 +1,337 @@
+#include "emergency_writer.hpp"
+
+#include <execinfo.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <charconv>
+#include <csignal>
+#include <ctime>
+
+using std::array;
+using std::deque;
+using std::pair;
+using std::size_t;
+using std::string_view;
+using std::to_chars;
+using std::time_t;
+using std::vector;
+
+namespace tasp
+{
+/*------------------------------------------------------------------------------
+    EmergencyWriter
+------------------------------------------------------------------------------*/
+EmergencyWriter::EmergencyWriter() noexcept
+{
+    for (auto &descriptor : descriptors_)
+    {
+        descriptor = -1;
+    }
+    for (auto &level : levels_)
+    {
+        level = LogLevel::Level::None;
+    }
+
+    array<void *, 1> trace{};
+    backtrace(trace.data(), static_cast<int>(trace.size()));
+}
+
+//------------------------------------------------------------------------------
+EmergencyWriter::~EmergencyWriter() noexcept = default;
+
+//------------------------------------------------------------------------------
+void EmergencyWriter::SetDescriptors(
+    const vector<pair<int, LogLevel::Level>> &descriptors) noexcept
+{
+    for (size_t i = 0; i < descriptors_.size(); ++i)
+    {
+        // Дескриптор выключается на время смены уровня.
+        descriptors_.at(i) = -1;
+        if (i < descriptors.size())
+        {
+            levels_.at(i) = descriptors[i].second;
+            descriptors_.at(i) = descriptors[i].first;
+        }
+    }
+
+    const time_t now{time(nullptr)};
+    tm local{};
+    if (localtime_r(&now, &local) != nullptr)
+    {
+        utc_offset_ = local.tm_gmtoff;
+    }
+}
+
+//------------------------------------------------------------------------------
+void EmergencyWriter::Crash(int signum) const noexcept
+{
+    timespec now{};
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    array<char, 32> time_buffer{};
+    const string_view timestamp{Timestamp(time_buffer, now.tv_sec)};
+
+    array<char, 16> signum_buffer{};
+    const auto [end, error]{to_chars(signum_buffer.begin(),
+                                     signum_buffer.end(),
+                                     signum)};
+    const string_view number{signum_buffer.data(),
+                             static_cast<size_t>(end - signum_buffer.data())};
+    const string_view name{SignalName(signum)};
+
+    array<void *, max_frames_> trace{};
+    const int size{backtrace(trace.data(), max_frames_)};
+
+    auto crash = [&](int fd)
+    {
+        Write(fd, timestamp);
+        Write(fd, " Error Программа упала! Сигнал: ");
+        Write(fd, number);
+        if (!name.empty())
+        {
+            Write(fd, " (");
+            Write(fd, name);
+            Write(fd, ")");
+        }
+        Write(fd, "\n");
+        backtrace_symbols_fd(trace.data(), size, fd);
+    };
+
+    crash(STDERR_FILENO);
+    for (const auto &descriptor : descriptors_)
+    {
+        const int fd{descriptor};
+        if (fd != -1)
+        {
+            crash(fd);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void EmergencyWriter::WriteLines(const deque<LogLine> &lines,
+                                 size_t rendered) const noexcept
+{
+    for (size_t i = 0; i < descriptors_.size(); ++i)
+    {
+        const int fd{descriptors_.at(i)};
+        if (fd == -1)
+        {
+            continue;
+        }
+
+        const LogLevel::Level level{levels_.at(i)};
+        for (size_t index = 0; index < lines.size(); ++index)
+        {
+            const auto &line{lines[index]};
+            if (line.Level().Get() < level)
+            {
+                continue;
+            }
+
+            if (index < rendered)
+            {
+                WriteLine(fd, line);
+            }
+            else
+            {
+                WriteUnrendered(fd, line);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void EmergencyWriter::WriteLine(int fd, const LogLine &line) noexcept
+{
+    WriteFields(fd,
+                line.Timestamp(),
+                line.Source(),
+                line.Line(),
+                line.ThreadId(),
+                line.Level().Name(),
+                line.Message());
+}
+
+//------------------------------------------------------------------------------
+void EmergencyWriter::WriteUnrendered(int fd, const LogLine &line) noexcept
+{
+    const string_view format{line.Format()};
+
+    WriteFields(fd,
+                line.Timestamp(),
+                line.Source(),
+                line.Line(),
+                line.ThreadId(),
+                line.Level().Name(),
+                format.empty() ? string_view{line.Message()} : format);
+}
+
+//------------------------------------------------------------------------------
+void EmergencyWriter::WriteRecord(int fd,
+                                  LogLevel::Level level,
+                                  time_t time,
+                                  string_view source,
+                                  unsigned int line,
+                                  unsigned long thread,
+                                  string_view message) const noexcept
+{
+    array<char, 32> time_buffer{};
+    const string_view timestamp{Timestamp(time_buffer, time)};
+
+    // Идентификатор потока выводится так же, как в LogLine.
+    array<char, 32> thread_buffer{{'[', '0', 'x'}};
+    char *end{to_chars(thread_buffer.begin() + 3,
+                       thread_buffer.end() - 1,
+                       thread)
+                  .ptr};
+    *end++ = ']';
+
+    WriteFields(
+        fd,
+        timestamp,
+        source,
+        line,
+        string_view{thread_buffer.data(),
+                    static_cast<size_t>(end - thread_buffer.data())},
+        LogLevel(level).Name(),
+        message);
+}
+
+//------------------------------------------------------------------------------
+void EmergencyWriter::WriteFields(int fd,
+                                  string_view timestamp,
+                                  string_view source,
+                                  unsigned int line,
+                                  string_view thread_id,
+                                  string_view level,
+                                  string_view message) noexcept
+{
+    const size_t source_width{24};
+    const size_t line_width{4};
+    const size_t level_width{7};
+
+    array<char, 16> buffer{};
+    const auto [end, error]{to_chars(buffer.begin(), buffer.end(), line)};
+
+    Write(fd, timestamp);
+    Write(fd, " ");
+    WriteAligned(fd, source, source_width);
+    WriteAligned(
+        fd,
+        string_view{buffer.data(), static_cast<size_t>(end - buffer.data())},
+        line_width);
+    Write(fd, " ");
+    Write(fd, thread_id);
+    Write(fd, " ");
+    WriteAligned(fd, level, level_width);
+    Write(fd, " ");
+    Write(fd, message);
+    Write(fd, "\n");
+}
+
+//------------------------------------------------------------------------------
+void EmergencyWriter::Write(int fd, string_view data) noexcept
+{
+    while (!data.empty())
+    {
+        const ssize_t written{write(fd, data.data(), data.size())};
+        if (written == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return;
+        }
+
+        data.remove_prefix(static_cast<size_t>(written));
+    }
+}
+
+//------------------------------------------------------------------------------
+void EmergencyWriter::WriteAligned(int fd,
+                                   string_view data,
+                                   size_t width) noexcept
+{
+    const string_view spaces{"                        "};
+    if (data.size() < width)
+    {
+        Write(fd, spaces.substr(0, width - data.size()));
+    }
+    Write(fd, data);
+}
+
+//------------------------------------------------------------------------------
+string_view EmergencyWriter::Timestamp(array<char, 32> &buffer,
+                                       time_t time) const noexcept
+{
+    const long seconds_per_day{86400};
+    const long local{time + utc_offset_};
+    long days{local / seconds_per_day};
+    long seconds{local % seconds_per_day};
+    if (seconds < 0)
+    {
+        seconds += seconds_per_day;
+        --days;
+    }
+
+    // Преобразование количества дней от 1970-01-01 в дату григорианского
+    // календаря без использования localtime (не async-signal-safe).
+    days += 719468;
+    const long era{(days >= 0 ? days : days - 146096) / 146097};
+    const long day_of_era{days - era * 146097};
+    const long year_of_era{(day_of_era - day_of_era / 1460 +
+                            day_of_era / 36524 - day_of_era / 146096) /
+                           365};
+    const long day_of_year{day_of_era -
+                           (365 * year_of_era + year_of_era / 4 -
+                            year_of_era / 100)};
+    const long month_index{(5 * day_of_year + 2) / 153};
+    const long day{day_of_year - (153 * month_index + 2) / 5 + 1};
+    const long month{month_index < 10 ? month_index + 3 : month_index - 9};
+    const long year{year_of_era + era * 400 + (month <= 2 ? 1 : 0)};
+
+    const array<long, 6> fields{
+        {year, month, day, seconds / 3600, seconds / 60 % 60, seconds % 60}};
+    const array<char, 6> separators{{'-', '-', ' ', ':', ':', '\0'}};
+
+    char *position{buffer.data()};
+    for (size_t i = 0; i < fields.size(); ++i)
+    {
+        if (fields.at(i) < 10)
+        {
+            *position++ = '0';
+        }
+        position = to_chars(position, buffer.end(), fields.at(i)).ptr;
+        if (separators.at(i) != '\0')
+        {
+            *position++ = separators.at(i);
+        }
+    }
+
+    return {buffer.data(), static_cast<size_t>(position - buffer.data())};
+}
+
+//------------------------------------------------------------------------------
+string_view EmergencyWriter::SignalName(int signum) noexcept
+{
+    switch (signum)
+    {
+        case SIGSEGV:
+            return "SIGSEGV";
+        case SIGABRT:
+            return "SIGABRT";
+        case SIGBUS:
+            return "SIGBUS";
+        case SIGFPE:
+            return "SIGFPE";
+        case SIGILL:
+            return "SIGILL";
+        default:
+            return {};
+    }
+}
+
+}  // namespace tasp
@@ -0,0 +1,219 @@
+/**
+ * @file
+ * @brief Аварийный вывод сообщений при падении программы.
+ */
+#ifndef TASP_LOGGING_EMERGENCY_WRITER_HPP_
+#define TASP_LOGGING_EMERGENCY_WRITER_HPP_
+
+#include <array>
+#include <atomic>
+#include <ctime>
+#include <deque>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "log_line.hpp"
+
+namespace tasp
+{
+
+/**
+ * @brief Класс аварийного вывода сообщений из обработчика сигнала.
+ *
+ * Все функции вывода используют только async-signal-safe функции: данные
+ * пишутся через write(2) в заранее открытые файловые дескрипторы, память не
+ * выделяется, блокировки не захватываются. Стандартный вывод ошибок
+ * используется всегда, дополнительные дескрипторы передаются при
+ * перезагрузке логирования.
+ */
+class EmergencyWriter final
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * Выполняет пробный вызов backtrace, чтобы библиотека раскрутки стека
+     * была загружена заранее, а не из обработчика сигнала.
+     */
+    EmergencyWriter() noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~EmergencyWriter() noexcept;
+
+    /**
+     * @brief Установка дополнительных дескрипторов для аварийного вывода.
+     *
+     * Дескрипторы сверх @ref max_descriptors_ игнорируются. Также
+     * запоминается смещение местного времени от UTC для вывода даты.
+     *
+     * @param descriptors Список дескрипторов и минимальных уровней выводимых
+     * в них сообщений
+     */
+    void SetDescriptors(
+        const std::vector<std::pair<int, LogLevel::Level>> &descriptors) noexcept;
+
+    /**
+     * @brief Вывод сообщений во все дополнительные дескрипторы с учетом
+     * уровня каждого дескриптора.
+     *
+     * Сообщения, начиная с rendered, могут формироваться другим потоком во
+     * время вывода: для них, пока сообщение не сформировано, выводится его
+     * формат без подстановки параметров.
+     *
+     * @param lines Сообщения для вывода
+     * @param rendered Количество сформированных сообщений в начале списка
+     */
+    void WriteLines(const std::deque<LogLine> &lines,
+                    std::size_t rendered) const noexcept;
+
+    /**
+     * @brief Вывод сообщения о падении программы и стека вызовов во все
+     * дескрипторы.
+     *
+     * @param signum Номер сигнала
+     */
+    void Crash(int signum) const noexcept;
+
+    /**
+     * @brief Вывод сообщения в дескриптор в текстовом формате лога.
+     *
+     * Поля сообщения, сформированные заранее, выводятся по частям.
+     *
+     * @param fd Файловый дескриптор
+     * @param line Данные для вывода
+     */
+    static void WriteLine(int fd, const LogLine &line) noexcept;
+
+    /**
+     * @brief Вывод сообщения, которое может формироваться во время вывода.
+     *
+     * Выводится формат сообщения, пока оно не сформировано: формат
+     * очищается только после формирования сообщения и память при этом не
+     * освобождается.
+     *
+     * @param fd Файловый дескриптор
+     * @param line Данные для вывода
+     */
+    static void WriteUnrendered(int fd, const LogLine &line) noexcept;
+
+    /**
+     * @brief Вывод сообщения, переданного по полям, в дескриптор в текстовом
+     * формате лога.
+     *
+     * Используется для сообщений, для которых не создан объект @ref LogLine.
+     *
+     * @param fd Файловый дескриптор
+     * @param level Уровень сообщения
+     * @param time Момент вызова функции логирования
+     * @param source Название файла
+     * @param line Номер строки
+     * @param thread Идентификатор потока
+     * @param message Сообщение
+     */
+    void WriteRecord(int fd,
+                     LogLevel::Level level,
+                     std::time_t time,
+                     std::string_view source,
+                     unsigned int line,
+                     unsigned long thread,
+                     std::string_view message) const noexcept;
+
+    /**
+     * @brief Максимальное количество дополнительных дескрипторов.
+     */
+    static constexpr std::size_t max_descriptors_{8};
+
+    EmergencyWriter(const EmergencyWriter &) = delete;
+    EmergencyWriter(EmergencyWriter &&) = delete;
+    EmergencyWriter &operator=(const EmergencyWriter &) = delete;
+    EmergencyWriter &operator=(EmergencyWriter &&) = delete;
+
+private:
+    /**
+     * @brief Вывод данных в дескриптор полностью.
+     *
+     * @param fd Файловый дескриптор
+     * @param data Данные для вывода
+     */
+    static void Write(int fd, std::string_view data) noexcept;
+
+    /**
+     * @brief Вывод данных с выравниванием по правому краю.
+     *
+     * @param fd Файловый дескриптор
+     * @param data Данные для вывода
+     * @param width Ширина поля
+     */
+    static void WriteAligned(int fd,
+                             std::string_view data,
+                             std::size_t width) noexcept;
+
+    /**
+     * @brief Формирование даты и времени без вызова небезопасных для
+     * обработчика сигнала функций.
+     *
+     * @param buffer Буфер для результата
+     * @param time Момент времени
+     *
+     * @return Дата и время в формате ГГГГ-ММ-ДД ЧЧ:ММ:СС
+     */
+    std::string_view Timestamp(std::array<char, 32> &buffer,
+                               std::time_t time) const noexcept;
+
+    /**
+     * @brief Вывод сформированных полей сообщения в дескриптор в текстовом
+     * формате лога.
+     *
+     * @param fd Файловый дескриптор
+     * @param timestamp Дата и время
+     * @param source Название файла
+     * @param line Номер строки
+     * @param thread_id Идентификатор потока в формате [0xНОМЕР_ПОТОКА]
+     * @param level Уровень сообщения
+     * @param message Сообщение
+     */
+    static void WriteFields(int fd,
+                            std::string_view timestamp,
+                            std::string_view source,
+                            unsigned int line,
+                            std::string_view thread_id,
+                            std::string_view level,
+                            std::string_view message) noexcept;
+
+    /**
+     * @brief Запрос названия сигнала.
+     *
+     * @param signum Номер сигнала
+     *
+     * @return Название сигнала или пустая строка для неизвестного сигнала
+     */
+    static std::string_view SignalName(int signum) noexcept;
+
+    /**
+     * @brief Дополнительные дескрипторы для аварийного вывода. -1 - не
+     * используется.
+     */
+    std::array<std::atomic<int>, max_descriptors_> descriptors_;
+
+    /**
+     * @brief Минимальные уровни сообщений для дополнительных дескрипторов.
+     */
+    std::array<std::atomic<LogLevel::Level>, max_descriptors_> levels_;
+
+    /**
+     * @brief Смещение местного времени от UTC в секундах.
+     */
+    std::atomic<long> utc_offset_{0};
+
+    /**
+     * @brief Максимальное количество выводимых кадров стека вызовов.
+     */
+    static constexpr int max_frames_{64};
+};
+
+}  // namespace tasp
+
+#endif  // TASP_LOGGING_EMERGENCY_WRITER_HPP_
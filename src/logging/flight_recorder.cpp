@@ -0,0 +1,243 @@
+#include "flight_recorder.hpp"
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <cstring>
+
+using std::any;
+using std::function;
+using std::memory_order_acquire;
+using std::memory_order_relaxed;
+using std::memory_order_release;
+using std::size_t;
+using std::string;
+using std::string_view;
+using std::uint64_t;
+using std::vector;
+using std::chrono::system_clock;
+
+namespace tasp
+{
+/*------------------------------------------------------------------------------
+    FlightRecorder
+------------------------------------------------------------------------------*/
+FlightRecorder::FlightRecorder() noexcept = default;
+
+//------------------------------------------------------------------------------
+FlightRecorder::~FlightRecorder() noexcept = default;
+
+//------------------------------------------------------------------------------
+void FlightRecorder::Resize(size_t size) noexcept
+{
+    const Buffer *current{buffer_.load(memory_order_acquire)};
+    if ((current == nullptr && size == 0) ||
+        (current != nullptr && current->size == size))
+    {
+        return;
+    }
+
+    Buffer *buffer{nullptr};
+    if (size != 0)
+    {
+        buffers_.push_back(std::make_unique<Buffer>(size));
+        buffer = buffers_.back().get();
+    }
+
+    // Записи, сохраненные в предыдущий буфер, больше не выгружаются.
+    read_ = next_.load();
+    buffer_.store(buffer, memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+void FlightRecorder::Record(LogLevel::Level level,
+                            const SourceLocation &location,
+                            string_view format,
+                            const vector<any> &params,
+                            uint64_t position) noexcept
+{
+    Buffer *buffer{buffer_.load(memory_order_acquire)};
+    if (buffer == nullptr)
+    {
+        return;
+    }
+
+    // Сообщение формируется до занятия ячейки, чтобы ячейка была занята
+    // только на время копирования.
+    const string message{LogLine::CreateMessage(format, params)};
+    const auto time{system_clock::now()};
+
+    const uint64_t ticket{next_.fetch_add(1, memory_order_relaxed)};
+    auto &slot{buffer->slots[ticket % buffer->size]};
+
+    uint64_t version{slot.version.load(memory_order_relaxed)};
+    if ((version & 1U) != 0 ||
+        !slot.version.compare_exchange_strong(
+            version, version + 1, memory_order_acquire, memory_order_relaxed))
+    {
+        return;
+    }
+    std::atomic_thread_fence(memory_order_release);
+
+    // Сообщение обрезается по границе символа UTF-8.
+    size_t size{std::min(message.size(), message_size_)};
+    if (size < message.size())
+    {
+        while (size > 0 && (static_cast<unsigned char>(message[size]) &
+                            0xC0U) == 0x80U)
+        {
+            --size;
+        }
+    }
+
+    slot.ticket = ticket;
+    slot.level = level;
+    slot.file = location.file_name();
+    slot.line = location.line();
+    slot.time = time;
+    slot.thread = pthread_self();
+    slot.position = position;
+    slot.size = size;
+    std::memcpy(slot.message.data(), message.data(), size);
+
+    slot.version.store(version + 2, memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+size_t FlightRecorder::Dump(const function<void(const LogLine &)> &func,
+                            uint64_t limit) noexcept
+{
+    const Buffer *buffer{buffer_.load(memory_order_acquire)};
+    if (buffer == nullptr)
+    {
+        return 0;
+    }
+
+    const uint64_t next{next_.load(memory_order_acquire)};
+    uint64_t ticket{read_};
+    if (next - ticket > buffer->size)
+    {
+        ticket = next - buffer->size;
+    }
+
+    size_t count{0};
+    Slot slot{};
+    for (; ticket < next; ++ticket)
+    {
+        const Read result{Load(*buffer, ticket, slot)};
+        if (result == Read::Skipped)
+        {
+            continue;
+        }
+        if (result == Read::Pending || slot.position >= limit)
+        {
+            break;
+        }
+
+        func(LogLine(slot.level,
+                     Date{slot.time}.ToString(),
+                     FileName(slot.file),
+                     slot.line,
+                     "[0x" + std::to_string(slot.thread) + "]",
+                     string_view{slot.message.data(), slot.size}));
+        ++count;
+    }
+    read_ = ticket;
+
+    return count;
+}
+
+//------------------------------------------------------------------------------
+void FlightRecorder::Emergency(int fd,
+                               const EmergencyWriter &writer) const noexcept
+{
+    const Buffer *buffer{buffer_.load(memory_order_acquire)};
+    if (buffer == nullptr || fd == -1)
+    {
+        return;
+    }
+
+    const uint64_t next{next_.load(memory_order_acquire)};
+    uint64_t ticket{read_};
+    if (next - ticket > buffer->size)
+    {
+        ticket = next - buffer->size;
+    }
+
+    Slot slot{};
+    for (; ticket < next; ++ticket)
+    {
+        if (Load(*buffer, ticket, slot) != Read::Ok)
+        {
+            continue;
+        }
+
+        writer.WriteRecord(fd,
+                           slot.level,
+                           system_clock::to_time_t(slot.time),
+                           FileName(slot.file),
+                           slot.line,
+                           slot.thread,
+                           string_view{slot.message.data(), slot.size});
+    }
+}
+
+//------------------------------------------------------------------------------
+FlightRecorder::Read FlightRecorder::Load(const Buffer &buffer,
+                                          uint64_t ticket,
+                                          Slot &slot) noexcept
+{
+    const auto &source{buffer.slots[ticket % buffer.size]};
+
+    const uint64_t version{source.version.load(memory_order_acquire)};
+    if (version == 0 || (version & 1U) != 0)
+    {
+        return Read::Pending;
+    }
+
+    slot.ticket = source.ticket;
+    slot.level = source.level;
+    slot.file = source.file;
+    slot.line = source.line;
+    slot.time = source.time;
+    slot.thread = source.thread;
+    slot.position = source.position;
+    slot.size = std::min(source.size, message_size_);
+    std::memcpy(slot.message.data(), source.message.data(), slot.size);
+
+    // Если ячейка изменилась во время копирования, копия не используется.
+    std::atomic_thread_fence(memory_order_acquire);
+    if (source.version.load(memory_order_relaxed) != version)
+    {
+        return Read::Pending;
+    }
+
+    if (slot.ticket > ticket)
+    {
+        return Read::Skipped;
+    }
+
+    // Запись ticket еще не сохранена. Если ячейку держал поток, отставший на
+    // круг буфера, запись была отброшена и будет пропущена после следующей
+    // перезаписи ячейки.
+    return slot.ticket == ticket ? Read::Ok : Read::Pending;
+}
+
+//------------------------------------------------------------------------------
+string_view FlightRecorder::FileName(string_view path) noexcept
+{
+    const auto pos{path.find_last_of('/')};
+
+    return pos != string_view::npos ? path.substr(pos + 1) : path;
+}
+
+/*------------------------------------------------------------------------------
+    FlightRecorder::Buffer
+------------------------------------------------------------------------------*/
+FlightRecorder::Buffer::Buffer(size_t count) noexcept
+: size(count)
+, slots(std::make_unique<Slot[]>(count))
+{
+}
+
+}  // namespace tasp
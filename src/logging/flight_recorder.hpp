@@ -0,0 +1,254 @@
+/**
+ * @file
+ * @brief Классы для хранения последних отладочных сообщений в памяти.
+ */
+#ifndef TASP_LOGGING_FLIGHT_RECORDER_HPP_
+#define TASP_LOGGING_FLIGHT_RECORDER_HPP_
+
+#include <array>
+#include <atomic>
+#include <memory>
+
+#include "emergency_writer.hpp"
+#include "log_line.hpp"
+
+namespace tasp
+{
+
+/**
+ * @brief Кольцевой буфер последних сообщений (бортовой самописец).
+ *
+ * Сообщения формируются при сохранении и хранятся в ячейках фиксированного
+ * размера: длинные сообщения обрезаются до @ref message_size_ байт. Сохранение
+ * не захватывает блокировок: ячейка занимается атомарным увеличением номера
+ * записи, а целостность ее данных при чтении проверяется по счетчику версии
+ * ячейки (seqlock). Если ячейка еще заполняется потоком, отставшим на целый
+ * круг буфера, сообщение отбрасывается.
+ *
+ * Буфер выгружается потоком обработки логов (@ref Dump) или из обработчика
+ * сигнала при падении программы (@ref Emergency).
+ */
+class FlightRecorder final
+{
+public:
+    /**
+     * @brief Конструктор.
+     */
+    FlightRecorder() noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~FlightRecorder() noexcept;
+
+    /**
+     * @brief Изменение размера буфера.
+     *
+     * При изменении размера все сохраненные сообщения удаляются. При нулевом
+     * размере сохранение сообщений выключается. Память предыдущих буферов
+     * освобождается только в деструкторе, т.к. в них еще могут писать другие
+     * потоки.
+     *
+     * @param size Максимальное количество сообщений в буфере
+     */
+    void Resize(std::size_t size) noexcept;
+
+    /**
+     * @brief Сохранение сообщения в буфер.
+     *
+     * При заполнении буфера перезаписывается самое старое сообщение.
+     *
+     * @param level Уровень сообщения
+     * @param location Информация о месте вызова функции логирования
+     * @param format Формат сообщения для вывода с местами для вставки
+     * параметров
+     * @param params Параметры для добавления в формат
+     * @param position Количество сообщений в очереди логирования на момент
+     * сохранения
+     */
+    void Record(LogLevel::Level level,
+                const SourceLocation &location,
+                std::string_view format,
+                const std::vector<std::any> &params,
+                std::uint64_t position) noexcept;
+
+    /**
+     * @brief Выгрузка сохраненных сообщений.
+     *
+     * Сообщения передаются в функцию в порядке сохранения. Выгружаются только
+     * сообщения, сохраненные до добавления в очередь сообщения с порядковым
+     * номером limit. Выгруженные сообщения удаляются из буфера. Выгрузка
+     * останавливается на ячейке, которая еще заполняется, и продолжается при
+     * следующем вызове.
+     *
+     * Функция и @ref Resize вызываются только из одного потока.
+     *
+     * @param func Функция обработки сообщения
+     * @param limit Порядковый номер сообщения в очереди логирования
+     *
+     * @return Количество выгруженных сообщений
+     */
+    std::size_t Dump(const std::function<void(const LogLine &)> &func,
+                     std::uint64_t limit) noexcept;
+
+    /**
+     * @brief Аварийный вывод невыгруженных сообщений из обработчика сигнала.
+     *
+     * Используются только async-signal-safe функции. Ячейки, которые
+     * заполнялись в момент падения, пропускаются.
+     *
+     * @param fd Файловый дескриптор для вывода
+     * @param writer Объект аварийного вывода
+     */
+    void Emergency(int fd, const EmergencyWriter &writer) const noexcept;
+
+    /**
+     * @brief Максимальный размер сохраняемого сообщения в байтах.
+     */
+    static constexpr std::size_t message_size_{256};
+
+    FlightRecorder(const FlightRecorder &) = delete;
+    FlightRecorder(FlightRecorder &&) = delete;
+    FlightRecorder &operator=(const FlightRecorder &) = delete;
+    FlightRecorder &operator=(FlightRecorder &&) = delete;
+
+private:
+    /**
+     * @brief Ячейка буфера с сформированным сообщением.
+     */
+    struct Slot
+    {
+        /**
+         * @brief Версия данных ячейки. Нечетное значение - ячейка
+         * заполняется, 0 - ячейка ни разу не заполнялась.
+         */
+        std::atomic<std::uint64_t> version{0};
+
+        /**
+         * @brief Номер записи, сохраненной в ячейке.
+         */
+        std::uint64_t ticket{0};
+
+        /**
+         * @brief Уровень сообщения.
+         */
+        LogLevel::Level level{LogLevel::Level::None};
+
+        /**
+         * @brief Путь к исходному файлу (строковая константа).
+         */
+        const char *file{""};
+
+        /**
+         * @brief Номер строки.
+         */
+        unsigned int line{0};
+
+        /**
+         * @brief Момент вызова функции логирования.
+         */
+        Timepoint time{};
+
+        /**
+         * @brief Идентификатор потока, вызвавшего функцию логирования.
+         */
+        unsigned long thread{0};
+
+        /**
+         * @brief Количество сообщений в очереди логирования на момент
+         * сохранения.
+         */
+        std::uint64_t position{0};
+
+        /**
+         * @brief Длина сообщения в байтах.
+         */
+        std::size_t size{0};
+
+        /**
+         * @brief Сообщение.
+         */
+        std::array<char, message_size_> message{};
+    };
+
+    /**
+     * @brief Буфер ячеек.
+     */
+    struct Buffer
+    {
+        /**
+         * @brief Конструктор.
+         *
+         * @param count Количество ячеек
+         */
+        explicit Buffer(std::size_t count) noexcept;
+
+        /**
+         * @brief Количество ячеек.
+         */
+        std::size_t size;
+
+        /**
+         * @brief Ячейки.
+         */
+        std::unique_ptr<Slot[]> slots;
+    };
+
+    /**
+     * @brief Результат чтения ячейки.
+     */
+    enum class Read : std::uint8_t
+    {
+        Ok = 0, /*!< Ячейка содержит запрошенную запись */
+        Skipped = 1, /*!< Запись перезаписана более новой */
+        Pending = 2 /*!< Запись еще не сохранена или заполняется */
+    };
+
+    /**
+     * @brief Чтение копии ячейки с проверкой целостности.
+     *
+     * Используются только async-signal-safe функции.
+     *
+     * @param buffer Буфер ячеек
+     * @param ticket Номер записи
+     * @param slot Копия ячейки (поле version не заполняется)
+     *
+     * @return Результат чтения
+     */
+    static Read Load(const Buffer &buffer,
+                     std::uint64_t ticket,
+                     Slot &slot) noexcept;
+
+    /**
+     * @brief Вырезание пути из пути к исходному файлу.
+     *
+     * @param path Путь к исходному файлу
+     *
+     * @return Имя файла
+     */
+    static std::string_view FileName(std::string_view path) noexcept;
+
+    /**
+     * @brief Текущий буфер. nullptr - сохранение выключено.
+     */
+    std::atomic<Buffer *> buffer_{nullptr};
+
+    /**
+     * @brief Все выделенные буферы.
+     */
+    std::vector<std::unique_ptr<Buffer>> buffers_;
+
+    /**
+     * @brief Номер следующей записи.
+     */
+    std::atomic<std::uint64_t> next_{0};
+
+    /**
+     * @brief Номер первой невыгруженной записи.
+     */
+    std::atomic<std::uint64_t> read_{0};
+};
+
+}  // namespace tasp
+
+#endif  // TASP_LOGGING_FLIGHT_RECORDER_HPP_
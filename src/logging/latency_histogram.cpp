@@ -0,0 +1,147 @@
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+
+using std::array;
+using std::memory_order_relaxed;
+using std::size_t;
+using std::uint64_t;
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::nanoseconds;
+
+namespace tasp
+{
+/*------------------------------------------------------------------------------
+    LatencyHistogram
+------------------------------------------------------------------------------*/
+LatencyHistogram::LatencyHistogram() noexcept = default;
+
+//------------------------------------------------------------------------------
+LatencyHistogram::~LatencyHistogram() noexcept = default;
+
+//------------------------------------------------------------------------------
+void LatencyHistogram::Record(nanoseconds latency) noexcept
+{
+    const auto micros{
+        static_cast<uint64_t>(duration_cast<microseconds>(latency).count())};
+
+    // Номер интервала - количество значащих бит во времени в микросекундах.
+    size_t bucket{0};
+    for (uint64_t value{micros}; value != 0 && bucket + 1 < bucket_count_;
+         value >>= 1U)
+    {
+        ++bucket;
+    }
+
+    // Запись выполняется одним потоком, поэтому достаточно раздельных
+    // чтения и записи без атомарного сложения.
+    buckets_.at(bucket).store(buckets_.at(bucket).load(memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+    count_.store(count_.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    latency_.store(latency_.load(memory_order_relaxed) + latency,
+                   memory_order_relaxed);
+    if (latency > max_latency_.load(memory_order_relaxed))
+    {
+        max_latency_.store(latency, memory_order_relaxed);
+    }
+}
+
+//------------------------------------------------------------------------------
+uint64_t LatencyHistogram::Count() const noexcept
+{
+    return count_.load(memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+Json::Value LatencyHistogram::ToJSON() const noexcept
+{
+    array<uint64_t, bucket_count_> buckets{};
+    uint64_t count{0};
+    for (size_t i = 0; i < bucket_count_; ++i)
+    {
+        buckets.at(i) = buckets_.at(i).load(memory_order_relaxed);
+        count += buckets.at(i);
+    }
+
+    const auto to_micros = [](nanoseconds value)
+    {
+        return static_cast<uint64_t>(
+            duration_cast<microseconds>(value).count());
+    };
+
+    Json::Value histogram{};
+    histogram["count"] = Json::UInt64{count};
+    histogram["latency_avg_us"] = Json::UInt64{
+        count != 0 ? to_micros(latency_.load(memory_order_relaxed)) / count
+                   : 0};
+    const uint64_t max{to_micros(max_latency_.load(memory_order_relaxed))};
+    histogram["latency_max_us"] = Json::UInt64{max};
+
+    const uint64_t median{50};
+    const uint64_t tail{99};
+    histogram["latency_p50_us"] =
+        Json::UInt64{Percentile(buckets, count, median, max)};
+    histogram["latency_p99_us"] =
+        Json::UInt64{Percentile(buckets, count, tail, max)};
+
+    histogram["buckets"] = Json::arrayValue;
+    for (size_t i = 0; i < bucket_count_; ++i)
+    {
+        if (buckets.at(i) == 0)
+        {
+            continue;
+        }
+
+        Json::Value bucket{};
+        if (i + 1 < bucket_count_)
+        {
+            bucket["le_us"] = Json::UInt64{UpperBound(i)};
+        }
+        else
+        {
+            bucket["le_us"] = "inf";
+        }
+        bucket["count"] = Json::UInt64{buckets.at(i)};
+        histogram["buckets"].append(bucket);
+    }
+
+    return histogram;
+}
+
+//------------------------------------------------------------------------------
+uint64_t LatencyHistogram::UpperBound(size_t bucket) noexcept
+{
+    return uint64_t{1} << bucket;
+}
+
+//------------------------------------------------------------------------------
+uint64_t LatencyHistogram::Percentile(
+    const array<uint64_t, bucket_count_> &buckets,
+    uint64_t count,
+    uint64_t percent,
+    uint64_t max) noexcept
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    const uint64_t hundred{100};
+    const uint64_t rank{std::max(uint64_t{1},
+                                 (count * percent + hundred - 1) / hundred)};
+
+    uint64_t accumulated{0};
+    for (size_t i = 0; i < bucket_count_; ++i)
+    {
+        accumulated += buckets.at(i);
+        if (accumulated >= rank)
+        {
+            return i + 1 < bucket_count_ ? std::min(UpperBound(i), max) : max;
+        }
+    }
+
+    return max;
+}
+
+}  // namespace tasp
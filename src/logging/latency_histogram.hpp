@@ -0,0 +1,126 @@
+/**
+ * @file
+ * @brief Гистограмма времени выполнения операций.
+ */
+#ifndef TASP_LOGGING_LATENCY_HISTOGRAM_HPP_
+#define TASP_LOGGING_LATENCY_HISTOGRAM_HPP_
+
+#include <jsoncpp/json/json.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+
+namespace tasp
+{
+
+/**
+ * @brief Гистограмма времени выполнения операций.
+ *
+ * Интервалы гистограммы растут степенями двойки: в интервал с номером i
+ * попадают операции длительностью от 2^(i-1) до 2^i мкс, в нулевой - менее
+ * 1 мкс, в последний - все более длительные.
+ *
+ * Запись выполняется одним потоком, чтение (@ref ToJSON) - из любого потока
+ * без блокировок.
+ */
+class LatencyHistogram final
+{
+public:
+    /**
+     * @brief Конструктор.
+     */
+    LatencyHistogram() noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~LatencyHistogram() noexcept;
+
+    /**
+     * @brief Учет операции.
+     *
+     * @param latency Время выполнения операции
+     */
+    void Record(std::chrono::nanoseconds latency) noexcept;
+
+    /**
+     * @brief Запрос количества учтенных операций.
+     *
+     * @return Количество операций
+     */
+    [[nodiscard]] std::uint64_t Count() const noexcept;
+
+    /**
+     * @brief Преобразование гистограммы в формат Json::Value.
+     *
+     * Выводится количество операций, среднее и максимальное время, оценки
+     * 50-го и 99-го процентилей (верхние границы интервалов) и ненулевые
+     * интервалы гистограммы. Время выводится в микросекундах.
+     *
+     * @return Гистограмма
+     */
+    [[nodiscard]] Json::Value ToJSON() const noexcept;
+
+    LatencyHistogram(const LatencyHistogram &) = delete;
+    LatencyHistogram(LatencyHistogram &&) = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+    LatencyHistogram &operator=(LatencyHistogram &&) = delete;
+
+private:
+    /**
+     * @brief Количество интервалов гистограммы. Верхняя граница
+     * предпоследнего интервала - около 4 с.
+     */
+    static constexpr std::size_t bucket_count_{24};
+
+    /**
+     * @brief Расчет верхней границы интервала.
+     *
+     * @param bucket Номер интервала
+     *
+     * @return Верхняя граница в микросекундах
+     */
+    static std::uint64_t UpperBound(std::size_t bucket) noexcept;
+
+    /**
+     * @brief Оценка процентиля по гистограмме.
+     *
+     * @param buckets Количество операций в интервалах
+     * @param count Общее количество операций
+     * @param percent Процентиль
+     * @param max Максимальное время операции в микросекундах
+     *
+     * @return Верхняя граница интервала, содержащего процентиль, но не больше
+     * максимального времени, в микросекундах
+     */
+    static std::uint64_t Percentile(
+        const std::array<std::uint64_t, bucket_count_> &buckets,
+        std::uint64_t count,
+        std::uint64_t percent,
+        std::uint64_t max) noexcept;
+
+    /**
+     * @brief Количество операций в интервалах.
+     */
+    std::array<std::atomic<std::uint64_t>, bucket_count_> buckets_{};
+
+    /**
+     * @brief Количество операций.
+     */
+    std::atomic<std::uint64_t> count_{0};
+
+    /**
+     * @brief Суммарное время операций.
+     */
+    std::atomic<std::chrono::nanoseconds> latency_{};
+
+    /**
+     * @brief Максимальное время операции.
+     */
+    std::atomic<std::chrono::nanoseconds> max_latency_{};
+};
+
+}  // namespace tasp
+
+#endif  // TASP_LOGGING_LATENCY_HISTOGRAM_HPP_
@@ -0,0 +1,159 @@
+#include "log_channel.hpp"
+
+using std::memory_order_acquire;
+using std::memory_order_relaxed;
+using std::memory_order_release;
+using std::memory_order_seq_cst;
+using std::scoped_lock;
+using std::size_t;
+using std::string_view;
+using std::uint64_t;
+using std::unique_lock;
+using std::chrono::milliseconds;
+
+namespace tasp
+{
+/*------------------------------------------------------------------------------
+    LogChannel
+------------------------------------------------------------------------------*/
+LogChannel::LogChannel(LogLevel::Level level,
+                       string_view source,
+                       size_t capacity) noexcept
+: level_(level)
+, source_(source)
+, records_(capacity != 0 ? capacity : 1)
+{
+}
+
+//------------------------------------------------------------------------------
+LogChannel::~LogChannel() noexcept = default;
+
+//------------------------------------------------------------------------------
+bool LogChannel::Match(const LogLine &line) const noexcept
+{
+    return line.Level() >= level_ &&
+           line.Source().compare(0, source_.size(), source_) == 0;
+}
+
+//------------------------------------------------------------------------------
+bool LogChannel::Push(const LogLine &line) noexcept
+{
+    const uint64_t head{head_.load(memory_order_relaxed)};
+    const uint64_t tail{tail_.load(memory_order_acquire)};
+
+    if (head - tail >= records_.size())
+    {
+        dropped_.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+
+    auto &record{records_[head % records_.size()]};
+    record.level = static_cast<Logging::Level>(line.Level().Get());
+    record.timestamp = line.Timestamp();
+    record.source = line.Source();
+    record.line = line.Line();
+    record.thread_id = line.ThreadId();
+    record.message = line.Message();
+    record.sequence = line.Sequence();
+
+    head_.store(head + 1, memory_order_release);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void LogChannel::Notify() noexcept
+{
+    // Пара барьеров с функцией Wait: либо читатель увидит новую позицию
+    // записи, либо писатель увидит ожидающего читателя.
+    std::atomic_thread_fence(memory_order_seq_cst);
+    if (waiters_.load(memory_order_relaxed) == 0)
+    {
+        return;
+    }
+
+    {
+        // Захват мьютекса исключает потерю оповещения между проверкой буфера
+        // читателем и началом ожидания.
+        const scoped_lock lock{mutex_};
+    }
+    condition_.notify_all();
+}
+
+//------------------------------------------------------------------------------
+bool LogChannel::Pop(LogSubscription::Record &record) noexcept
+{
+    const uint64_t tail{tail_.load(memory_order_relaxed)};
+    const uint64_t head{head_.load(memory_order_acquire)};
+
+    if (head == tail)
+    {
+        return false;
+    }
+
+    auto &stored{records_[tail % records_.size()]};
+    record.level = stored.level;
+    record.timestamp.swap(stored.timestamp);
+    record.source.swap(stored.source);
+    record.line = stored.line;
+    record.thread_id.swap(stored.thread_id);
+    record.message.swap(stored.message);
+    record.sequence = stored.sequence;
+
+    tail_.store(tail + 1, memory_order_release);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool LogChannel::Wait(LogSubscription::Record &record,
+                      milliseconds timeout) noexcept
+{
+    if (Pop(record))
+    {
+        return true;
+    }
+
+    waiters_.fetch_add(1, memory_order_relaxed);
+    std::atomic_thread_fence(memory_order_seq_cst);
+    {
+        unique_lock lock{mutex_};
+        condition_.wait_for(lock,
+                            timeout,
+                            [this]()
+                            {
+                                return head_.load(memory_order_acquire) !=
+                                       tail_.load(memory_order_relaxed);
+                            });
+    }
+    waiters_.fetch_sub(1, memory_order_relaxed);
+
+    return Pop(record);
+}
+
+//------------------------------------------------------------------------------
+uint64_t LogChannel::Dropped() const noexcept
+{
+    return dropped_.load(memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+LogLevel::Level LogChannel::Level() const noexcept
+{
+    return level_;
+}
+
+//------------------------------------------------------------------------------
+Json::Value LogChannel::ToJSON() const noexcept
+{
+    Json::Value channel{};
+    channel["level"] = LogLevel{level_}.ToString();
+    channel["source"] = source_;
+    channel["capacity"] = Json::UInt64{records_.size()};
+    channel["pending"] = Json::UInt64{head_.load(memory_order_acquire) -
+                                      tail_.load(memory_order_acquire)};
+    channel["dropped"] = Json::UInt64{Dropped()};
+    return channel;
+}
+
+}  // namespace tasp
@@ -0,0 +1,170 @@
+/**
+ * @file
+ * @brief Канал передачи сообщений подписчику лога.
+ */
+#ifndef TASP_LOGGING_LOG_CHANNEL_HPP_
+#define TASP_LOGGING_LOG_CHANNEL_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "log_line.hpp"
+#include "tasp/logging.hpp"
+
+namespace tasp
+{
+
+/**
+ * @brief Канал передачи сообщений подписчику лога.
+ *
+ * Ограниченный кольцевой буфер на одного писателя (поток обработки логов) и
+ * одного читателя (подписчик). Писатель никогда не блокируется: если буфер
+ * заполнен, сообщение отбрасывается и учитывается в счетчике отброшенных.
+ *
+ * Память под сообщения выделяется один раз: при чтении строки обмениваются
+ * с буфером читателя.
+ */
+class LogChannel final
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * @param level Минимальный уровень передаваемых сообщений
+     * @param source Начало названия файла передаваемых сообщений. Пустая
+     * строка - сообщения из всех файлов
+     * @param capacity Максимальное количество сообщений в буфере
+     */
+    LogChannel(LogLevel::Level level,
+               std::string_view source,
+               std::size_t capacity) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~LogChannel() noexcept;
+
+    /**
+     * @brief Проверка соответствия сообщения фильтрам канала.
+     *
+     * @param line Сообщение
+     *
+     * @return Результат проверки
+     */
+    [[nodiscard]] bool Match(const LogLine &line) const noexcept;
+
+    /**
+     * @brief Запись сообщения в канал (для писателя).
+     *
+     * @param line Сообщение
+     *
+     * @return Результат записи. false - буфер заполнен, сообщение отброшено
+     */
+    bool Push(const LogLine &line) noexcept;
+
+    /**
+     * @brief Оповещение читателя, ожидающего сообщений (для писателя).
+     */
+    void Notify() noexcept;
+
+    /**
+     * @brief Чтение сообщения из канала без ожидания (для читателя).
+     *
+     * @param record Прочитанное сообщение
+     *
+     * @return Результат чтения. false - буфер пуст
+     */
+    bool Pop(LogSubscription::Record &record) noexcept;
+
+    /**
+     * @brief Чтение сообщения из канала с ожиданием (для читателя).
+     *
+     * @param record Прочитанное сообщение
+     * @param timeout Максимальное время ожидания
+     *
+     * @return Результат чтения. false - за время ожидания сообщений не было
+     */
+    bool Wait(LogSubscription::Record &record,
+              std::chrono::milliseconds timeout) noexcept;
+
+    /**
+     * @brief Запрос количества отброшенных сообщений.
+     *
+     * @return Количество сообщений
+     */
+    [[nodiscard]] std::uint64_t Dropped() const noexcept;
+
+    /**
+     * @brief Запрос минимального уровня передаваемых сообщений.
+     *
+     * @return Уровень сообщений
+     */
+    [[nodiscard]] LogLevel::Level Level() const noexcept;
+
+    /**
+     * @brief Преобразование параметров и счетчиков канала в формат
+     * Json::Value.
+     *
+     * @return Параметры канала
+     */
+    [[nodiscard]] Json::Value ToJSON() const noexcept;
+
+    LogChannel(const LogChannel &) = delete;
+    LogChannel(LogChannel &&) = delete;
+    LogChannel &operator=(const LogChannel &) = delete;
+    LogChannel &operator=(LogChannel &&) = delete;
+
+private:
+    /**
+     * @brief Минимальный уровень передаваемых сообщений.
+     */
+    LogLevel::Level level_;
+
+    /**
+     * @brief Начало названия файла передаваемых сообщений.
+     */
+    std::string source_;
+
+    /**
+     * @brief Буфер сообщений.
+     */
+    std::vector<LogSubscription::Record> records_;
+
+    /**
+     * @brief Позиция записи (монотонно возрастает).
+     */
+    std::atomic<std::uint64_t> head_{0};
+
+    /**
+     * @brief Позиция чтения (монотонно возрастает).
+     */
+    std::atomic<std::uint64_t> tail_{0};
+
+    /**
+     * @brief Количество отброшенных сообщений.
+     */
+    std::atomic<std::uint64_t> dropped_{0};
+
+    /**
+     * @brief Количество читателей, ожидающих сообщений.
+     */
+    std::atomic<std::uint32_t> waiters_{0};
+
+    /**
+     * @brief Мьютекс для условной переменной ожидания сообщений.
+     */
+    std::mutex mutex_;
+
+    /**
+     * @brief Условная переменная для ожидания сообщений.
+     */
+    std::condition_variable condition_;
+};
+
+}  // namespace tasp
+
+#endif  // TASP_LOGGING_LOG_CHANNEL_HPP_
@@ -72,6 +72,18 @@ string LogLevel::ToString() const noexcept
     return iter->second;
 }
 
+//------------------------------------------------------------------------------
+string_view LogLevel::Name() const noexcept
+{
+    auto iter = level_string_.find(value_);
+    if (iter == level_string_.end())
+    {
+        return "None";
+    }
+
+    return iter->second;
+}
+
 //------------------------------------------------------------------------------
 bool LogLevel::operator==(const LogLevel &rhs) const noexcept
 {
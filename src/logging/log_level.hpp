@@ -83,6 +83,16 @@ public:
      */
     [[nodiscard]] std::string ToString() const noexcept;
 
+    /**
+     * @brief Запрос уровня сообщения в текстовом представлении без
+     * выделения памяти.
+     *
+     * Может вызываться из обработчика сигнала.
+     *
+     * @return Уровень сообщения
+     */
+    [[nodiscard]] std::string_view Name() const noexcept;
+
     /**
      * @brief Оператор равно.
      *
@@ -1,5 +1,6 @@
 #include "log_line.hpp"
 
+#include <cstring>
 #include <experimental/filesystem>
 #include <iomanip>
 #include <iterator>
@@ -8,8 +9,13 @@
 
 #include <tasp/date.hpp>
 
+#include "tasp/logging.hpp"
+
 using std::any;
 using std::any_cast;
+using std::array;
+using std::make_unique;
+using std::memcpy;
 using std::ostream_iterator;
 using std::setw;
 using std::string;
@@ -18,7 +24,14 @@ using std::stringstream;
 using std::time_t;
 using std::to_string;
 using std::type_index;
+using std::uint32_t;
+using std::uint64_t;
+using std::uint8_t;
+using std::unique_ptr;
 using std::vector;
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+using std::chrono::steady_clock;
 
 namespace fs = std::experimental::filesystem;
 
@@ -31,20 +44,31 @@ LogLine::LogLine(const LogLevel &level,
                  const SourceLocation &location,
                  string_view format,
                  const vector<any> &params) noexcept
-: timestamp_(CurrentTimestamp())
+: time_(std::chrono::system_clock::now())
+, timestamp_(Date{time_}.ToString())
 , source_(StripFilename(location.file_name()))
 , line_(location.line())
 , thread_id_(CurrentThreadId())
 , level_(level)
-, message_(CreateMessage(format, params))
 {
+    if (HasBytes(params))
+    {
+        message_ = format;
+        format_ = format;
+        params_ = PrepareParams(params);
+    }
+    else
+    {
+        message_ = CreateMessage(format, params);
+    }
 }
 
 /*------------------------------------------------------------------------------
     LogLine
 ------------------------------------------------------------------------------*/
 LogLine::LogLine(LogLevel::Level level, string_view message) noexcept
-: timestamp_(CurrentTimestamp())
+: time_(std::chrono::system_clock::now())
+, timestamp_(Date{time_}.ToString())
 , source_(StripFilename(SourceLocation::current().file_name()))
 , line_(SourceLocation::current().line())
 , thread_id_(CurrentThreadId())
@@ -53,11 +77,48 @@ LogLine::LogLine(LogLevel::Level level, string_view message) noexcept
 {
 }
 
+//------------------------------------------------------------------------------
+LogLine::LogLine(LogLevel::Level level,
+                 string_view timestamp,
+                 string_view source,
+                 unsigned int line,
+                 string_view thread_id,
+                 string_view message) noexcept
+: timestamp_(timestamp)
+, source_(source)
+, line_(line)
+, thread_id_(thread_id)
+, level_(level)
+, message_(message)
+{
+}
+
 //------------------------------------------------------------------------------
 LogLine::~LogLine() noexcept = default;
 
 //------------------------------------------------------------------------------
-string LogLine::ToString() const noexcept
+void LogLine::Stamp(std::uint64_t sequence) noexcept
+{
+    sequence_ = sequence;
+    monotonic_ =
+        duration_cast<nanoseconds>(steady_clock::now().time_since_epoch());
+}
+
+//------------------------------------------------------------------------------
+void LogLine::Render() noexcept
+{
+    if (params_.empty())
+    {
+        return;
+    }
+
+    message_ = CreateMessage(format_, params_);
+    format_.clear();
+    params_.clear();
+}
+
+//------------------------------------------------------------------------------
+string LogLine::ToString(bool stamps) const noexcept
 {
     stringstream buf{};
 
@@ -66,6 +127,10 @@ string LogLine::ToString() const noexcept
     const int level_width{7};
 
     buf << Timestamp() << " ";
+    if (stamps)
+    {
+        buf << "#" << Sequence() << " " << Monotonic().count() << "ns ";
+    }
     buf << setw(source_width) << Source();
     buf << setw(line_width) << Line() << " ";
     buf << ThreadId() << " ";
@@ -75,12 +140,174 @@ string LogLine::ToString() const noexcept
     return buf.str();
 }
 
+//------------------------------------------------------------------------------
+Json::Value LogLine::ToJSON(bool stamps) const noexcept
+{
+    Json::Value line;
+    line["timestamp"] = Timestamp();
+    if (stamps)
+    {
+        line["sequence"] = Json::UInt64{Sequence()};
+        line["monotonic_ns"] = Json::Int64{Monotonic().count()};
+    }
+    line["source"] = Source();
+    line["line"] = Line();
+    line["thread"] = ThreadId();
+    line["level"] = Level().ToString();
+    line["message"] = Message();
+    return line;
+}
+
+namespace
+{
+/**
+ * @brief Добавление значения фиксированного размера в двоичное представление.
+ *
+ * @param data Двоичное представление
+ * @param value Значение
+ */
+template<class Type> inline void Append(string &data, const Type &value) noexcept
+{
+    data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Добавление строки в двоичное представление.
+ *
+ * Строка записывается в виде длины и содержимого.
+ *
+ * @param data Двоичное представление
+ * @param value Строка
+ */
+inline void AppendString(string &data, string_view value) noexcept
+{
+    Append(data, static_cast<uint32_t>(value.size()));
+    data.append(value);
+}
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Чтение значения фиксированного размера из двоичного представления.
+ *
+ * @param data Оставшаяся часть двоичного представления
+ * @param value Прочитанное значение
+ *
+ * @return Результат чтения
+ */
+template<class Type> inline bool Extract(string_view &data, Type &value) noexcept
+{
+    if (data.size() < sizeof(value))
+    {
+        return false;
+    }
+
+    memcpy(&value, data.data(), sizeof(value));
+    data.remove_prefix(sizeof(value));
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Чтение строки из двоичного представления.
+ *
+ * @param data Оставшаяся часть двоичного представления
+ * @param value Прочитанная строка
+ *
+ * @return Результат чтения
+ */
+inline bool ExtractString(string_view &data, string_view &value) noexcept
+{
+    uint32_t size{0};
+    if (!Extract(data, size) || data.size() < size)
+    {
+        return false;
+    }
+
+    value = data.substr(0, size);
+    data.remove_prefix(size);
+    return true;
+}
+}  // namespace
+
+//------------------------------------------------------------------------------
+string LogLine::Serialize(string_view origin) const noexcept
+{
+    string data{};
+    data.reserve(sizeof(uint64_t) * 3 + sizeof(uint32_t) * 5 + 1 +
+                 timestamp_.size() + source_.size() + origin.size() + 1 +
+                 thread_id_.size() + message_.size());
+
+    Append(data, sequence_);
+    Append(data, static_cast<int64_t>(monotonic_.count()));
+    Append(data,
+           static_cast<int64_t>(
+               duration_cast<nanoseconds>(time_.time_since_epoch()).count()));
+    Append(data, static_cast<uint32_t>(line_));
+    Append(data, static_cast<uint8_t>(level_.Get()));
+    AppendString(data, timestamp_);
+    AppendString(data, source_);
+    if (origin.empty())
+    {
+        AppendString(data, thread_id_);
+    }
+    else
+    {
+        AppendString(data, string{origin} + " " + thread_id_);
+    }
+    AppendString(data, message_);
+
+    return data;
+}
+
+//------------------------------------------------------------------------------
+unique_ptr<LogLine> LogLine::Deserialize(string_view data) noexcept
+{
+    uint64_t sequence{0};
+    int64_t monotonic{0};
+    int64_t time{0};
+    uint32_t line{0};
+    uint8_t level{0};
+    string_view timestamp{};
+    string_view source{};
+    string_view thread_id{};
+    string_view message{};
+
+    if (!Extract(data, sequence) || !Extract(data, monotonic) ||
+        !Extract(data, time) || !Extract(data, line) || !Extract(data, level) ||
+        !ExtractString(data, timestamp) || !ExtractString(data, source) ||
+        !ExtractString(data, thread_id) || !ExtractString(data, message) ||
+        level > static_cast<uint8_t>(LogLevel::Level::None))
+    {
+        return nullptr;
+    }
+
+    auto result{make_unique<LogLine>(static_cast<LogLevel::Level>(level),
+                                     timestamp,
+                                     source,
+                                     line,
+                                     thread_id,
+                                     message)};
+    result->sequence_ = sequence;
+    result->monotonic_ = nanoseconds{monotonic};
+    result->time_ = Timepoint{duration_cast<Timepoint::duration>(
+        nanoseconds{time})};
+
+    return result;
+}
+
 //------------------------------------------------------------------------------
 const string &LogLine::Timestamp() const noexcept
 {
     return timestamp_;
 }
 
+//------------------------------------------------------------------------------
+const Timepoint &LogLine::Time() const noexcept
+{
+    return time_;
+}
+
 //------------------------------------------------------------------------------
 const string &LogLine::Source() const noexcept
 {
@@ -112,16 +339,34 @@ const string &LogLine::Message() const noexcept
 }
 
 //------------------------------------------------------------------------------
-string LogLine::CurrentTimestamp() noexcept
+const string &LogLine::Format() const noexcept
+{
+    return format_;
+}
+
+//------------------------------------------------------------------------------
+std::uint64_t LogLine::Sequence() const noexcept
+{
+    return sequence_;
+}
+
+//------------------------------------------------------------------------------
+nanoseconds LogLine::Monotonic() const noexcept
 {
-    return Date().ToString();
+    return monotonic_;
 }
 
 //------------------------------------------------------------------------------
 string LogLine::CurrentThreadId() noexcept
+{
+    return ThreadIdToString(std::this_thread::get_id());
+}
+
+//------------------------------------------------------------------------------
+string LogLine::ThreadIdToString(std::thread::id thread_id) noexcept
 {
     stringstream buf{};
-    buf << "[0x" << std::this_thread::get_id() << "]";
+    buf << "[0x" << thread_id << "]";
 
     return buf.str();
 }
@@ -167,6 +412,38 @@ string LogLine::CreateMessage(string_view format,
     return message;
 }
 
+//------------------------------------------------------------------------------
+bool LogLine::HasBytes(const vector<any> &params) noexcept
+{
+    return std::any_of(params.cbegin(),
+                       params.cend(),
+                       [](const any &value)
+                       {
+                           return value.type() == typeid(Bytes);
+                       });
+}
+
+//------------------------------------------------------------------------------
+vector<any> LogLine::PrepareParams(const vector<any> &params) noexcept
+{
+    vector<any> prepared{};
+    prepared.reserve(params.size());
+
+    for (const auto &value : params)
+    {
+        if (value.type() == typeid(Bytes))
+        {
+            prepared.push_back(value);
+        }
+        else
+        {
+            prepared.emplace_back(CreateMessage("{}", {value}));
+        }
+    }
+
+    return prepared;
+}
+
 namespace
 {
 /*------------------------------------------------------------------------------
@@ -235,6 +512,104 @@ inline string ConvertVectorToString(const vector<Type> &value) noexcept
     return stream.str();
 }
 
+//------------------------------------------------------------------------------
+/**
+ * @brief Таблица шестнадцатеричного представления байтов.
+ */
+constexpr auto hex_table{[]()
+                         {
+                             const string_view digits{"0123456789abcdef"};
+                             const size_t base{16};
+                             array<char, 512> table{};
+                             for (size_t i = 0; i < table.size() / 2; ++i)
+                             {
+                                 table[2 * i] = digits[i / base];
+                                 table[2 * i + 1] = digits[i % base];
+                             }
+                             return table;
+                         }()};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Конвертация двоичных данных в шестнадцатеричный дамп.
+ *
+ * Каждая строка дампа содержит смещение, 16 байт в шестнадцатеричном виде и
+ * их текстовое представление (непечатаемые символы заменяются точкой):
+ * @code
+ * 20 байт:
+ * 0000  47 45 54 20 2f 20 48 54  54 50 2f 31 2e 31 0d 0a  |GET / HTTP/1.1..|
+ * 0010  48 6f 73 74                                       |Host|
+ * @endcode
+ *
+ * @param bytes Значение для конвертации
+ *
+ * @return Строковое представление
+ */
+inline string ConvertBytesToString(const Bytes &bytes) noexcept
+{
+    const size_t row_size{16};
+    const size_t group_size{8};
+    const size_t hex_width{row_size * 3 + 2};
+
+    const auto data{bytes.Data()};
+
+    // Смещение выводится 4 цифрами, для данных больше 64 КиБ - 8 цифрами.
+    const size_t max_short_offset{0x10000};
+    const size_t offset_bytes{data.size() > max_short_offset ? 4U : 2U};
+
+    string text{to_string(bytes.Size()) + " байт"};
+    if (data.size() < bytes.Size())
+    {
+        text += " (показаны первые " + to_string(data.size()) + ")";
+    }
+    text += ':';
+
+    // Перевод строки, смещение, байты и текст в разделителях.
+    const size_t row_length{1 + offset_bytes * 2 + 2 + hex_width + row_size + 2};
+    const size_t rows{(data.size() + row_size - 1) / row_size};
+    size_t position{text.size()};
+    text.resize(position + rows * row_length, ' ');
+
+    for (size_t row = 0; row < rows; ++row)
+    {
+        const size_t offset{row * row_size};
+        const size_t count{std::min(row_size, data.size() - offset)};
+
+        char *line{&text[position]};
+        *line++ = '\n';
+
+        for (size_t i = offset_bytes; i > 0; --i)
+        {
+            const auto byte{static_cast<uint8_t>(offset >> ((i - 1) * 8))};
+            memcpy(line, &hex_table.at(2 * size_t{byte}), 2);
+            line += 2;
+        }
+        line += 2;
+
+        char *ascii{line + hex_width};
+        *ascii++ = '|';
+        for (size_t i = 0; i < count; ++i)
+        {
+            const auto byte{static_cast<uint8_t>(data[offset + i])};
+            memcpy(line + i * 3 + (i >= group_size ? 1 : 0),
+                   &hex_table.at(2 * size_t{byte}),
+                   2);
+
+            const uint8_t first_printable{0x20};
+            const uint8_t last_printable{0x7e};
+            *ascii++ = byte >= first_printable && byte <= last_printable
+                           ? static_cast<char>(byte)
+                           : '.';
+        }
+        *ascii++ = '|';
+
+        position = static_cast<size_t>(ascii - text.data());
+    }
+
+    text.resize(position);
+    return text;
+}
+
 //------------------------------------------------------------------------------
 /**
  * @brief Инициализация функциями конвертации.
@@ -267,7 +642,8 @@ inline VisitorList VisitorInitialization() noexcept
             [](const Date &date)
             {
                 return date.ToString();
-            })};
+            }),
+        ToAnyVisitor<Bytes>(ConvertBytesToString)};
     return list;
 }
 }  // namespace
@@ -5,14 +5,20 @@
 #ifndef TASP_LOGGING_LOG_LINE_HPP_
 #define TASP_LOGGING_LOG_LINE_HPP_
 
+#include <jsoncpp/json/json.h>
+
 #include <any>
+#include <chrono>
 #include <experimental/source_location>
 #include <functional>
+#include <memory>
 #include <string_view>
+#include <thread>
 #include <typeindex>
 #include <vector>
 
 #include "log_level.hpp"
+#include "tasp/date.hpp"
 
 /**
  * @brief Убирание использования std::experimental.
@@ -41,6 +47,10 @@ public:
      *
      * Преобразует полученные данные в формат вывода в лог.
      *
+     * Если среди параметров есть двоичные данные (@ref Bytes), сообщение
+     * формируется позже функцией @ref Render: остальные параметры сразу
+     * преобразуются в строки, двоичные данные сохраняются.
+     *
      * @param level Уровень сообщения
      * @param location Информация о месте вызова функции логирования
      * @param format Формат сообщения для вывода с местами для вставки
@@ -60,6 +70,25 @@ public:
      */
     LogLine(LogLevel::Level level, std::string_view message) noexcept;
 
+    /**
+     * @brief Конструктор с передачей всех полей сообщения.
+     *
+     * Используется для восстановления ранее сформированного сообщения.
+     *
+     * @param level Уровень сообщения
+     * @param timestamp Дата и время в формате ГГГГ-ММ-ДД ЧЧ:ММ:СС
+     * @param source Название файла
+     * @param line Номер строки
+     * @param thread_id Идентификатор потока
+     * @param message Сообщение
+     */
+    LogLine(LogLevel::Level level,
+            std::string_view timestamp,
+            std::string_view source,
+            unsigned int line,
+            std::string_view thread_id,
+            std::string_view message) noexcept;
+
     /**
      * @brief Конструктор копирования.
      *
@@ -72,20 +101,72 @@ public:
      */
     ~LogLine() noexcept;
 
+    /**
+     * @brief Установка порядкового номера и монотонного времени добавления
+     * сообщения в очередь.
+     *
+     * @param sequence Порядковый номер сообщения
+     */
+    void Stamp(std::uint64_t sequence) noexcept;
+
+    /**
+     * @brief Формирование отложенного сообщения.
+     *
+     * До вызова функции сообщение содержит формат без подстановки
+     * параметров. Повторные вызовы ничего не делают.
+     */
+    void Render() noexcept;
+
     /**
      * @brief Формирование строки для вывода в лог со всеми полями.
      *
      * Формат вывода:
      *  - Дата и время в формате ГГГГ-ММ-ДД ЧЧ:ММ:СС
+     *  - Порядковый номер и монотонное время в наносекундах в формате
+     *    #НОМЕР ВРЕМЯns (только при stamps = true)
      *  - Название файла
      *  - Номер строки
      *  - Идентификатор потока в формате [0xНОМЕР_ПОТОКА]
      *  - Уровень сообщения
      *  - Сообщение
      *
+     * @param stamps Выводить ли порядковый номер и монотонное время
+     *
      * @return Сформированная строка
      */
-    [[nodiscard]] std::string ToString() const noexcept;
+    [[nodiscard]] std::string ToString(bool stamps = false) const noexcept;
+
+    /**
+     * @brief Преобразование сообщения в формат Json::Value.
+     *
+     * @param stamps Выводить ли порядковый номер и монотонное время
+     *
+     * @return Сообщение в формате Json::Value
+     */
+    [[nodiscard]] Json::Value ToJSON(bool stamps = false) const noexcept;
+
+    /**
+     * @brief Преобразование сообщения в компактное двоичное представление.
+     *
+     * Используется для передачи сообщений между процессами и сохранения их
+     * во временные файлы.
+     *
+     * @param origin Источник сообщения (например, имя и PID процесса).
+     * Если передан, добавляется перед идентификатором потока
+     *
+     * @return Двоичное представление сообщения
+     */
+    [[nodiscard]] std::string Serialize(
+        std::string_view origin = {}) const noexcept;
+
+    /**
+     * @brief Восстановление сообщения из двоичного представления.
+     *
+     * @param data Двоичное представление, полученное из @ref Serialize
+     *
+     * @return Сообщение или nullptr, если данные повреждены
+     */
+    static std::unique_ptr<LogLine> Deserialize(std::string_view data) noexcept;
 
     /**
      * @brief Запрос даты и времени формирования сообщения в лог.
@@ -94,6 +175,13 @@ public:
      */
     [[nodiscard]] const std::string &Timestamp() const noexcept;
 
+    /**
+     * @brief Запрос момента формирования сообщения в лог.
+     *
+     * @return Момент времени
+     */
+    [[nodiscard]] const Timepoint &Time() const noexcept;
+
     /**
      * @brief Запрос названия файла в котором произошел вызов функции добавления
      * сообщения в лог.
@@ -131,24 +219,66 @@ public:
      */
     [[nodiscard]] const std::string &Message() const noexcept;
 
+    /**
+     * @brief Запрос формата отложенного сообщения.
+     *
+     * @return Формат или пустая строка, если сообщение уже сформировано
+     */
+    [[nodiscard]] const std::string &Format() const noexcept;
+
+    /**
+     * @brief Запрос порядкового номера сообщения.
+     *
+     * Номер присваивается при добавлении сообщения в очередь и едином для
+     * всех потоков процесса.
+     *
+     * @return Порядковый номер
+     */
+    [[nodiscard]] std::uint64_t Sequence() const noexcept;
+
+    /**
+     * @brief Запрос монотонного времени добавления сообщения в очередь.
+     *
+     * @return Время std::chrono::steady_clock в наносекундах
+     */
+    [[nodiscard]] std::chrono::nanoseconds Monotonic() const noexcept;
+
+    /**
+     * @brief Формирования сообщения на основе формата.
+     *
+     * В формате могут присутствовать последовательности символов {}. На это
+     * место вставляются значения из параметров.
+     *
+     * @param format Формат сообщения для вывода с местами для вставки
+     * параметров
+     * @param params Параметры для добавления в формат
+     *
+     * @return Сообщение
+     */
+    static std::string CreateMessage(
+        std::string_view format,
+        const std::vector<std::any> &params) noexcept;
+
     LogLine(LogLine &&) = delete;
     LogLine &operator=(const LogLine &) = delete;
     LogLine &operator=(LogLine &&) = delete;
 
 private:
     /**
-     * @brief Получение текущего времени.
+     * @brief Получение идентификатора текущего процесса.
      *
-     * @return Дата и время в формате ГГГГ-ММ-ДД ЧЧ:ММ:СС
+     * @return Идентификатор потока в формате [0xНОМЕР_ПОТОКА]
      */
-    static std::string CurrentTimestamp() noexcept;
+    static std::string CurrentThreadId() noexcept;
 
     /**
-     * @brief Получение идентификатора текущего процесса.
+     * @brief Преобразование идентификатора потока в текстовый формат.
+     *
+     * @param thread_id Идентификатор потока
      *
      * @return Идентификатор потока в формате [0xНОМЕР_ПОТОКА]
      */
-    static std::string CurrentThreadId() noexcept;
+    static std::string ThreadIdToString(std::thread::id thread_id) noexcept;
 
     /**
      * @brief Вырезание пути из переданного значения оставляя только имя файла.
@@ -160,21 +290,32 @@ private:
     static std::string StripFilename(std::string_view path) noexcept;
 
     /**
-     * @brief Формирования сообщения на основе формата.
+     * @brief Проверка наличия двоичных данных среди параметров.
      *
-     * В формате могут присутствовать последовательности символов {}. На это
-     * место вставляются значения из параметров.
+     * @param params Параметры для добавления в формат
+     *
+     * @return Результат проверки
+     */
+    static bool HasBytes(const std::vector<std::any> &params) noexcept;
+
+    /**
+     * @brief Подготовка параметров для отложенного формирования сообщения.
+     *
+     * Все параметры, кроме двоичных данных, преобразуются в строки, т.к.
+     * могут ссылаться на данные, которые не доживут до формирования.
      *
-     * @param format Формат сообщения для вывода с местами для вставки
-     * параметров
      * @param params Параметры для добавления в формат
      *
-     * @return Сообщение
+     * @return Подготовленные параметры
      */
-    static std::string CreateMessage(
-        std::string_view format,
+    static std::vector<std::any> PrepareParams(
         const std::vector<std::any> &params) noexcept;
 
+    /**
+     * @brief Момент формирования сообщения.
+     */
+    Timepoint time_{};
+
     /**
      * @brief Дата и время в формате ГГГГ-ММ-ДД ЧЧ:ММ:СС.
      */
@@ -205,6 +346,26 @@ private:
      */
     std::string message_;
 
+    /**
+     * @brief Формат отложенного сообщения.
+     */
+    std::string format_;
+
+    /**
+     * @brief Параметры отложенного сообщения.
+     */
+    std::vector<std::any> params_;
+
+    /**
+     * @brief Порядковый номер сообщения.
+     */
+    std::uint64_t sequence_{0};
+
+    /**
+     * @brief Монотонное время добавления сообщения в очередь.
+     */
+    std::chrono::nanoseconds monotonic_{0};
+
     /**
      * @brief Список типов данных поддерживаемых для вывода в лог с функциями
      * преобразования их в текстовое представление.
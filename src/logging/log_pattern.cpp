@@ -0,0 +1,219 @@
+#include "log_pattern.hpp"
+
+#include <array>
+#include <charconv>
+#include <unordered_map>
+
+#include "tasp/logging.hpp"
+
+using std::array;
+using std::size_t;
+using std::string;
+using std::string_view;
+using std::to_chars;
+using std::uint64_t;
+using std::chrono::duration_cast;
+using std::chrono::milliseconds;
+
+namespace tasp
+{
+/*------------------------------------------------------------------------------
+    LogPattern
+------------------------------------------------------------------------------*/
+LogPattern::LogPattern(string_view pattern) noexcept
+{
+    static const std::unordered_map<char, Field> fields{
+        {'T', Field::Timestamp},
+        {'f', Field::Millisecond},
+        {'s', Field::Source},
+        {'l', Field::Line},
+        {'t', Field::Thread},
+        {'L', Field::Level},
+        {'m', Field::Message},
+        {'n', Field::Sequence},
+        {'M', Field::Monotonic}};
+
+    size_t position{0};
+    while (position < pattern.size())
+    {
+        const size_t percent{pattern.find('%', position)};
+        AddText(pattern.substr(position, percent - position));
+        if (percent == string_view::npos)
+        {
+            break;
+        }
+
+        size_t current{percent + 1};
+        if (current < pattern.size() && pattern[current] == '%')
+        {
+            AddText("%");
+            position = current + 1;
+            continue;
+        }
+
+        const bool left{current < pattern.size() && pattern[current] == '-'};
+        if (left)
+        {
+            ++current;
+        }
+
+        // Накопление ширины останавливается после превышения максимума,
+        // чтобы длинная последовательность цифр не переполнила значение.
+        int width{0};
+        const size_t digits{current};
+        while (current < pattern.size() && pattern[current] >= '0' &&
+               pattern[current] <= '9')
+        {
+            const int base{10};
+            if (width <= max_width_)
+            {
+                width = width * base + (pattern[current] - '0');
+            }
+            ++current;
+        }
+        if (width > max_width_)
+        {
+            Logging::Warning("Ширина поля {} в шаблоне лога больше {}, "
+                             "ширина не учитывается",
+                             pattern.substr(digits, current - digits),
+                             max_width_);
+            width = 0;
+        }
+
+        const auto field{current < pattern.size()
+                             ? fields.find(pattern[current])
+                             : fields.end()};
+        if (field == fields.end())
+        {
+            AddText(pattern.substr(percent, current - percent));
+            position = current;
+            continue;
+        }
+
+        operations_.push_back({field->second, left ? -width : width, 0, 0});
+        position = current + 1;
+    }
+}
+
+//------------------------------------------------------------------------------
+LogPattern::~LogPattern() noexcept = default;
+
+//------------------------------------------------------------------------------
+void LogPattern::Format(const LogLine &line, string &buffer) const noexcept
+{
+    for (const auto &operation : operations_)
+    {
+        switch (operation.field)
+        {
+            case Field::Text:
+                buffer.append(text_, operation.offset, operation.size);
+                break;
+
+            case Field::Timestamp:
+                Append(line.Timestamp(), operation.width, buffer);
+                break;
+
+            case Field::Millisecond:
+            {
+                const int base{1000};
+                const auto count{
+                    duration_cast<milliseconds>(line.Time().time_since_epoch())
+                        .count() %
+                    base};
+                array<char, 3> digits{
+                    {static_cast<char>('0' + count / 100),
+                     static_cast<char>('0' + count / 10 % 10),
+                     static_cast<char>('0' + count % 10)}};
+                Append(string_view{digits.data(), digits.size()},
+                       operation.width,
+                       buffer);
+                break;
+            }
+
+            case Field::Source:
+                Append(line.Source(), operation.width, buffer);
+                break;
+
+            case Field::Line:
+                Append(uint64_t{line.Line()}, operation.width, buffer);
+                break;
+
+            case Field::Thread:
+                Append(line.ThreadId(), operation.width, buffer);
+                break;
+
+            case Field::Level:
+                Append(line.Level().Name(), operation.width, buffer);
+                break;
+
+            case Field::Message:
+                Append(line.Message(), operation.width, buffer);
+                break;
+
+            case Field::Sequence:
+                Append(line.Sequence(), operation.width, buffer);
+                break;
+
+            case Field::Monotonic:
+                Append(static_cast<uint64_t>(line.Monotonic().count()),
+                       operation.width,
+                       buffer);
+                break;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void LogPattern::AddText(string_view text) noexcept
+{
+    if (text.empty())
+    {
+        return;
+    }
+
+    if (!operations_.empty() && operations_.back().field == Field::Text)
+    {
+        operations_.back().size += text.size();
+    }
+    else
+    {
+        operations_.push_back({Field::Text, 0, text_.size(), text.size()});
+    }
+
+    text_ += text;
+}
+
+//------------------------------------------------------------------------------
+void LogPattern::Append(string_view value, int width, string &buffer) noexcept
+{
+    const auto size{width < 0 ? size_t{0} - static_cast<size_t>(width)
+                              : static_cast<size_t>(width)};
+    if (value.size() >= size)
+    {
+        buffer += value;
+        return;
+    }
+
+    if (width > 0)
+    {
+        buffer.append(size - value.size(), ' ');
+        buffer += value;
+    }
+    else
+    {
+        buffer += value;
+        buffer.append(size - value.size(), ' ');
+    }
+}
+
+//------------------------------------------------------------------------------
+void LogPattern::Append(uint64_t value, int width, string &buffer) noexcept
+{
+    array<char, 24> digits{};
+    const auto [end, error]{to_chars(digits.begin(), digits.end(), value)};
+    Append(string_view{digits.data(), static_cast<size_t>(end - digits.data())},
+           width,
+           buffer);
+}
+
+}  // namespace tasp
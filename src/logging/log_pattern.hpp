@@ -0,0 +1,175 @@
+/**
+ * @file
+ * @brief Шаблон формирования строки лога.
+ */
+#ifndef TASP_LOGGING_LOG_PATTERN_HPP_
+#define TASP_LOGGING_LOG_PATTERN_HPP_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "log_line.hpp"
+
+namespace tasp
+{
+
+/**
+ * @brief Шаблон формирования строки лога.
+ *
+ * Шаблон разбирается один раз при создании в плоский список операций, после
+ * чего строки формируются без разбора шаблона и без промежуточных потоков
+ * вывода.
+ *
+ * Поддерживаемые поля:
+ *  - %T - дата и время в формате ГГГГ-ММ-ДД ЧЧ:ММ:СС
+ *  - %f - миллисекунды
+ *  - %s - название файла
+ *  - %l - номер строки
+ *  - %t - идентификатор потока
+ *  - %L - уровень сообщения
+ *  - %m - сообщение
+ *  - %n - порядковый номер сообщения
+ *  - %M - монотонное время в наносекундах
+ *  - %% - символ %
+ *
+ * Между % и полем можно указать ширину поля: %24s - выравнивание по правому
+ * краю, %-24s - по левому. Ширина больше @ref max_width_ не учитывается (с
+ * предупреждением в лог). Неизвестные поля выводятся как есть.
+ */
+class LogPattern final
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * @param pattern Шаблон строки
+     */
+    explicit LogPattern(std::string_view pattern = default_) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~LogPattern() noexcept;
+
+    /**
+     * @brief Формирование строки лога.
+     *
+     * Строка добавляется в конец буфера без перевода строки.
+     *
+     * @param line Данные для вывода
+     * @param buffer Буфер для результата
+     */
+    void Format(const LogLine &line, std::string &buffer) const noexcept;
+
+    /**
+     * @brief Шаблон по умолчанию (соответствует LogLine::ToString).
+     */
+    static constexpr std::string_view default_{"%T %24s%4l %t %7L %m"};
+
+    /**
+     * @brief Шаблон по умолчанию с порядковым номером и монотонным временем.
+     */
+    static constexpr std::string_view stamps_{
+        "%T #%n %Mns %24s%4l %t %7L %m"};
+
+    /**
+     * @brief Максимальная ширина поля.
+     */
+    static constexpr int max_width_{1024};
+
+    LogPattern(const LogPattern &) = delete;
+    LogPattern(LogPattern &&) = delete;
+    LogPattern &operator=(const LogPattern &) = delete;
+    LogPattern &operator=(LogPattern &&) = delete;
+
+private:
+    /**
+     * @brief Поля строки лога.
+     */
+    enum class Field : std::uint8_t
+    {
+        Text = 0,      /*!< Текст из шаблона */
+        Timestamp = 1, /*!< Дата и время */
+        Millisecond = 2, /*!< Миллисекунды */
+        Source = 3,    /*!< Название файла */
+        Line = 4,      /*!< Номер строки */
+        Thread = 5,    /*!< Идентификатор потока */
+        Level = 6,     /*!< Уровень сообщения */
+        Message = 7,   /*!< Сообщение */
+        Sequence = 8,  /*!< Порядковый номер */
+        Monotonic = 9  /*!< Монотонное время */
+    };
+
+    /**
+     * @brief Операция формирования строки.
+     */
+    struct Operation
+    {
+        /**
+         * @brief Выводимое поле.
+         */
+        Field field;
+
+        /**
+         * @brief Ширина поля. Отрицательное значение - выравнивание по левому
+         * краю.
+         */
+        int width;
+
+        /**
+         * @brief Смещение текста в @ref text_ (только для Field::Text).
+         */
+        std::size_t offset;
+
+        /**
+         * @brief Размер текста (только для Field::Text).
+         */
+        std::size_t size;
+    };
+
+    /**
+     * @brief Добавление текста из шаблона.
+     *
+     * Соседние участки текста объединяются в одну операцию.
+     *
+     * @param text Текст
+     */
+    void AddText(std::string_view text) noexcept;
+
+    /**
+     * @brief Вывод значения с учетом ширины поля.
+     *
+     * @param value Значение
+     * @param width Ширина поля
+     * @param buffer Буфер для результата
+     */
+    static void Append(std::string_view value,
+                       int width,
+                       std::string &buffer) noexcept;
+
+    /**
+     * @brief Вывод числа с учетом ширины поля.
+     *
+     * @param value Число
+     * @param width Ширина поля
+     * @param buffer Буфер для результата
+     */
+    static void Append(std::uint64_t value,
+                       int width,
+                       std::string &buffer) noexcept;
+
+    /**
+     * @brief Текст из шаблона для всех операций Field::Text.
+     */
+    std::string text_;
+
+    /**
+     * @brief Список операций формирования строки.
+     */
+    std::vector<Operation> operations_;
+};
+
+}  // namespace tasp
+
+#endif  // TASP_LOGGING_LOG_PATTERN_HPP_
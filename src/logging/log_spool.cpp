@@ -0,0 +1,413 @@
+#include "log_spool.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+using std::deque;
+using std::memcpy;
+using std::size_t;
+using std::string_view;
+using std::uint32_t;
+using std::uint64_t;
+
+namespace tasp
+{
+/*------------------------------------------------------------------------------
+    LogSpool
+------------------------------------------------------------------------------*/
+LogSpool::LogSpool() noexcept = default;
+
+//------------------------------------------------------------------------------
+LogSpool::~LogSpool() noexcept
+{
+    Close();
+}
+
+//------------------------------------------------------------------------------
+bool LogSpool::Open(const fs::path &path, size_t max_size) noexcept
+{
+    if (fd_ != -1 && path == path_)
+    {
+        max_size_ = max_size;
+        return true;
+    }
+
+    Close();
+
+    fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd_ == -1)
+    {
+        return false;
+    }
+
+    path_ = path;
+    max_size_ = max_size;
+    write_buffer_.reserve(buffer_size_);
+    ++generation_;
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void LogSpool::Close() noexcept
+{
+    if (fd_ != -1)
+    {
+        close(fd_);
+        fd_ = -1;
+
+        std::error_code error{};
+        fs::remove(path_, error);
+        path_.clear();
+    }
+
+    // Записываемый буфер продолжает писаться в закрытый файл и будет
+    // отброшен при подтверждении, остальные непрочитанные сообщения
+    // отбрасываются сразу.
+    dropped_ += pending_ - writing_count_;
+    ++generation_;
+    writing_ = false;
+    writing_size_ = 0;
+    writing_count_ = 0;
+
+    write_buffer_.clear();
+    write_offset_ = 0;
+    read_offset_ = 0;
+    pending_ = 0;
+}
+
+//------------------------------------------------------------------------------
+bool LogSpool::Append(const LogLine &line) noexcept
+{
+    const std::string record{line.Serialize()};
+    const size_t need{header_size_ + record.size()};
+
+    // Ограничивается объем непрочитанных данных, а не размер файла:
+    // прочитанное начало файла освобождается в Read.
+    if (fd_ == -1 || Size() + need > max_size_)
+    {
+        ++dropped_;
+        return false;
+    }
+
+    const auto size{static_cast<uint32_t>(record.size())};
+    const uint32_t checksum{Checksum(record)};
+    write_buffer_.append(reinterpret_cast<const char *>(&size), sizeof(size));
+    write_buffer_.append(reinterpret_cast<const char *>(&checksum),
+                         sizeof(checksum));
+    write_buffer_ += record;
+    ++pending_;
+    ++spooled_;
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool LogSpool::TakeChunk(Chunk &chunk) noexcept
+{
+    if (fd_ == -1 || writing_ || write_buffer_.size() < buffer_size_)
+    {
+        return false;
+    }
+
+    // Запись выполняется через копию дескриптора, чтобы закрытие файла во
+    // время записи не освободило дескриптор.
+    chunk.fd = fcntl(fd_, F_DUPFD_CLOEXEC, 0);
+    if (chunk.fd == -1)
+    {
+        return false;
+    }
+
+    chunk.data.swap(write_buffer_);
+    write_buffer_.clear();
+    write_buffer_.reserve(buffer_size_);
+    chunk.offset = write_offset_;
+    chunk.count = Count(chunk.data);
+    chunk.generation = generation_;
+    chunk.written = false;
+
+    writing_ = true;
+    writing_size_ = chunk.data.size();
+    writing_count_ = chunk.count;
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void LogSpool::WriteChunk(Chunk &chunk) noexcept
+{
+    string_view data{chunk.data};
+    size_t offset{chunk.offset};
+    while (!data.empty())
+    {
+        const ssize_t written{pwrite(
+            chunk.fd, data.data(), data.size(), static_cast<off_t>(offset))};
+        if (written == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        data.remove_prefix(static_cast<size_t>(written));
+        offset += static_cast<size_t>(written);
+    }
+
+    chunk.written = data.empty();
+
+    close(chunk.fd);
+    chunk.fd = -1;
+}
+
+//------------------------------------------------------------------------------
+void LogSpool::Commit(const Chunk &chunk) noexcept
+{
+    if (chunk.generation != generation_)
+    {
+        dropped_ += chunk.count;
+        return;
+    }
+
+    writing_ = false;
+    writing_size_ = 0;
+    writing_count_ = 0;
+
+    if (chunk.written)
+    {
+        write_offset_ = chunk.offset + chunk.data.size();
+        return;
+    }
+
+    // Частично записанные данные отрезаются, сообщения будут записаны
+    // повторно со следующим буфером или прочитаны из памяти. Если усечь файл
+    // не удалось, данные за концом записанных не читаются и перезаписываются
+    // следующим буфером.
+    if (ftruncate(fd_, static_cast<off_t>(chunk.offset)) == 0)
+    {
+        write_offset_ = chunk.offset;
+    }
+    write_buffer_.insert(0, chunk.data);
+}
+
+//------------------------------------------------------------------------------
+size_t LogSpool::Read(deque<LogLine> &lines, size_t count) noexcept
+{
+    if (pending_ == 0)
+    {
+        return 0;
+    }
+
+    size_t result{0};
+    bool corrupted{false};
+    while (result < count && read_offset_ < write_offset_)
+    {
+        const size_t available{write_offset_ - read_offset_};
+        read_buffer_.resize(std::min(std::max(read_buffer_.size(), buffer_size_),
+                                     available));
+
+        const ssize_t bytes{pread(fd_,
+                                  read_buffer_.data(),
+                                  read_buffer_.size(),
+                                  static_cast<off_t>(read_offset_))};
+        if (bytes <= 0)
+        {
+            if (bytes == -1 && errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        const size_t parsed{Parse(
+            string_view{read_buffer_.data(), static_cast<size_t>(bytes)},
+            lines,
+            count,
+            result,
+            corrupted)};
+        read_offset_ += parsed;
+        if (corrupted)
+        {
+            break;
+        }
+
+        if (parsed == 0)
+        {
+            // Сообщение не поместилось в буфер чтения целиком.
+            uint32_t size{0};
+            memcpy(&size, read_buffer_.data(), sizeof(size));
+            if (static_cast<size_t>(bytes) < header_size_ ||
+                header_size_ + size > available)
+            {
+                corrupted = true;
+                break;
+            }
+            read_buffer_.resize(header_size_ + size);
+        }
+    }
+
+    if (corrupted)
+    {
+        // Файл поврежден: непрочитанные сообщения из файла отбрасываются.
+        read_offset_ = write_offset_;
+        const size_t lost{pending_ - writing_count_ - Count(write_buffer_)};
+        dropped_ += lost;
+        pending_ -= lost;
+    }
+
+    // Сообщения, еще не записанные в файл, читаются из памяти, если перед
+    // ними нет записываемого буфера.
+    if (result < count && read_offset_ >= write_offset_ && !writing_)
+    {
+        bool ignored{false};
+        write_buffer_.erase(
+            0, Parse(write_buffer_, lines, count, result, ignored));
+    }
+
+    if (read_offset_ >= write_offset_ && write_buffer_.empty() && !writing_)
+    {
+        Reset();
+    }
+    else if (read_offset_ != 0)
+    {
+        // Освобождение места на диске под прочитанными данными.
+        fallocate(fd_,
+                  FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                  0,
+                  static_cast<off_t>(read_offset_));
+    }
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+const fs::path &LogSpool::Path() const noexcept
+{
+    return path_;
+}
+
+//------------------------------------------------------------------------------
+bool LogSpool::Empty() const noexcept
+{
+    return pending_ == 0;
+}
+
+//------------------------------------------------------------------------------
+size_t LogSpool::Pending() const noexcept
+{
+    return pending_;
+}
+
+//------------------------------------------------------------------------------
+size_t LogSpool::Size() const noexcept
+{
+    return write_offset_ + writing_size_ + write_buffer_.size() - read_offset_;
+}
+
+//------------------------------------------------------------------------------
+size_t LogSpool::MaxSize() const noexcept
+{
+    return max_size_;
+}
+
+//------------------------------------------------------------------------------
+uint64_t LogSpool::Dropped() const noexcept
+{
+    return dropped_;
+}
+
+//------------------------------------------------------------------------------
+Json::Value LogSpool::ToJSON() const noexcept
+{
+    Json::Value spool{};
+    spool["path"] = path_.string();
+    spool["max_size"] = Json::UInt64{max_size_};
+    spool["size"] = Json::UInt64{Size()};
+    spool["pending"] = Json::UInt64{pending_};
+    spool["spooled"] = Json::UInt64{spooled_};
+    spool["dropped"] = Json::UInt64{dropped_};
+    return spool;
+}
+
+//------------------------------------------------------------------------------
+size_t LogSpool::Parse(string_view data,
+                       deque<LogLine> &lines,
+                       size_t count,
+                       size_t &result,
+                       bool &corrupted) noexcept
+{
+    size_t parsed{0};
+    while (result < count && data.size() >= header_size_)
+    {
+        uint32_t size{0};
+        uint32_t checksum{0};
+        memcpy(&size, data.data(), sizeof(size));
+        memcpy(&checksum, data.data() + sizeof(size), sizeof(checksum));
+        if (data.size() - header_size_ < size)
+        {
+            break;
+        }
+
+        const string_view record{data.substr(header_size_, size)};
+        if (Checksum(record) != checksum)
+        {
+            corrupted = true;
+            break;
+        }
+
+        const auto line{LogLine::Deserialize(record)};
+        if (line != nullptr)
+        {
+            lines.push_back(*line);
+            ++result;
+        }
+        else
+        {
+            ++dropped_;
+        }
+        --pending_;
+
+        data.remove_prefix(header_size_ + size);
+        parsed += header_size_ + size;
+    }
+
+    return parsed;
+}
+
+//------------------------------------------------------------------------------
+uint32_t LogSpool::Checksum(string_view record) noexcept
+{
+    return static_cast<uint32_t>(std::hash<string_view>{}(record));
+}
+
+//------------------------------------------------------------------------------
+size_t LogSpool::Count(string_view data) noexcept
+{
+    size_t count{0};
+    while (data.size() >= header_size_)
+    {
+        uint32_t size{0};
+        memcpy(&size, data.data(), sizeof(size));
+        data.remove_prefix(std::min(data.size(), header_size_ + size));
+        ++count;
+    }
+
+    return count;
+}
+
+//------------------------------------------------------------------------------
+void LogSpool::Reset() noexcept
+{
+    if (ftruncate(fd_, 0) == 0)
+    {
+        write_offset_ = 0;
+        read_offset_ = 0;
+    }
+}
+
+}  // namespace tasp
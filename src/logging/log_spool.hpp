@@ -0,0 +1,336 @@
+/**
+ * @file
+ * @brief Файл временного хранения сообщений при переполнении очереди.
+ */
+#ifndef TASP_LOGGING_LOG_SPOOL_HPP_
+#define TASP_LOGGING_LOG_SPOOL_HPP_
+
+#include <deque>
+#include <experimental/filesystem>
+#include <string>
+
+#include "log_line.hpp"
+
+namespace fs = std::experimental::filesystem;
+
+namespace tasp
+{
+
+/**
+ * @brief Файл временного хранения сообщений при переполнении очереди.
+ *
+ * Сообщения записываются в конец файла в двоичном представлении
+ * (@ref LogLine::Serialize) с префиксом из длины и контрольной суммы и
+ * читаются в порядке записи. Когда все сообщения прочитаны, файл очищается.
+ *
+ * Запись буферизуется в памяти. Заполненный буфер забирается вызывающей
+ * стороной (@ref TakeChunk) вместе с зарезервированным смещением в файле,
+ * записывается без блокировок (@ref WriteChunk) и подтверждается
+ * (@ref Commit). Одновременно записывается не больше одного буфера.
+ * Сообщения, которые еще не записаны в файл, читаются из памяти.
+ *
+ * Все функции, кроме @ref WriteChunk, не потокобезопасные и вызываются под
+ * общим мьютексом.
+ */
+class LogSpool final
+{
+public:
+    /**
+     * @brief Буфер сообщений для записи в файл без блокировок.
+     */
+    struct Chunk
+    {
+        /**
+         * @brief Записи сообщений.
+         */
+        std::string data;
+
+        /**
+         * @brief Зарезервированное смещение в файле.
+         */
+        std::size_t offset{0};
+
+        /**
+         * @brief Количество сообщений.
+         */
+        std::size_t count{0};
+
+        /**
+         * @brief Копия дескриптора файла. -1 - буфер пуст.
+         */
+        int fd{-1};
+
+        /**
+         * @brief Номер открытия файла, для которого зарезервировано смещение.
+         */
+        std::uint64_t generation{0};
+
+        /**
+         * @brief Результат записи.
+         */
+        bool written{false};
+    };
+
+    /**
+     * @brief Конструктор.
+     */
+    LogSpool() noexcept;
+
+    /**
+     * @brief Деструктор. Закрывает и удаляет файл.
+     */
+    ~LogSpool() noexcept;
+
+    /**
+     * @brief Открытие файла.
+     *
+     * Если уже открыт файл с тем же путем, меняется только максимальный
+     * размер. Иначе ранее открытый файл закрывается и удаляется, а содержимое
+     * существующего файла удаляется.
+     *
+     * @param path Путь к файлу
+     * @param max_size Максимальный размер файла в байтах
+     *
+     * @return Результат открытия
+     */
+    bool Open(const fs::path &path, std::size_t max_size) noexcept;
+
+    /**
+     * @brief Закрытие и удаление файла.
+     */
+    void Close() noexcept;
+
+    /**
+     * @brief Добавление сообщения в буфер записи.
+     *
+     * @param line Сообщение
+     *
+     * @return Результат добавления. false - файл не открыт или достигнут
+     * максимальный размер, сообщение отброшено
+     */
+    bool Append(const LogLine &line) noexcept;
+
+    /**
+     * @brief Получение заполненного буфера записи для записи в файл.
+     *
+     * Буфер переносится в chunk, а в файле резервируется место под него.
+     * Пока буфер не подтвержден (@ref Commit), следующий не выдается.
+     *
+     * @param chunk Пустой буфер, в который переносятся сообщения
+     *
+     * @return Нужно ли записать буфер
+     */
+    bool TakeChunk(Chunk &chunk) noexcept;
+
+    /**
+     * @brief Запись буфера в зарезервированное место файла.
+     *
+     * Выполняется без общего мьютекса и использует только данные буфера.
+     *
+     * @param chunk Буфер
+     */
+    static void WriteChunk(Chunk &chunk) noexcept;
+
+    /**
+     * @brief Подтверждение записи буфера.
+     *
+     * После успешной записи сообщения буфера читаются из файла. При ошибке
+     * частично записанные данные отрезаются, а сообщения возвращаются в начало
+     * буфера записи. Если файл был закрыт во время записи, сообщения
+     * считаются отброшенными.
+     *
+     * @param chunk Буфер
+     */
+    void Commit(const Chunk &chunk) noexcept;
+
+    /**
+     * @brief Чтение сообщений из начала файла.
+     *
+     * @param lines Очередь, в конец которой добавляются прочитанные сообщения
+     * @param count Максимальное количество читаемых сообщений
+     *
+     * @return Количество прочитанных сообщений
+     */
+    std::size_t Read(std::deque<LogLine> &lines, std::size_t count) noexcept;
+
+    /**
+     * @brief Запрос пути к открытому файлу.
+     *
+     * @return Путь к файлу или пустой путь, если файл не открыт
+     */
+    [[nodiscard]] const fs::path &Path() const noexcept;
+
+    /**
+     * @brief Проверка наличия непрочитанных сообщений.
+     *
+     * @return Результат проверки
+     */
+    [[nodiscard]] bool Empty() const noexcept;
+
+    /**
+     * @brief Запрос количества непрочитанных сообщений.
+     *
+     * @return Количество сообщений
+     */
+    [[nodiscard]] std::size_t Pending() const noexcept;
+
+    /**
+     * @brief Запрос объема непрочитанных данных.
+     *
+     * @return Размер в байтах
+     */
+    [[nodiscard]] std::size_t Size() const noexcept;
+
+    /**
+     * @brief Запрос максимального объема непрочитанных данных.
+     *
+     * @return Размер в байтах
+     */
+    [[nodiscard]] std::size_t MaxSize() const noexcept;
+
+    /**
+     * @brief Запрос количества отброшенных сообщений.
+     *
+     * @return Количество сообщений
+     */
+    [[nodiscard]] std::uint64_t Dropped() const noexcept;
+
+    /**
+     * @brief Преобразование параметров и счетчиков файла в формат
+     * Json::Value.
+     *
+     * @return Параметры файла
+     */
+    [[nodiscard]] Json::Value ToJSON() const noexcept;
+
+    LogSpool(const LogSpool &) = delete;
+    LogSpool(LogSpool &&) = delete;
+    LogSpool &operator=(const LogSpool &) = delete;
+    LogSpool &operator=(LogSpool &&) = delete;
+
+private:
+    /**
+     * @brief Разбор сообщений из двоичных данных.
+     *
+     * @param data Данные
+     * @param lines Очередь, в конец которой добавляются сообщения
+     * @param count Максимальное количество прочитанных сообщений
+     * @param result Количество прочитанных сообщений (увеличивается)
+     * @param corrupted Обнаружена запись с неверной контрольной суммой
+     *
+     * @return Количество разобранных байт до первой неполной или
+     * поврежденной записи
+     */
+    std::size_t Parse(std::string_view data,
+                      std::deque<LogLine> &lines,
+                      std::size_t count,
+                      std::size_t &result,
+                      bool &corrupted) noexcept;
+
+    /**
+     * @brief Расчет контрольной суммы записи.
+     *
+     * @param record Двоичное представление сообщения
+     *
+     * @return Контрольная сумма
+     */
+    static std::uint32_t Checksum(std::string_view record) noexcept;
+
+    /**
+     * @brief Подсчет количества сообщений в двоичных данных.
+     *
+     * @param data Данные
+     *
+     * @return Количество сообщений
+     */
+    static std::size_t Count(std::string_view data) noexcept;
+
+    /**
+     * @brief Очистка файла после чтения всех сообщений.
+     */
+    void Reset() noexcept;
+
+    /**
+     * @brief Размер буфера записи и чтения.
+     */
+    static constexpr std::size_t buffer_size_{64 * 1024};
+
+    /**
+     * @brief Размер заголовка записи: длина и контрольная сумма.
+     */
+    static constexpr std::size_t header_size_{2 * sizeof(std::uint32_t)};
+
+    /**
+     * @brief Путь к файлу.
+     */
+    fs::path path_;
+
+    /**
+     * @brief Дескриптор файла.
+     */
+    int fd_{-1};
+
+    /**
+     * @brief Максимальный размер файла в байтах.
+     */
+    std::size_t max_size_{0};
+
+    /**
+     * @brief Буфер записи.
+     */
+    std::string write_buffer_;
+
+    /**
+     * @brief Буфер чтения.
+     */
+    std::string read_buffer_;
+
+    /**
+     * @brief Смещение конца записанных в файл данных.
+     */
+    std::size_t write_offset_{0};
+
+    /**
+     * @brief Выполняется ли запись буфера в файл.
+     */
+    bool writing_{false};
+
+    /**
+     * @brief Размер записываемого буфера.
+     */
+    std::size_t writing_size_{0};
+
+    /**
+     * @brief Количество сообщений в записываемом буфере.
+     */
+    std::size_t writing_count_{0};
+
+    /**
+     * @brief Номер открытия файла.
+     */
+    std::uint64_t generation_{0};
+
+    /**
+     * @brief Смещение начала непрочитанных данных.
+     */
+    std::size_t read_offset_{0};
+
+    /**
+     * @brief Количество непрочитанных сообщений.
+     */
+    std::size_t pending_{0};
+
+    /**
+     * @brief Общее количество записанных сообщений.
+     */
+    std::uint64_t spooled_{0};
+
+    /**
+     * @brief Количество отброшенных сообщений.
+     */
+    std::uint64_t dropped_{0};
+};
+
+}  // namespace tasp
+
+#endif  // TASP_LOGGING_LOG_SPOOL_HPP_
@@ -1,15 +1,53 @@
 #include "tasp/logging.hpp"
 
+#include <cstdlib>
+
 #include "logging_impl.hpp"
 
 using std::any;
+using std::at_quick_exit;
 using std::make_unique;
+using std::size_t;
 using std::string;
 using std::string_view;
+using std::uint64_t;
+using std::unique_ptr;
 using std::vector;
+using std::chrono::milliseconds;
 
 namespace tasp
 {
+/*------------------------------------------------------------------------------
+    Bytes
+------------------------------------------------------------------------------*/
+Bytes::Bytes(const void *data, size_t size) noexcept
+: impl_(std::make_shared<const BytesImpl>(data,
+                                          data != nullptr ? size : 0,
+                                          Logging::Instance().BytesLimit()))
+{
+}
+
+//------------------------------------------------------------------------------
+Bytes::Bytes(const Bytes &bytes) noexcept = default;
+
+//------------------------------------------------------------------------------
+Bytes::Bytes(Bytes &&bytes) noexcept = default;
+
+//------------------------------------------------------------------------------
+Bytes::~Bytes() noexcept = default;
+
+//------------------------------------------------------------------------------
+string_view Bytes::Data() const noexcept
+{
+    return impl_ != nullptr ? impl_->Data() : string_view{};
+}
+
+//------------------------------------------------------------------------------
+size_t Bytes::Size() const noexcept
+{
+    return impl_ != nullptr ? impl_->Size() : 0;
+}
+
 /*------------------------------------------------------------------------------
     Logging
 ------------------------------------------------------------------------------*/
@@ -23,6 +61,11 @@ Logging &Logging::Instance() noexcept
 Logging::Logging() noexcept
 : impl_(make_unique<LoggingImpl>())
 {
+    at_quick_exit(
+        []
+        {
+            Instance().Flush();
+        });
 }
 
 //------------------------------------------------------------------------------
@@ -34,10 +77,25 @@ void Logging::Print(Level level,
                     string_view format,
                     const vector<any> &params) noexcept
 {
-    impl_->Print(LogLine(LogLevel(static_cast<LogLevel::Level>(level)),
-                         location,
-                         format,
-                         params));
+    impl_->Print(static_cast<LogLevel::Level>(level), location, format, params);
+}
+
+//------------------------------------------------------------------------------
+size_t Logging::BytesLimit() const noexcept
+{
+    return impl_->BytesLimit();
+}
+
+//------------------------------------------------------------------------------
+void Logging::Start() noexcept
+{
+    impl_->Start();
+}
+
+//------------------------------------------------------------------------------
+void Logging::Stop() noexcept
+{
+    impl_->Stop();
 }
 
 //------------------------------------------------------------------------------
@@ -46,6 +104,77 @@ void Logging::Reload() noexcept
     impl_->Reload();
 }
 
+//------------------------------------------------------------------------------
+void Logging::Reopen() noexcept
+{
+    impl_->Reopen();
+}
+
+//------------------------------------------------------------------------------
+bool Logging::Flush(milliseconds timeout) noexcept
+{
+    return impl_->Flush(timeout);
+}
+
+//------------------------------------------------------------------------------
+void Logging::Emergency(int signum) noexcept
+{
+    impl_->Emergency(signum);
+}
+
+//------------------------------------------------------------------------------
+Json::Value Logging::Statistics() const noexcept
+{
+    return impl_->Statistics();
+}
+
+//------------------------------------------------------------------------------
+HealthReport Logging::Health() const noexcept
+{
+    return impl_->Health();
+}
+
+//------------------------------------------------------------------------------
+unique_ptr<LogSubscription> Logging::Subscribe(Level level,
+                                               string_view source,
+                                               size_t capacity) noexcept
+{
+    auto channel{impl_->Subscribe(
+        static_cast<LogLevel::Level>(level), source, capacity)};
+
+    return make_unique<LogSubscription>(
+        make_unique<LogSubscriptionImpl>(*impl_, std::move(channel)));
+}
+
+/*------------------------------------------------------------------------------
+    LogSubscription
+------------------------------------------------------------------------------*/
+LogSubscription::LogSubscription(unique_ptr<LogSubscriptionImpl> impl) noexcept
+: impl_(std::move(impl))
+{
+}
+
+//------------------------------------------------------------------------------
+LogSubscription::~LogSubscription() noexcept = default;
+
+//------------------------------------------------------------------------------
+bool LogSubscription::Pop(Record &record) noexcept
+{
+    return impl_->Channel().Pop(record);
+}
+
+//------------------------------------------------------------------------------
+bool LogSubscription::Wait(Record &record, milliseconds timeout) noexcept
+{
+    return impl_->Channel().Wait(record, timeout);
+}
+
+//------------------------------------------------------------------------------
+uint64_t LogSubscription::Dropped() const noexcept
+{
+    return impl_->Channel().Dropped();
+}
+
 /*------------------------------------------------------------------------------
     FormatWithLocation
 ------------------------------------------------------------------------------*/
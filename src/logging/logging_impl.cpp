@@ -1,14 +1,35 @@
 #include "logging_impl.hpp"
 
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+#include "../daemon/signal_stack.hpp"
 #include "tasp/config.hpp"
 
+using std::any;
 using std::make_unique;
+using std::pair;
 using std::scoped_lock;
+using std::size_t;
 using std::string;
+using std::string_view;
 using std::thread;
+using std::try_to_lock;
+using std::uint64_t;
 using std::unique_lock;
 using std::vector;
+using std::chrono::duration;
+using std::chrono::milliseconds;
 using std::chrono::seconds;
+using std::chrono::steady_clock;
 
 namespace tasp
 {
@@ -18,37 +39,304 @@ namespace tasp
 LoggingImpl::LoggingImpl() noexcept
 {
     Print(LogLine(LogLevel::Level::Info, "Начало логирования"));
-    thread_ = make_unique<thread>(&LoggingImpl::Worker, this);
 }
 
 //------------------------------------------------------------------------------
 LoggingImpl::~LoggingImpl() noexcept
 {
+    Stop();
+
+    // Сообщения, не выведенные потоком обработки (логирование не
+    // запускалось или сообщения добавлены после остановки), выводятся в
+    // стандартный вывод ошибок: создание логов при завершении программы
+    // невозможно.
+    PrintStderr();
+}
+
+//------------------------------------------------------------------------------
+size_t LoggingImpl::BytesLimit() const noexcept
+{
+    return bytes_limit_;
+}
+
+//------------------------------------------------------------------------------
+void LoggingImpl::Start() noexcept
+{
+    std::call_once(start_flag_,
+                   [this]()
+                   {
+                       thread_ = make_unique<thread>(&LoggingImpl::Worker, this);
+                       started_ = true;
+                   });
+}
+
+//------------------------------------------------------------------------------
+void LoggingImpl::Stop() noexcept
+{
+    // Объект потока не удаляется, т.к. его идентификатор запрашивается
+    // другими потоками без блокировок.
+    const scoped_lock lock{stop_mutex_};
+    if (!started_ || !thread_->joinable())
+    {
+        return;
+    }
+
     ChangeStatus(Status::NeedStop);
 
     thread_->join();
-    thread_.reset(nullptr);
 }
 
 //------------------------------------------------------------------------------
-void LoggingImpl::Print(const LogLine &line) noexcept
+uint64_t LoggingImpl::Print(const LogLine &line) noexcept
 {
-    const scoped_lock lock{mutex_};
-    messages_.push(line);
+    uint64_t sequence{0};
+    bool overflow{false};
+    LogSpool::Chunk chunk{};
+    {
+        const scoped_lock lock{mutex_};
+        const QueueGuard guard{*this};
+        if (!guard.Granted())
+        {
+            return 0;
+        }
+
+        if (!started_ && messages_.size() >= boot_capacity_)
+        {
+            ++boot_dropped_;
+            ++boot_dropped_total_;
+            return ++enqueued_;
+        }
+
+        messages_.push_back(line);
+
+        sequence = ++enqueued_;
+        messages_.back().Stamp(sequence);
+
+        depth_max_ = std::max(depth_max_, sequence - written_);
+
+        if (spool_threshold_ != 0 &&
+            (!spool_.Empty() || messages_.size() > spool_threshold_))
+        {
+            overflow = spool_.Empty();
+            messages_.back().Render();
+            spool_.Append(messages_.back());
+            spool_.TakeChunk(chunk);
+            messages_.pop_back();
+        }
+    }
+
+    if (chunk.fd != -1)
+    {
+        // Заполненный буфер файла временного хранения записывается без
+        // мьютекса очереди в зарезервированное место файла.
+        LogSpool::WriteChunk(chunk);
+
+        const scoped_lock lock{mutex_};
+        spool_.Commit(chunk);
+    }
+
+    if (overflow)
+    {
+        // Поток обработки будится без мьютекса условной переменной, т.к. он
+        // захвачен потоком обработки на время вывода. Пропущенное оповещение
+        // ограничено таймаутом ожидания.
+        flush_ = true;
+        condition_.notify_one();
+    }
+
+    return sequence;
+}
+
+//------------------------------------------------------------------------------
+void LoggingImpl::Print(LogLevel::Level level,
+                        const SourceLocation &location,
+                        string_view format,
+                        const vector<any> &params) noexcept
+{
+    if (level < recorder_level_)
+    {
+        recorder_.Record(level, location, format, params, enqueued_);
+    }
+
+    if (level < min_level_)
+    {
+        return;
+    }
+
+    const uint64_t sequence{
+        Print(LogLine(LogLevel(level), location, format, params))};
+
+    if (level >= durable_level_)
+    {
+        WaitDurable(sequence);
+    }
+}
+
+//------------------------------------------------------------------------------
+void LoggingImpl::WaitDurable(uint64_t sequence) noexcept
+{
+    if (!started_ || std::this_thread::get_id() == thread_->get_id() ||
+        status_ == Status::Stop || durable_timeout_.load().count() == 0)
+    {
+        return;
+    }
+
+    {
+        const scoped_lock condition_lock{condition_mutex_};
+        flush_ = true;
+    }
+    condition_.notify_one();
+
+    unique_lock flushed_lock{flushed_mutex_};
+    flushed_.wait_for(flushed_lock,
+                      durable_timeout_.load(),
+                      [&]()
+                      {
+                          return synced_ >= sequence;
+                      });
 }
 
 //------------------------------------------------------------------------------
 void LoggingImpl::Reload() noexcept
 {
     Print(LogLine(LogLevel::Level::Info, "Перезапуск логирования"));
+    Start();
     ChangeStatus(Status::NeedReload);
 }
 
+//------------------------------------------------------------------------------
+void LoggingImpl::Reopen() noexcept
+{
+    Print(LogLine(LogLevel::Level::Info, "Переоткрытие логов"));
+    Start();
+
+    // Флаг устанавливается до смены статуса: если перезагрузка уже
+    // выполняется, он будет учтен при следующей.
+    reopen_ = true;
+    ChangeStatus(Status::NeedReload);
+}
+
+//------------------------------------------------------------------------------
+bool LoggingImpl::Flush(milliseconds timeout) noexcept
+{
+    // Запуск потока обработки создал бы глобальный конфигурационный файл,
+    // например, при quick_exit до его загрузки, поэтому без запуска
+    // логирования сообщения выводятся в стандартный вывод ошибок.
+    if (!started_)
+    {
+        PrintStderr();
+        return true;
+    }
+
+    uint64_t ticket{0};
+    {
+        const scoped_lock lock{mutex_};
+        ticket = enqueued_;
+    }
+
+    // Каждый вызов получает свой номер запроса выгрузки, чтобы запрос,
+    // сделанный во время вывода, не был сброшен завершением этого вывода.
+    const uint64_t dump{recorder_level_ != LogLevel::Level::Debug
+                            ? ++dump_requested_
+                            : 0};
+    auto done = [&]()
+    {
+        return written_ >= ticket && dump_done_ >= dump;
+    };
+
+    if (done())
+    {
+        return true;
+    }
+
+    // После остановки потока обработки сообщения выводятся в вызывающем
+    // потоке.
+    if (thread_ == nullptr || status_ == Status::Stop ||
+        std::this_thread::get_id() == thread_->get_id())
+    {
+        const unique_lock lock{sinks_mutex_, try_to_lock};
+        if (lock.owns_lock())
+        {
+            PrintQueue();
+        }
+        return done();
+    }
+
+    {
+        const scoped_lock condition_lock{condition_mutex_};
+        flush_ = true;
+    }
+    condition_.notify_one();
+
+    unique_lock flushed_lock{flushed_mutex_};
+    return flushed_.wait_for(flushed_lock, timeout, done);
+}
+
+//------------------------------------------------------------------------------
+void LoggingImpl::Emergency(int signum) noexcept
+{
+    // Мьютексы не захватываются. После установки признака очередь и
+    // выводимая пачка больше не изменяются (см. QueueGuard и ReleaseBatch).
+    frozen_ = true;
+
+    // Пачка, выводимая потоком обработки, выводится целиком: часть ее могла
+    // остаться в буферах логов.
+    const auto *batch{inflight_.load()};
+    if (batch != nullptr)
+    {
+        emergency_.WriteLines(*batch, inflight_rendered_);
+    }
+
+    // Если падение произошло во время изменения очереди, ее содержимое может
+    // быть в неконсистентном состоянии, поэтому она не выводится.
+    if (queue_users_ == 0)
+    {
+        emergency_.WriteLines(messages_, 0);
+    }
+
+    // Невыгруженные отладочные сообщения выводятся перед сообщением о
+    // падении, как при выводе сообщения об ошибке.
+    recorder_.Emergency(recorder_fd_, emergency_);
+
+    emergency_.Crash(signum);
+}
+
 //------------------------------------------------------------------------------
 void LoggingImpl::Worker() noexcept
 {
+    const SignalStack signal_stack{};
+
+    rate_time_ = steady_clock::now();
+
+    CPU_ZERO(&default_affinity_);
+    pthread_getaffinity_np(
+        pthread_self(), sizeof(default_affinity_), &default_affinity_);
+    errno = 0;
+    const int nice{getpriority(PRIO_PROCESS,
+                               static_cast<id_t>(syscall(SYS_gettid)))};
+    default_nice_ = errno == 0 ? nice : 0;
+    nice_ = default_nice_;
+
     ReloadImpl();
 
+    {
+        // Сообщения, накопленные до запуска, выводятся сразу после открытия
+        // логов.
+        const scoped_lock lock{mutex_};
+        const QueueGuard guard{*this};
+        if (guard.Granted() && boot_dropped_ != 0)
+        {
+            written_ += boot_dropped_;
+            messages_.emplace_back(
+                LogLevel::Level::Warning,
+                "Отброшены сообщения до запуска логирования: " +
+                    std::to_string(boot_dropped_));
+            messages_.back().Stamp(++enqueued_);
+            boot_dropped_ = 0;
+        }
+        flush_ = true;
+    }
+
     while (status_ != Status::NeedStop)
     {
         unique_lock condition_lock{condition_mutex_};
@@ -56,9 +344,10 @@ void LoggingImpl::Worker() noexcept
                             timeout_,
                             [&]()
                             {
-                                return status_ != Status::Work;
+                                return status_ != Status::Work || flush_;
                             });
 
+        flush_ = false;
         PrintImpl();
 
         if (status_ == Status::NeedReload)
@@ -71,6 +360,14 @@ void LoggingImpl::Worker() noexcept
 
     PrintImpl();
 
+    {
+        const scoped_lock lock{sinks_mutex_};
+        for (const auto &sink : sinks_)
+        {
+            sink->Finish();
+        }
+    }
+
     status_ = Status::Stop;
 }
 
@@ -88,44 +385,852 @@ void LoggingImpl::ChangeStatus(LoggingImpl::Status status) noexcept
 //------------------------------------------------------------------------------
 void LoggingImpl::PrintImpl() noexcept
 {
+    const scoped_lock lock{sinks_mutex_};
+    PrintQueue();
+    SyncSinks();
+    UpdateRate();
+}
+
+//------------------------------------------------------------------------------
+void LoggingImpl::SyncSinks() noexcept
+{
+    // Список логов меняется только в потоке обработки, поэтому синхронизация
+    // выполняется без мьютекса очереди и не блокирует добавление сообщений.
+    // Мьютекс sinks_mutex_ захвачен в PrintImpl.
+    const uint64_t written{written_};
+
+    for (const auto &sink : sinks_)
+    {
+        sink->Sync();
+    }
+
+    {
+        const scoped_lock flushed_lock{flushed_mutex_};
+        synced_ = written;
+    }
+    flushed_.notify_all();
+}
+
+//------------------------------------------------------------------------------
+Json::Value LoggingImpl::Statistics() const noexcept
+{
+    Json::Value statistics{};
+    statistics["sinks"] = Json::objectValue;
+
     const scoped_lock lock{mutex_};
-    while (!messages_.empty())
+    for (const auto &sink : sinks_)
+    {
+        Json::Value sink_statistics{sink->Statistics()};
+        if (sink_statistics.isNull())
+        {
+            sink_statistics = Json::objectValue;
+        }
+        sink_statistics["write"] = sink->WriteLatency().ToJSON();
+        statistics["sinks"][sink->ConfigPath()] = sink_statistics;
+    }
+
+    const auto [depth, capacity]{QueueUsage()};
+    Json::Value queue{};
+    queue["depth"] = Json::UInt64{depth};
+    queue["depth_max"] = Json::UInt64{depth_max_};
+    queue["capacity"] = Json::UInt64{capacity};
+    queue["enqueued"] = Json::UInt64{enqueued_};
+    queue["written"] = Json::UInt64{written_};
+    queue["enqueue_rate"] = enqueue_rate_.load();
+    queue["enqueue_rate_max"] = enqueue_rate_max_.load();
+
+    const uint64_t batches{batch_statistics_.count};
+    Json::Value batch{};
+    batch["count"] = Json::UInt64{batches};
+    batch["batch_avg"] =
+        Json::UInt64{batches != 0 ? batch_statistics_.lines / batches : 0};
+    batch["batch_max"] = Json::UInt64{batch_statistics_.max_lines};
+    queue["batch"] = batch;
+
+    uint64_t subscribers_dropped{0};
+    for (const auto &channel : *std::atomic_load(&channels_))
+    {
+        subscribers_dropped += channel->Dropped();
+    }
+
+    Json::Value dropped{};
+    dropped["boot"] = Json::UInt64{boot_dropped_total_};
+    dropped["spool"] = Json::UInt64{spool_.Dropped()};
+    dropped["subscribers"] = Json::UInt64{subscribers_dropped};
+    queue["dropped"] = dropped;
+
+    statistics["queue"] = queue;
+
+    if (spool_threshold_ != 0)
+    {
+        statistics["spool"] = spool_.ToJSON();
+        statistics["spool"]["threshold"] = Json::UInt64{spool_threshold_};
+    }
+
+    statistics["subscribers"] = Json::arrayValue;
+    for (const auto &channel : *std::atomic_load(&channels_))
+    {
+        statistics["subscribers"].append(channel->ToJSON());
+    }
+
+    return statistics;
+}
+
+//------------------------------------------------------------------------------
+HealthReport LoggingImpl::Health() const noexcept
+{
+    const string name{"logging"};
+
+    if (status_ == Status::Stop)
+    {
+        return HealthReport(name,
+                            HealthReport::Status::Error,
+                            "Поток обработки сообщений остановлен");
+    }
+
+    size_t depth{0};
+    size_t capacity{0};
+    size_t spool_size{0};
+    size_t spool_max_size{0};
+    uint64_t dropped{0};
+    {
+        const scoped_lock lock{mutex_};
+        const auto usage{QueueUsage()};
+        depth = usage.first;
+        capacity = usage.second;
+        if (spool_threshold_ != 0)
+        {
+            spool_size = spool_.Size();
+            spool_max_size = spool_.MaxSize();
+        }
+        dropped = Dropped();
+    }
+
+    auto status{HealthReport::Status::Ok};
+    string message{"Сообщений в очереди: " + std::to_string(depth)};
+    if (capacity != 0)
+    {
+        message += " из " + std::to_string(capacity);
+    }
+    message += ", добавляется в секунду: " +
+               std::to_string(static_cast<uint64_t>(enqueue_rate_.load()));
+
+    const size_t hundred{100};
+    if (!started_)
+    {
+        status = HealthReport::Status::Warning;
+        message += "; логирование не запущено";
+    }
+    if (capacity != 0 && depth * hundred > capacity * health_usage_)
+    {
+        status = HealthReport::Status::Warning;
+        message += "; очередь заполнена на " +
+                   std::to_string(depth * hundred / capacity) + "%";
+    }
+    if (spool_max_size != 0 &&
+        spool_size * hundred > spool_max_size * health_usage_)
+    {
+        status = HealthReport::Status::Warning;
+        message += "; файл временного хранения заполнен на " +
+                   std::to_string(spool_size * hundred / spool_max_size) + "%";
+    }
+
+    const uint64_t reported{health_dropped_.exchange(dropped)};
+    if (dropped > reported)
     {
-        const auto &message{messages_.front()};
+        status = HealthReport::Status::Error;
+        message += "; отброшено сообщений с предыдущей проверки: " +
+                   std::to_string(dropped - reported);
+    }
+
+    return HealthReport(name, status, message);
+}
+
+//------------------------------------------------------------------------------
+pair<size_t, size_t> LoggingImpl::QueueUsage() const noexcept
+{
+    if (!started_)
+    {
+        return {messages_.size(), boot_capacity_};
+    }
+
+    if (spool_threshold_ != 0)
+    {
+        return {messages_.size(), spool_threshold_};
+    }
+
+    const uint64_t enqueued{enqueued_};
+    const uint64_t written{written_};
+    return {enqueued > written ? enqueued - written : 0, health_capacity_};
+}
+
+//------------------------------------------------------------------------------
+uint64_t LoggingImpl::Dropped() const noexcept
+{
+    return boot_dropped_total_ + spool_.Dropped();
+}
+
+//------------------------------------------------------------------------------
+void LoggingImpl::UpdateRate() noexcept
+{
+    const auto now{steady_clock::now()};
+    const duration<double> elapsed{now - rate_time_};
+    if (elapsed < rate_interval_)
+    {
+        return;
+    }
+
+    const uint64_t enqueued{enqueued_};
+    const double rate{static_cast<double>(enqueued - rate_enqueued_) /
+                      elapsed.count()};
+    enqueue_rate_ = rate;
+    if (rate > enqueue_rate_max_)
+    {
+        enqueue_rate_max_ = rate;
+    }
+
+    rate_time_ = now;
+    rate_enqueued_ = enqueued;
+}
+
+//------------------------------------------------------------------------------
+void LoggingImpl::PrintQueue() noexcept
+{
+    const uint64_t dump_requested{dump_requested_};
+    const bool dump{dump_requested != dump_done_};
+    const auto channels{std::atomic_load(&channels_)};
+    const uint64_t limit{enqueued_};
+
+    // Вывод ограничен сообщениями, добавленными до вызова функции, чтобы
+    // постоянный поток новых сообщений не откладывал синхронизацию и
+    // перезагрузку логов.
+    uint64_t count{0};
+    std::deque<LogLine> batch{};
+    while (TakeBatch(batch))
+    {
+        // Пачка публикуется для аварийного вывода до формирования сообщений:
+        // падение при формировании не должно терять пачку, уже изъятую из
+        // очереди. Несформированные сообщения выводятся аварийно по формату.
+        inflight_rendered_ = 0;
+        inflight_ = &batch;
+        for (auto &message : batch)
+        {
+            message.Render();
+            ++inflight_rendered_;
+        }
+
+        for (const auto &message : batch)
+        {
+            if (message.Level() >= LogLevel::Level::Error)
+            {
+                DumpRecorder(message.Sequence());
+            }
+
+            for (const auto &sink : sinks_)
+            {
+                sink->Print(message);
+            }
+            for (const auto &channel : *channels)
+            {
+                if (channel->Match(message))
+                {
+                    channel->Push(message);
+                }
+            }
+        }
+
+        for (const auto &channel : *channels)
+        {
+            channel->Notify();
+        }
+
+        // Логи сбрасываются после каждой пачки, чтобы при падении в их
+        // буферах оставались только сообщения опубликованной пачки.
+        for (const auto &sink : sinks_)
+        {
+            sink->Flush();
+        }
+
+        count += batch.size();
+        const uint64_t last{batch.back().Sequence()};
+        ReleaseBatch();
+        batch.clear();
+        if (last >= limit)
+        {
+            break;
+        }
+    }
+
+    if (dump)
+    {
+        DumpRecorder(std::numeric_limits<uint64_t>::max());
         for (const auto &sink : sinks_)
         {
-            sink->Print(message);
+            sink->Flush();
         }
-        messages_.pop();
+    }
+
+    if (count != 0)
+    {
+        auto &stats{batch_statistics_};
+        stats.count = stats.count + 1;
+        stats.lines = stats.lines + count;
+        if (count > stats.max_lines)
+        {
+            stats.max_lines = count;
+        }
+    }
+
+    if (count != 0 || dump)
+    {
+        const scoped_lock flushed_lock{flushed_mutex_};
+        written_ += count;
+        dump_done_ = dump_requested;
+    }
+    flushed_.notify_all();
+}
+
+//------------------------------------------------------------------------------
+void LoggingImpl::PrintStderr() noexcept
+{
+    const scoped_lock lock{mutex_};
+    const QueueGuard guard{*this};
+    if (!guard.Granted())
+    {
+        return;
+    }
+
+    for (auto &message : messages_)
+    {
+        message.Render();
+        EmergencyWriter::WriteLine(STDERR_FILENO, message);
+    }
+
+    written_ += messages_.size();
+    messages_.clear();
+}
+
+//------------------------------------------------------------------------------
+bool LoggingImpl::TakeBatch(std::deque<LogLine> &batch) noexcept
+{
+    const scoped_lock lock{mutex_};
+    const QueueGuard guard{*this};
+    if (!guard.Granted())
+    {
+        return false;
+    }
+
+    if (messages_.empty())
+    {
+        spool_.Read(messages_, std::max(spool_threshold_, size_t{1}));
+    }
+
+    const uint64_t dropped{spool_.Dropped()};
+    if (spool_.Empty() && dropped != spool_reported_)
+    {
+        // Отброшенные сообщения считаются выведенными, чтобы не задерживать
+        // ожидающих в функции Flush.
+        const uint64_t count{dropped - spool_reported_};
+        spool_reported_ = dropped;
+        written_ += count;
+
+        messages_.emplace_back(
+            LogLevel::Level::Warning,
+            "Отброшены сообщения при переполнении файла временного хранения: " +
+                std::to_string(count));
+        messages_.back().Stamp(++enqueued_);
+    }
+
+    if (!spool_.Empty())
+    {
+        // Следующий вывод начинается без ожидания таймаута, пока файл
+        // временного хранения не будет прочитан.
+        flush_ = true;
+    }
+
+    batch.swap(messages_);
+
+    return !batch.empty();
+}
+
+//------------------------------------------------------------------------------
+void LoggingImpl::ReleaseBatch() noexcept
+{
+    inflight_ = nullptr;
+
+    // Аварийный вывод, начавшийся до снятия публикации, может читать пачку,
+    // поэтому она не изменяется до завершения программы.
+    while (frozen_)
+    {
+        std::this_thread::sleep_for(seconds{1});
+    }
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<LogChannel> LoggingImpl::Subscribe(LogLevel::Level level,
+                                                   string_view source,
+                                                   size_t capacity) noexcept
+{
+    auto channel{std::make_shared<LogChannel>(level, source, capacity)};
+
+    {
+        const scoped_lock lock{channels_mutex_};
+        auto channels{std::make_shared<ChannelList>(*std::atomic_load(&channels_))};
+        channels->push_back(channel);
+        std::atomic_store(&channels_,
+                          std::shared_ptr<const ChannelList>{channels});
+    }
+
+    UpdateMinLevel();
+
+    return channel;
+}
+
+//------------------------------------------------------------------------------
+void LoggingImpl::Unsubscribe(const LogChannel *channel) noexcept
+{
+    {
+        const scoped_lock lock{channels_mutex_};
+        auto channels{std::make_shared<ChannelList>(*std::atomic_load(&channels_))};
+        channels->erase(std::remove_if(channels->begin(),
+                                       channels->end(),
+                                       [channel](const auto &element)
+                                       {
+                                           return element.get() == channel;
+                                       }),
+                        channels->end());
+        std::atomic_store(&channels_,
+                          std::shared_ptr<const ChannelList>{channels});
+    }
+
+    UpdateMinLevel();
+}
+
+//------------------------------------------------------------------------------
+void LoggingImpl::UpdateMinLevel() noexcept
+{
+    const scoped_lock lock{channels_mutex_};
+
+    auto min_level{sinks_level_.load()};
+    for (const auto &channel : *std::atomic_load(&channels_))
+    {
+        min_level = std::min(min_level, channel->Level());
+    }
+    min_level_ = min_level;
+}
+
+//------------------------------------------------------------------------------
+void LoggingImpl::DumpRecorder(uint64_t limit) noexcept
+{
+    if (recorder_sink_ == nullptr)
+    {
+        return;
+    }
+
+    const size_t count{recorder_.Dump(
+        [this](const LogLine &line)
+        {
+            recorder_sink_->PrintUnfiltered(line);
+        },
+        limit)};
+
+    if (count != 0)
+    {
+        recorder_sink_->PrintUnfiltered(LogLine(
+            LogLevel::Level::Info,
+            "Выведены последние отладочные сообщения: " + std::to_string(count)));
     }
 }
 
 //------------------------------------------------------------------------------
 void LoggingImpl::ReloadImpl() noexcept
 {
-    sinks_.clear();
+    recorder_fd_ = -1;
+    recorder_sink_ = nullptr;
 
     auto &conf{ConfigGlobal::Instance()};
 
     const seconds default_timeout{5};
     timeout_ = conf.Get("logging.timeout", default_timeout);
 
+    const size_t default_bytes_limit{256};
+    bytes_limit_ = conf.Get("logging.bytes.max_size", default_bytes_limit);
+
+    const size_t default_health_capacity{10000};
+    health_capacity_ =
+        conf.Get("logging.health.capacity", default_health_capacity);
+
     const string sinks_path{"logging.sinks."};
-    auto types{conf.Get<vector<string>>(sinks_path, {"file"})};
-    for (const auto &type : types)
+    ReloadSinks(sinks_path);
+
+    durable_timeout_ =
+        milliseconds{conf.Get("logging.durable_timeout", 5000U)};
+
+    // Вызов логирования ожидает синхронизации, только если сообщение будет
+    // выведено хотя бы в один лог с групповой синхронизацией.
+    auto durable_level{LogLevel::Level::None};
+    for (const auto &sink : sinks_)
+    {
+        durable_level = std::min(
+            durable_level, std::max(sink->DurableLevel(), sink->Level().Get()));
+
+        const milliseconds interval{sink->SyncInterval()};
+        if (interval.count() != 0)
+        {
+            timeout_ = std::min(timeout_, interval);
+        }
+    }
+    durable_level_ = durable_level;
+
+    auto min_level{LogLevel::Level::None};
+    for (const auto &sink : sinks_)
+    {
+        min_level = std::min(min_level, sink->Level().Get());
+    }
+    sinks_level_ = min_level;
+    UpdateMinLevel();
+
+    vector<pair<int, LogLevel::Level>> descriptors{};
+    for (const auto &sink : sinks_)
     {
-        auto enable = conf.Get(sinks_path + type + ".enable", true);
-        if (enable)
+        if (sink->Descriptor() != -1)
         {
-            auto log{factory_.Create(type, sinks_path + type)};
-            if (log != nullptr)
+            descriptors.emplace_back(sink->Descriptor(), sink->Level().Get());
+        }
+    }
+    emergency_.SetDescriptors(descriptors);
+
+    const auto recorder_size{conf.Get("logging.recorder.size", size_t{0})};
+    const auto recorder_type{conf.Get<string>("logging.recorder.sink", "file")};
+    for (const auto &sink : sinks_)
+    {
+        if (recorder_size != 0 && sink->ConfigPath() == sinks_path + recorder_type)
+        {
+            recorder_sink_ = sink.get();
+        }
+    }
+
+    recorder_.Resize(recorder_sink_ != nullptr ? recorder_size : 0);
+    if (recorder_sink_ != nullptr)
+    {
+        recorder_fd_ = recorder_sink_->Descriptor();
+    }
+    recorder_level_ = recorder_sink_ != nullptr ? recorder_sink_->Level().Get()
+                                                : LogLevel::Level::Debug;
+
+    ReloadSpool();
+    ReloadWorker();
+
+    ChangeStatus(Status::Work);
+}
+
+//------------------------------------------------------------------------------
+void LoggingImpl::ReloadWorker() noexcept
+{
+    auto &conf{ConfigGlobal::Instance()};
+
+    // Название потока в Linux ограничено 15 символами.
+    const size_t name_size{15};
+    const auto name{conf.Get<string>("logging.worker.name", "tasp-log")};
+    pthread_setname_np(pthread_self(), name.substr(0, name_size).c_str());
+
+    cpu_set_t affinity{default_affinity_};
+    const auto cpus{conf.Get<vector<int>>("logging.worker.cpu_affinity")};
+    if (!cpus.empty())
+    {
+        CPU_ZERO(&affinity);
+        for (const int cpu : cpus)
+        {
+            if (cpu < 0 || cpu >= CPU_SETSIZE)
             {
-                sinks_.push_back(std::move(log));
+                Print(LogLine(LogLevel::Level::Error,
+                              "Недопустимый номер ядра процессора для потока "
+                              "обработки логов: " +
+                                  std::to_string(cpu)));
+                continue;
             }
+            CPU_SET(static_cast<size_t>(cpu), &affinity);
         }
     }
 
-    ChangeStatus(Status::Work);
+    if (CPU_COUNT(&affinity) != 0)
+    {
+        const int error{
+            pthread_setaffinity_np(pthread_self(), sizeof(affinity), &affinity)};
+        if (error != 0)
+        {
+            Print(LogLine(LogLevel::Level::Error,
+                          "Не удалось привязать поток обработки логов к ядрам "
+                          "процессора: " +
+                              string{std::strerror(error)}));
+        }
+    }
+
+    // Приоритет меняется только при изменении параметра, чтобы неудачная
+    // попытка не повторялась при каждой перезагрузке.
+    const int nice{conf.Get("logging.worker.nice", default_nice_)};
+    if (nice == nice_)
+    {
+        return;
+    }
+    nice_ = nice;
+
+    // В Linux приоритет nice задается для отдельного потока по его
+    // идентификатору.
+    const auto thread_id{static_cast<id_t>(syscall(SYS_gettid))};
+    errno = 0;
+    const int current{getpriority(PRIO_PROCESS, thread_id)};
+    if ((errno == 0 && current == nice) ||
+        setpriority(PRIO_PROCESS, thread_id, nice) != -1)
+    {
+        return;
+    }
+
+    // Без CAP_SYS_NICE значение nice нельзя уменьшить, в том числе вернуть
+    // исходное после увеличения: об этом предупреждается однократно.
+    const int error{errno};
+    if (nice == default_nice_ && (error == EACCES || error == EPERM))
+    {
+        if (!nice_warned_)
+        {
+            nice_warned_ = true;
+            Print(LogLine(LogLevel::Level::Warning,
+                          "Не удалось вернуть исходный приоритет потока "
+                          "обработки логов: " +
+                              string{std::strerror(error)}));
+        }
+        return;
+    }
+
+    Print(LogLine(LogLevel::Level::Error,
+                  "Не удалось изменить приоритет потока обработки логов: " +
+                      string{std::strerror(error)}));
+}
+
+//------------------------------------------------------------------------------
+void LoggingImpl::ReloadSinks(const string &sinks_path) noexcept
+{
+    auto &conf{ConfigGlobal::Instance()};
+
+    // При переоткрытии ни один лог не считается неизмененным.
+    if (reopen_.exchange(false))
+    {
+        fingerprints_.clear();
+    }
+
+    vector<pair<string, string>> enabled{};
+    std::unordered_map<string, string> fingerprints{};
+    for (const auto &type : conf.Get<vector<string>>(sinks_path, {"file"}))
+    {
+        const string path{sinks_path + type};
+        if (conf.Get(path + ".enable", true) && fingerprints.count(path) == 0)
+        {
+            enabled.emplace_back(type, path);
+            fingerprints[path] = SinkFactory::Fingerprint(type, path);
+        }
+    }
+
+    // Логи меняются под мьютексом очереди, т.к. читаются из других потоков
+    // (статистика, аварийный вывод). Создание и удаление логов выполняется
+    // без мьютекса: при этом возможен вывод сообщений в очередь. Логи с
+    // неизменными параметрами остаются открытыми.
+    vector<std::unique_ptr<Sink>> removed{};
+    {
+        const scoped_lock lock{mutex_};
+        auto kept{std::stable_partition(
+            sinks_.begin(),
+            sinks_.end(),
+            [&](const auto &sink)
+            {
+                const auto fingerprint{fingerprints.find(sink->ConfigPath())};
+                const auto current{fingerprints_.find(sink->ConfigPath())};
+                return fingerprint != fingerprints.end() &&
+                       current != fingerprints_.end() &&
+                       fingerprint->second == current->second;
+            })};
+        std::move(kept, sinks_.end(), std::back_inserter(removed));
+        sinks_.erase(kept, sinks_.end());
+    }
+
+    // Дескрипторы удаляемых логов исключаются из аварийного вывода до их
+    // закрытия. Старые логи удаляются до создания новых, т.к. новый лог
+    // может использовать те же ресурсы (например, разделяемую память).
+    vector<pair<int, LogLevel::Level>> descriptors{};
+    for (const auto &sink : sinks_)
+    {
+        if (sink->Descriptor() != -1)
+        {
+            descriptors.emplace_back(sink->Descriptor(), sink->Level().Get());
+        }
+    }
+    emergency_.SetDescriptors(descriptors);
+    removed.clear();
+
+    std::unordered_map<string, std::unique_ptr<Sink>> created{};
+    for (const auto &[type, path] : enabled)
+    {
+        const bool exists{std::any_of(sinks_.begin(),
+                                      sinks_.end(),
+                                      [&path = path](const auto &sink)
+                                      {
+                                          return sink->ConfigPath() == path;
+                                      })};
+        if (!exists)
+        {
+            created[path] = factory_.Create(type, path);
+        }
+    }
+
+    vector<std::unique_ptr<Sink>> sinks{};
+    {
+        const scoped_lock lock{mutex_};
+        for (const auto &[type, path] : enabled)
+        {
+            auto current{std::find_if(sinks_.begin(),
+                                      sinks_.end(),
+                                      [&path = path](const auto &sink)
+                                      {
+                                          return sink != nullptr &&
+                                                 sink->ConfigPath() == path;
+                                      })};
+            if (current != sinks_.end())
+            {
+                sinks.push_back(std::move(*current));
+            }
+            else if (created[path] != nullptr)
+            {
+                sinks.push_back(std::move(created[path]));
+            }
+        }
+        sinks_.swap(sinks);
+    }
+
+    fingerprints_.swap(fingerprints);
+}
+
+//------------------------------------------------------------------------------
+void LoggingImpl::ReloadSpool() noexcept
+{
+    auto &conf{ConfigGlobal::Instance()};
+
+    const auto threshold{conf.Get("logging.spool.threshold", size_t{0})};
+    const size_t megabyte{1024 * 1024};
+    const size_t max_size{conf.Get("logging.spool.max_size", size_t{64}) *
+                          megabyte};
+
+    fs::path path{conf.Get<fs::path>("logging.spool.path")};
+    if (path.empty())
+    {
+        path = conf.Get<fs::path>("program.path");
+        path /= "log";
+        path /= conf.Get<string>("program.name") + ".spool";
+    }
+
+    std::error_code error{};
+    if (threshold != 0 && !fs::exists(path.parent_path(), error))
+    {
+        fs::create_directories(path.parent_path(), error);
+    }
+
+    bool opened{true};
+    {
+        const scoped_lock lock{mutex_};
+        const QueueGuard guard{*this};
+
+        if (guard.Granted() && (threshold == 0 || path != spool_.Path()))
+        {
+            // Непрочитанные сообщения переносятся в очередь до закрытия
+            // файла, т.к. они старше всех последующих.
+            spool_.Read(messages_, std::numeric_limits<size_t>::max());
+            spool_.Close();
+        }
+
+        spool_threshold_ = 0;
+        if (threshold != 0)
+        {
+            opened = spool_.Open(path, max_size);
+            spool_threshold_ = opened ? threshold : 0;
+        }
+    }
+
+    if (!opened)
+    {
+        Print(LogLine(LogLevel::Level::Error,
+                      "Не удалось открыть файл временного хранения сообщений " +
+                          path.string()));
+    }
+}
+
+/*------------------------------------------------------------------------------
+    LoggingImpl::QueueGuard
+------------------------------------------------------------------------------*/
+LoggingImpl::QueueGuard::QueueGuard(LoggingImpl &logging) noexcept
+: users_(logging.queue_users_)
+{
+    // Счетчик увеличивается до проверки признака: аварийный вывод
+    // устанавливает признак до проверки счетчика, поэтому хотя бы одна из
+    // сторон видит изменение другой.
+    ++users_;
+    granted_ = !logging.frozen_;
+}
+
+//------------------------------------------------------------------------------
+LoggingImpl::QueueGuard::~QueueGuard() noexcept
+{
+    --users_;
+}
+
+//------------------------------------------------------------------------------
+bool LoggingImpl::QueueGuard::Granted() const noexcept
+{
+    return granted_;
+}
+
+/*------------------------------------------------------------------------------
+    BytesImpl
+------------------------------------------------------------------------------*/
+BytesImpl::BytesImpl(const void *data, size_t size, size_t limit) noexcept
+: data_(static_cast<const char *>(data), std::min(size, limit))
+, size_(size)
+{
+}
+
+//------------------------------------------------------------------------------
+BytesImpl::~BytesImpl() noexcept = default;
+
+//------------------------------------------------------------------------------
+string_view BytesImpl::Data() const noexcept
+{
+    return data_;
+}
+
+//------------------------------------------------------------------------------
+size_t BytesImpl::Size() const noexcept
+{
+    return size_;
+}
+
+/*------------------------------------------------------------------------------
+    LogSubscriptionImpl
+------------------------------------------------------------------------------*/
+LogSubscriptionImpl::LogSubscriptionImpl(
+    LoggingImpl &logging,
+    std::shared_ptr<LogChannel> channel) noexcept
+: logging_(logging)
+, channel_(std::move(channel))
+{
+}
+
+//------------------------------------------------------------------------------
+LogSubscriptionImpl::~LogSubscriptionImpl() noexcept
+{
+    logging_.Unsubscribe(channel_.get());
+}
+
+//------------------------------------------------------------------------------
+LogChannel &LogSubscriptionImpl::Channel() const noexcept
+{
+    return *channel_;
 }
 
 /*------------------------------------------------------------------------------
@@ -5,14 +5,23 @@
 #ifndef TASP_LOGGING_LOGGING_IMPL_HPP_
 #define TASP_LOGGING_LOGGING_IMPL_HPP_
 
+#include <sched.h>
+
 #include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <mutex>
-#include <queue>
 #include <thread>
+#include <unordered_map>
+#include <utility>
 
+#include "emergency_writer.hpp"
+#include "flight_recorder.hpp"
+#include "log_channel.hpp"
 #include "log_line.hpp"
+#include "log_spool.hpp"
 #include "sinks/sink.hpp"
+#include "tasp/health.hpp"
 
 namespace tasp
 {
@@ -34,18 +43,77 @@ public:
 
     /**
      * @brief Деструктор.
+     *
+     * Если логирование не было запущено, накопленные сообщения выводятся в
+     * стандартный вывод ошибок.
      */
     ~LoggingImpl() noexcept;
 
+    /**
+     * @brief Запрос максимального размера двоичных данных, копируемых в
+     * сообщение.
+     *
+     * @return Размер в байтах
+     */
+    [[nodiscard]] std::size_t BytesLimit() const noexcept;
+
+    /**
+     * @brief Запуск потока обработки сообщений.
+     *
+     * Повторные вызовы игнорируются.
+     */
+    void Start() noexcept;
+
+    /**
+     * @brief Вывод накопленных сообщений и завершение потока обработки.
+     *
+     * Повторные вызовы игнорируются.
+     */
+    void Stop() noexcept;
+
     /**
      * @brief Вывод сообщения в логи.
      *
      * Функция только добавляет сообщение в очередь. Сам вывод сообщения
      * происходит в потоке обработки и реализована в функции @ref PrintImpl
      *
+     * При добавлении сообщению присваивается порядковый номер и монотонное
+     * время.
+     *
+     * До запуска логирования в очереди хранится не более @ref boot_capacity_
+     * сообщений, остальные отбрасываются.
+     *
+     * Если в очереди больше сообщений, чем порог logging.spool.threshold, или
+     * в файле временного хранения есть непрочитанные сообщения, сообщение
+     * записывается в этот файл, чтобы сохранить порядок вывода.
+     *
      * @param line Данные для вывода
+     *
+     * @return Порядковый номер сообщения
      */
-    void Print(const LogLine &line) noexcept;
+    std::uint64_t Print(const LogLine &line) noexcept;
+
+    /**
+     * @brief Вывод сообщения в логи с отложенным форматированием.
+     *
+     * Если уровень сообщения ниже уровня всех открытых логов, сообщение не
+     * форматируется. Если уровень сообщения ниже уровня лога бортового
+     * самописца, сообщение сохраняется в бортовой самописец.
+     *
+     * Если уровень сообщения не ниже уровня синхронизации одного из логов
+     * (режим durability: group), функция ожидает синхронизации пачки с этим
+     * сообщением с устройством хранения.
+     *
+     * @param level Уровень сообщения
+     * @param location Информация о месте вызова функции логирования
+     * @param format Формат сообщения для вывода с местами для вставки
+     * параметров
+     * @param params Параметры для добавления в формат
+     */
+    void Print(LogLevel::Level level,
+               const SourceLocation &location,
+               std::string_view format,
+               const std::vector<std::any> &params) noexcept;
 
     /**
      * @brief Перезагрузка логирования.
@@ -59,6 +127,88 @@ public:
      */
     void Reload() noexcept;
 
+    /**
+     * @brief Переоткрытие логов.
+     *
+     * Выполняет перезагрузку как @ref Reload, но логи с неизмененными
+     * параметрами также создаются заново.
+     */
+    void Reopen() noexcept;
+
+    /**
+     * @brief Принудительный вывод накопленных сообщений в логи.
+     *
+     * Функция сообщает потоку обработки о необходимости вывода сообщений и
+     * ожидает, пока не будут выведены все сообщения, добавленные в очередь до
+     * вызова функции.
+     *
+     * При вызове из потока обработки (например, из обработчика сигнала)
+     * сообщения выводятся сразу, если очередь не заблокирована.
+     *
+     * Перед выводом сообщений выгружается бортовой самописец.
+     *
+     * @param timeout Максимальное время ожидания
+     *
+     * @return Все ли сообщения были выведены за время ожидания
+     */
+    bool Flush(std::chrono::milliseconds timeout) noexcept;
+
+    /**
+     * @brief Аварийный вывод при падении программы.
+     *
+     * Вызывается из обработчика сигнала и использует только async-signal-safe
+     * функции, мьютексы не захватываются. Пачка сообщений, выводимая потоком
+     * обработки, и сообщения из очереди (если она не изменяется в момент
+     * падения) записываются напрямую в дескрипторы логов, поддерживающих
+     * аварийный вывод. Затем выводится сообщение о падении и стек вызовов.
+     * После вызова сообщения больше не добавляются в очередь.
+     *
+     * Бортовой самописец и файл временного хранения при аварийном выводе не
+     * выгружаются, т.к. требуют форматирования и разбора сообщений.
+     *
+     * @param signum Номер сигнала
+     */
+    void Emergency(int signum) noexcept;
+
+    /**
+     * @brief Запрос статистики работы логов.
+     *
+     * @return Статистика в формате Json::Value
+     */
+    [[nodiscard]] Json::Value Statistics() const noexcept;
+
+    /**
+     * @brief Запрос состояния логирования.
+     *
+     * Статус Warning - логирование не запущено, очередь или файл временного
+     * хранения заполнены больше чем на @ref health_usage_ процентов. Статус
+     * Error - после предыдущего запроса были отброшены сообщения (@ref
+     * Dropped) или поток обработки остановлен.
+     *
+     * @return Отчет о состоянии
+     */
+    [[nodiscard]] HealthReport Health() const noexcept;
+
+    /**
+     * @brief Подписка на сообщения лога.
+     *
+     * @param level Минимальный уровень передаваемых сообщений
+     * @param source Начало названия файла передаваемых сообщений
+     * @param capacity Максимальное количество сообщений в буфере подписчика
+     *
+     * @return Канал передачи сообщений подписчику
+     */
+    std::shared_ptr<LogChannel> Subscribe(LogLevel::Level level,
+                                          std::string_view source,
+                                          std::size_t capacity) noexcept;
+
+    /**
+     * @brief Отмена подписки на сообщения лога.
+     *
+     * @param channel Канал передачи сообщений подписчику
+     */
+    void Unsubscribe(const LogChannel *channel) noexcept;
+
     LoggingImpl(const LoggingImpl &) = delete;
     LoggingImpl(LoggingImpl &&) = delete;
     LoggingImpl &operator=(const LoggingImpl &) = delete;
@@ -96,10 +246,196 @@ private:
     /**
      * @brief Потоковая функция вывода сообщений в логи.
      *
-     * Реализация всей логики вывода в лог.
+     * Реализация всей логики вывода в лог. Сообщения выводятся и логи
+     * синхронизируются с устройством хранения без захвата мьютекса очереди.
      */
     void PrintImpl() noexcept;
 
+    /**
+     * @brief Синхронизация логов с устройством хранения и оповещение потоков,
+     * ожидающих в функции @ref WaitDurable.
+     */
+    void SyncSinks() noexcept;
+
+    /**
+     * @brief Ожидание синхронизации сообщения с устройством хранения.
+     *
+     * @param sequence Порядковый номер сообщения
+     */
+    void WaitDurable(std::uint64_t sequence) noexcept;
+
+    /**
+     * @brief Вывод всех сообщений из очереди в логи.
+     *
+     * Сообщения забираются из очереди пачками (@ref TakeBatch) и выводятся
+     * без захвата мьютекса очереди, поэтому медленный лог не блокирует
+     * добавление сообщений. Выводятся сообщения, добавленные до вызова
+     * функции, в том числе из файла временного хранения.
+     *
+     * Мьютекс sinks_mutex_ должен быть захвачен вызывающей стороной. После
+     * вывода оповещает потоки, ожидающие в функции @ref Flush.
+     */
+    void PrintQueue() noexcept;
+
+    /**
+     * @brief Вывод накопленных сообщений в стандартный вывод ошибок в
+     * вызывающем потоке.
+     *
+     * Используется, если логирование не запускалось и логи не открыты.
+     * Выведенные сообщения удаляются из очереди и считаются выведенными.
+     */
+    void PrintStderr() noexcept;
+
+    /**
+     * @brief Получение пачки сообщений для вывода.
+     *
+     * Если очередь пуста, она пополняется из файла временного хранения.
+     *
+     * @param batch Пустая очередь, в которую переносятся сообщения
+     *
+     * @return Есть ли сообщения для вывода
+     */
+    bool TakeBatch(std::deque<LogLine> &batch) noexcept;
+
+    /**
+     * @brief Снятие публикации выведенной пачки сообщений для аварийного
+     * вывода.
+     *
+     * Если аварийный вывод уже начался, поток обработки останавливается до
+     * завершения программы, чтобы пачка не изменялась во время чтения.
+     */
+    void ReleaseBatch() noexcept;
+
+    /**
+     * @brief Доступ к изменению очереди сообщений.
+     *
+     * Учитывает потоки, изменяющие очередь, чтобы аварийный вывод читал ее
+     * без блокировок только при отсутствии изменений. После начала
+     * аварийного вывода доступ не предоставляется, и очередь больше не
+     * изменяется. Создается под мьютексом очереди.
+     */
+    class QueueGuard final
+    {
+    public:
+        /**
+         * @brief Конструктор.
+         *
+         * @param logging Реализация логирования
+         */
+        explicit QueueGuard(LoggingImpl &logging) noexcept;
+
+        /**
+         * @brief Деструктор.
+         */
+        ~QueueGuard() noexcept;
+
+        /**
+         * @brief Проверка разрешения изменять очередь.
+         *
+         * @return Результат проверки. false - начат аварийный вывод
+         */
+        [[nodiscard]] bool Granted() const noexcept;
+
+        QueueGuard(const QueueGuard &) = delete;
+        QueueGuard(QueueGuard &&) = delete;
+        QueueGuard &operator=(const QueueGuard &) = delete;
+        QueueGuard &operator=(QueueGuard &&) = delete;
+
+    private:
+        /**
+         * @brief Счетчик потоков, изменяющих очередь.
+         */
+        std::atomic<unsigned int> &users_;
+
+        /**
+         * @brief Разрешено ли изменять очередь.
+         */
+        bool granted_{false};
+    };
+
+    /**
+     * @brief Настройка файла временного хранения сообщений.
+     */
+    void ReloadSpool() noexcept;
+
+    /**
+     * @brief Настройка потока обработки: название, привязка к ядрам
+     * процессора и приоритет (параметры logging.worker).
+     *
+     * Вызывается потоком обработки. Если параметр удален из конфигурационного
+     * файла, восстанавливается значение на момент запуска потока.
+     */
+    void ReloadWorker() noexcept;
+
+    /**
+     * @brief Открытие логов по параметрам из конфигурационного файла.
+     *
+     * Новый список логов собирается отдельно и заменяет текущий под мьютексом
+     * очереди. Логи, параметры которых (@ref SinkFactory::Fingerprint) не
+     * изменились, не пересоздаются. Остальные логи закрываются и создаются
+     * заново.
+     *
+     * @param sinks_path Путь к параметрам логов в конфигурационном файле
+     */
+    void ReloadSinks(const std::string &sinks_path) noexcept;
+
+    /**
+     * @brief Пересчет скорости добавления сообщений в очередь.
+     *
+     * Вызывается потоком обработки. Скорость пересчитывается не чаще
+     * @ref rate_interval_.
+     */
+    void UpdateRate() noexcept;
+
+    /**
+     * @brief Запрос заполнения очереди.
+     *
+     * До запуска логирования учитывается очередь в памяти и ее предел
+     * @ref boot_capacity_. Если включен файл временного хранения - очередь в
+     * памяти и порог переноса в файл. Иначе - количество еще не выведенных
+     * сообщений и параметр logging.health.capacity.
+     *
+     * Мьютекс mutex_ должен быть захвачен вызывающей стороной.
+     *
+     * @return Количество сообщений в очереди и емкость очереди (0 - без
+     * ограничения)
+     */
+    [[nodiscard]] std::pair<std::size_t, std::size_t> QueueUsage() const
+        noexcept;
+
+    /**
+     * @brief Запрос общего количества сообщений, отброшенных до вывода в логи.
+     *
+     * Сообщения, отброшенные подписчиками, не учитываются: они выведены в
+     * логи.
+     *
+     * Мьютекс mutex_ должен быть захвачен вызывающей стороной.
+     *
+     * @return Количество сообщений
+     */
+    [[nodiscard]] std::uint64_t Dropped() const noexcept;
+
+    /**
+     * @brief Выгрузка бортового самописца в назначенный лог.
+     *
+     * Мьютекс sinks_mutex_ должен быть захвачен вызывающей стороной.
+     *
+     * @param limit Порядковый номер сообщения, до добавления которого в
+     * очередь были сохранены выгружаемые сообщения
+     */
+    void DumpRecorder(std::uint64_t limit) noexcept;
+
+    /**
+     * @brief Пересчет минимального уровня форматируемых сообщений по уровням
+     * логов и подписчиков.
+     */
+    void UpdateMinLevel() noexcept;
+
+    /**
+     * @brief Тип данных для списка каналов подписчиков.
+     */
+    using ChannelList = std::vector<std::shared_ptr<LogChannel>>;
+
     /**
      * @brief Потоковая функция перезагрузки логирования.
      *
@@ -110,7 +446,15 @@ private:
     /**
      * @brief Мьютекс для синхронизации чтения/записи и перезагрузки логов.
      */
-    std::mutex mutex_;
+    mutable std::mutex mutex_;
+
+    /**
+     * @brief Мьютекс вывода сообщений в логи.
+     *
+     * Захватывается потоком обработки на время вывода и синхронизации логов.
+     * Аварийный вывод мьютекс не использует.
+     */
+    mutable std::mutex sinks_mutex_;
 
     /**
      * @brief Фабрика для создания объектов логирования.
@@ -119,24 +463,335 @@ private:
 
     /**
      * @brief Интервал между записью данных в лог.
+     *
+     * Уменьшается до минимального интервала синхронизации логов.
      */
-    std::chrono::seconds timeout_{};
+    std::chrono::milliseconds timeout_{};
 
     /**
      * @brief Список открытых логов.
      */
     std::vector<std::unique_ptr<Sink>> sinks_;
 
+    /**
+     * @brief Параметры открытых логов на момент их создания.
+     *
+     * Ключ - путь к параметрам лога в конфигурационном файле. Используется
+     * только потоком обработки.
+     */
+    std::unordered_map<std::string, std::string> fingerprints_;
+
+    /**
+     * @brief Флаг пересоздания всех логов при следующей перезагрузке.
+     */
+    std::atomic<bool> reopen_{false};
+
     /**
      * @brief Список сообщений для вывода в лог.
+     *
+     * Изменяется под мьютексом очереди и @ref QueueGuard.
+     */
+    std::deque<LogLine> messages_;
+
+    /**
+     * @brief Пачка сообщений, выводимая потоком обработки в логи. nullptr -
+     * вывод не выполняется.
+     *
+     * Публикуется для аварийного вывода, который читает ее без блокировок.
+     */
+    std::atomic<const std::deque<LogLine> *> inflight_{nullptr};
+
+    /**
+     * @brief Количество сформированных сообщений в начале выводимой пачки.
+     */
+    std::atomic<std::size_t> inflight_rendered_{0};
+
+    /**
+     * @brief Количество потоков, изменяющих очередь сообщений.
+     */
+    std::atomic<unsigned int> queue_users_{0};
+
+    /**
+     * @brief Признак начала аварийного вывода. После установки очередь и
+     * выводимая пачка не изменяются.
+     */
+    std::atomic<bool> frozen_{false};
+
+    /**
+     * @brief Файл временного хранения сообщений при переполнении очереди.
+     */
+    LogSpool spool_;
+
+    /**
+     * @brief Максимальное количество сообщений в очереди в памяти. Следующие
+     * сообщения записываются в файл временного хранения. 0 - без
+     * ограничения.
      */
-    std::queue<LogLine> messages_;
+    std::size_t spool_threshold_{0};
+
+    /**
+     * @brief Количество отброшенных файлом временного хранения сообщений, о
+     * которых выведено предупреждение.
+     */
+    std::uint64_t spool_reported_{0};
+
+    /**
+     * @brief Статистика пачек сообщений, выведенных за один проход потока
+     * обработки.
+     */
+    struct BatchStatistics
+    {
+        /**
+         * @brief Количество пачек.
+         */
+        std::atomic<std::uint64_t> count{0};
+
+        /**
+         * @brief Суммарное количество сообщений в пачках.
+         */
+        std::atomic<std::uint64_t> lines{0};
+
+        /**
+         * @brief Максимальное количество сообщений в пачке.
+         */
+        std::atomic<std::uint64_t> max_lines{0};
+    };
+
+    /**
+     * @brief Статистика выведенных пачек сообщений.
+     */
+    BatchStatistics batch_statistics_;
+
+    /**
+     * @brief Максимальное количество не выведенных сообщений.
+     *
+     * Изменяется под мьютексом очереди.
+     */
+    std::uint64_t depth_max_{0};
+
+    /**
+     * @brief Скорость добавления сообщений в очередь (сообщений в секунду).
+     */
+    std::atomic<double> enqueue_rate_{0};
+
+    /**
+     * @brief Максимальная скорость добавления сообщений в очередь.
+     */
+    std::atomic<double> enqueue_rate_max_{0};
+
+    /**
+     * @brief Время последнего пересчета скорости добавления сообщений.
+     */
+    std::chrono::steady_clock::time_point rate_time_{};
+
+    /**
+     * @brief Количество добавленных сообщений при последнем пересчете
+     * скорости.
+     */
+    std::uint64_t rate_enqueued_{0};
+
+    /**
+     * @brief Минимальный интервал пересчета скорости добавления сообщений.
+     */
+    static constexpr std::chrono::seconds rate_interval_{1};
+
+    /**
+     * @brief Емкость очереди для оценки заполнения, если файл временного
+     * хранения выключен. 0 - заполнение не оценивается.
+     */
+    std::atomic<std::size_t> health_capacity_{0};
+
+    /**
+     * @brief Процент заполнения очереди или файла временного хранения, выше
+     * которого состояние логирования - предупреждение.
+     */
+    static constexpr std::size_t health_usage_{80};
+
+    /**
+     * @brief Общее количество отброшенных сообщений при предыдущем запросе
+     * состояния.
+     */
+    mutable std::atomic<std::uint64_t> health_dropped_{0};
+
+    /**
+     * @brief Количество сообщений, добавленных в очередь.
+     *
+     * Значение счетчика присваивается сообщению в качестве порядкового номера.
+     */
+    std::atomic<std::uint64_t> enqueued_{0};
+
+    /**
+     * @brief Количество сообщений, выведенных в логи.
+     */
+    std::atomic<std::uint64_t> written_{0};
+
+    /**
+     * @brief Количество сообщений, синхронизированных с устройством хранения.
+     */
+    std::atomic<std::uint64_t> synced_{0};
+
+    /**
+     * @brief Минимальный уровень сообщений, ожидающих синхронизации с
+     * устройством хранения.
+     *
+     * Учитывает только логи с групповой синхронизацией, принимающие
+     * сообщения этого уровня.
+     */
+    std::atomic<LogLevel::Level> durable_level_{LogLevel::Level::None};
+
+    /**
+     * @brief Максимальное время ожидания синхронизации сообщения. 0 - без
+     * ожидания.
+     */
+    std::atomic<std::chrono::milliseconds> durable_timeout_{
+        std::chrono::seconds{5}};
+
+    /**
+     * @brief Флаг запроса принудительного вывода сообщений.
+     */
+    std::atomic<bool> flush_{false};
+
+    /**
+     * @brief Минимальный уровень сообщений среди открытых логов.
+     *
+     * Сообщения ниже этого уровня не форматируются.
+     */
+    std::atomic<LogLevel::Level> min_level_{LogLevel::Level::Debug};
+
+    /**
+     * @brief Минимальный уровень сообщений среди открытых логов (без учета
+     * подписчиков).
+     */
+    std::atomic<LogLevel::Level> sinks_level_{LogLevel::Level::Debug};
+
+    /**
+     * @brief Список каналов подписчиков.
+     *
+     * Поток обработки читает список атомарно без блокировки. При подписке и
+     * отписке список копируется и заменяется целиком.
+     */
+    std::shared_ptr<const ChannelList> channels_{
+        std::make_shared<const ChannelList>()};
+
+    /**
+     * @brief Мьютекс для изменения списка каналов подписчиков.
+     */
+    mutable std::mutex channels_mutex_;
+
+    /**
+     * @brief Бортовой самописец последних сообщений.
+     */
+    FlightRecorder recorder_;
+
+    /**
+     * @brief Лог для выгрузки бортового самописца.
+     */
+    Sink *recorder_sink_{nullptr};
+
+    /**
+     * @brief Дескриптор лога бортового самописца для аварийного вывода. -1 -
+     * аварийный вывод самописца выключен.
+     */
+    std::atomic<int> recorder_fd_{-1};
+
+    /**
+     * @brief Уровень лога бортового самописца. Сообщения ниже этого уровня
+     * сохраняются в бортовой самописец.
+     */
+    std::atomic<LogLevel::Level> recorder_level_{LogLevel::Level::Debug};
+
+    /**
+     * @brief Максимальный размер двоичных данных, копируемых в сообщение.
+     */
+    std::atomic<std::size_t> bytes_limit_{256};
+
+    /**
+     * @brief Номер последнего запроса выгрузки бортового самописца.
+     */
+    std::atomic<std::uint64_t> dump_requested_{0};
+
+    /**
+     * @brief Номер последнего выполненного запроса выгрузки бортового
+     * самописца.
+     */
+    std::atomic<std::uint64_t> dump_done_{0};
+
+    /**
+     * @brief Аварийный вывод сообщений.
+     */
+    EmergencyWriter emergency_;
+
+    /**
+     * @brief Условная переменная для ожидания вывода сообщений в функции
+     * @ref Flush.
+     */
+    std::condition_variable flushed_;
+
+    /**
+     * @brief Мьютекс для условной переменной ожидания вывода сообщений.
+     */
+    std::mutex flushed_mutex_;
 
     /**
      * @brief Поток обработки сообщений.
      */
     std::unique_ptr<std::thread> thread_{nullptr};
 
+    /**
+     * @brief Привязка потока обработки к ядрам процессора на момент запуска.
+     */
+    cpu_set_t default_affinity_{};
+
+    /**
+     * @brief Приоритет (nice) потока обработки на момент запуска.
+     */
+    int default_nice_{0};
+
+    /**
+     * @brief Приоритет (nice) потока обработки, заданный при последней
+     * перезагрузке.
+     */
+    int nice_{0};
+
+    /**
+     * @brief Выведено ли предупреждение о невозможности вернуть исходный
+     * приоритет потока обработки.
+     */
+    bool nice_warned_{false};
+
+    /**
+     * @brief Флаг для однократного запуска потока обработки.
+     */
+    std::once_flag start_flag_;
+
+    /**
+     * @brief Мьютекс для однократной остановки потока обработки.
+     */
+    std::mutex stop_mutex_;
+
+    /**
+     * @brief Запущен ли поток обработки. Устанавливается после создания
+     * @ref thread_.
+     */
+    std::atomic<bool> started_{false};
+
+    /**
+     * @brief Максимальное количество сообщений в очереди до запуска
+     * логирования.
+     */
+    static constexpr std::size_t boot_capacity_{4096};
+
+    /**
+     * @brief Количество сообщений, отброшенных до запуска логирования, о
+     * которых еще не выведено предупреждение.
+     */
+    std::uint64_t boot_dropped_{0};
+
+    /**
+     * @brief Общее количество сообщений, отброшенных до запуска логирования.
+     */
+    std::uint64_t boot_dropped_total_{0};
+
     /**
      * @brief Текущий статус для потока обработки.
      */
@@ -155,6 +810,101 @@ private:
     std::mutex condition_mutex_;
 };
 
+/**
+ * @brief Реализация двоичных данных для вывода в лог.
+ */
+class BytesImpl final
+{
+public:
+    /**
+     * @brief Конструктор. Копирует данные.
+     *
+     * @param data Указатель на данные
+     * @param size Размер данных в байтах
+     * @param limit Максимальное количество копируемых байт
+     */
+    BytesImpl(const void *data, std::size_t size, std::size_t limit) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~BytesImpl() noexcept;
+
+    /**
+     * @brief Запрос скопированных данных.
+     *
+     * @return Данные
+     */
+    [[nodiscard]] std::string_view Data() const noexcept;
+
+    /**
+     * @brief Запрос исходного размера данных.
+     *
+     * @return Размер данных в байтах
+     */
+    [[nodiscard]] std::size_t Size() const noexcept;
+
+    BytesImpl(const BytesImpl &) = delete;
+    BytesImpl(BytesImpl &&) = delete;
+    BytesImpl &operator=(const BytesImpl &) = delete;
+    BytesImpl &operator=(BytesImpl &&) = delete;
+
+private:
+    /**
+     * @brief Скопированные данные.
+     */
+    std::string data_;
+
+    /**
+     * @brief Исходный размер данных.
+     */
+    std::size_t size_;
+};
+
+/**
+ * @brief Реализация подписки на сообщения лога.
+ */
+class LogSubscriptionImpl final
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * @param logging Реализация логирования, в которой оформлена подписка
+     * @param channel Канал передачи сообщений подписчику
+     */
+    LogSubscriptionImpl(LoggingImpl &logging,
+                        std::shared_ptr<LogChannel> channel) noexcept;
+
+    /**
+     * @brief Деструктор. Отменяет подписку.
+     */
+    ~LogSubscriptionImpl() noexcept;
+
+    /**
+     * @brief Запрос канала передачи сообщений подписчику.
+     *
+     * @return Канал
+     */
+    [[nodiscard]] LogChannel &Channel() const noexcept;
+
+    LogSubscriptionImpl(const LogSubscriptionImpl &) = delete;
+    LogSubscriptionImpl(LogSubscriptionImpl &&) = delete;
+    LogSubscriptionImpl &operator=(const LogSubscriptionImpl &) = delete;
+    LogSubscriptionImpl &operator=(LogSubscriptionImpl &&) = delete;
+
+private:
+    /**
+     * @brief Реализация логирования, в которой оформлена подписка.
+     */
+    LoggingImpl &logging_;
+
+    /**
+     * @brief Канал передачи сообщений подписчику.
+     */
+    std::shared_ptr<LogChannel> channel_;
+};
+
 /**
  * @brief Реализация интерфейса формата строки с локацией.
  */
@@ -0,0 +1,349 @@
+#include "shm_ring.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <new>
+
+using std::memcpy;
+using std::memory_order_acquire;
+using std::memory_order_relaxed;
+using std::memory_order_release;
+using std::min;
+using std::size_t;
+using std::string;
+using std::string_view;
+using std::uint32_t;
+using std::uint64_t;
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+using std::chrono::steady_clock;
+
+namespace tasp
+{
+/*------------------------------------------------------------------------------
+    ShmRing
+------------------------------------------------------------------------------*/
+ShmRing::ShmRing(string_view name, size_t capacity) noexcept
+: name_("/" + string{name})
+{
+    // Оставшийся от завершенного процесса сегмент не усекается, а удаляется:
+    // сборщик, у которого он отображен, продолжает читать прежнюю память и
+    // отключается от него по смене файла сегмента (@ref Linked).
+    shm_unlink(name_.c_str());
+    fd_ = shm_open(name_.c_str(),
+                   O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC,
+                   S_IRUSR | S_IWUSR);
+    if (fd_ == -1)
+    {
+        return;
+    }
+
+    const size_t size{sizeof(Header) + capacity};
+    if (ftruncate(fd_, static_cast<off_t>(size)) == -1 || !Map(size))
+    {
+        close(fd_);
+        fd_ = -1;
+        shm_unlink(name_.c_str());
+        return;
+    }
+
+    header_ = new (header_) Header{};
+    header_->capacity = capacity;
+    header_->owner = getpid();
+    header_->version = version_;
+    capacity_ = capacity;
+
+    // Признак публикуется последним: читатель, увидевший его, видит и
+    // заполненный заголовок.
+    header_->magic.store(magic_, memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+ShmRing::ShmRing(string_view name) noexcept
+: name_("/" + string{name})
+{
+    fd_ = shm_open(name_.c_str(), O_RDWR | O_CLOEXEC, 0);
+    if (fd_ == -1)
+    {
+        return;
+    }
+
+    struct stat info
+    {
+    };
+    if (fstat(fd_, &info) == -1 ||
+        static_cast<size_t>(info.st_size) <= sizeof(Header) ||
+        !Map(static_cast<size_t>(info.st_size)))
+    {
+        return;
+    }
+
+    // Размер области данных берется из размера отображения, а не из
+    // заголовка, который может изменить другой процесс.
+    if (header_->magic.load(memory_order_acquire) != magic_ ||
+        header_->version != version_ ||
+        header_->capacity != size_ - sizeof(Header))
+    {
+        munmap(header_, size_);
+        header_ = nullptr;
+        data_ = nullptr;
+        return;
+    }
+
+    capacity_ = size_ - sizeof(Header);
+}
+
+//------------------------------------------------------------------------------
+ShmRing::~ShmRing() noexcept
+{
+    if (header_ != nullptr)
+    {
+        munmap(header_, size_);
+    }
+
+    if (fd_ != -1)
+    {
+        close(fd_);
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ShmRing::Valid() const noexcept
+{
+    return header_ != nullptr;
+}
+
+//------------------------------------------------------------------------------
+bool ShmRing::Push(string_view record) noexcept
+{
+    if (!Valid())
+    {
+        return false;
+    }
+
+    const uint64_t head{header_->head.load(memory_order_relaxed)};
+    const uint64_t tail{header_->tail.load(memory_order_acquire)};
+
+    const uint64_t need{sizeof(uint32_t) + record.size()};
+    if (need > capacity_ - (head - tail))
+    {
+        header_->dropped.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+
+    const auto size{static_cast<uint32_t>(record.size())};
+    Write(head, &size, sizeof(size));
+    Write(head + sizeof(size), record.data(), record.size());
+
+    header_->head.store(head + need, memory_order_release);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool ShmRing::Pop(string &record) noexcept
+{
+    if (!Valid())
+    {
+        return false;
+    }
+
+    const uint64_t tail{header_->tail.load(memory_order_relaxed)};
+    const uint64_t head{header_->head.load(memory_order_acquire)};
+
+    if (head == tail)
+    {
+        return false;
+    }
+
+    uint32_t size{0};
+    Read(tail, &size, sizeof(size));
+
+    if (head - tail > capacity_ || sizeof(size) + size > head - tail)
+    {
+        // Поврежденная запись: пропускаются все непрочитанные данные.
+        header_->tail.store(head, memory_order_release);
+        return false;
+    }
+
+    record.resize(size);
+    Read(tail + sizeof(size), record.data(), size);
+
+    header_->tail.store(tail + sizeof(size) + size, memory_order_release);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool ShmRing::Empty() const noexcept
+{
+    return !Valid() || header_->head.load(memory_order_acquire) ==
+                           header_->tail.load(memory_order_acquire);
+}
+
+//------------------------------------------------------------------------------
+void ShmRing::Heartbeat() noexcept
+{
+    if (Valid())
+    {
+        header_->heartbeat.store(
+            duration_cast<nanoseconds>(steady_clock::now().time_since_epoch())
+                .count(),
+            memory_order_release);
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ShmRing::ReaderAlive(nanoseconds timeout) const noexcept
+{
+    if (!Valid())
+    {
+        return false;
+    }
+
+    const nanoseconds heartbeat{header_->heartbeat.load(memory_order_acquire)};
+    if (heartbeat.count() == 0)
+    {
+        return false;
+    }
+
+    return steady_clock::now().time_since_epoch() - heartbeat < timeout;
+}
+
+//------------------------------------------------------------------------------
+bool ShmRing::Acquire(pid_t reader) noexcept
+{
+    if (!Valid())
+    {
+        return false;
+    }
+
+    pid_t current{header_->reader.load(memory_order_acquire)};
+    if (current == reader)
+    {
+        return true;
+    }
+
+    // Захват завершившегося процесса (в том числе писателя, который
+    // завершился во время вывода записей в резервный лог) снимается.
+    const pid_t holder{current == writer_ ? header_->owner : current};
+    if (current != 0 && (kill(holder, 0) == 0 || errno != ESRCH))
+    {
+        return false;
+    }
+
+    return header_->reader.compare_exchange_strong(
+        current, reader, std::memory_order_acq_rel);
+}
+
+//------------------------------------------------------------------------------
+void ShmRing::Release(pid_t reader) noexcept
+{
+    if (Valid())
+    {
+        pid_t current{reader};
+        header_->reader.compare_exchange_strong(
+            current, 0, std::memory_order_acq_rel);
+    }
+}
+
+//------------------------------------------------------------------------------
+pid_t ShmRing::Owner() const noexcept
+{
+    return Valid() ? header_->owner : 0;
+}
+
+//------------------------------------------------------------------------------
+uint64_t ShmRing::Dropped() const noexcept
+{
+    return Valid() ? header_->dropped.load(memory_order_relaxed) : 0;
+}
+
+//------------------------------------------------------------------------------
+void ShmRing::Close() noexcept
+{
+    if (Valid())
+    {
+        header_->closed.store(true, memory_order_release);
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ShmRing::Closed() const noexcept
+{
+    return Valid() && header_->closed.load(memory_order_acquire);
+}
+
+//------------------------------------------------------------------------------
+bool ShmRing::Linked() const noexcept
+{
+    if (fd_ == -1)
+    {
+        return false;
+    }
+
+    struct stat opened
+    {
+    };
+    struct stat linked
+    {
+    };
+    const string path{string{directory_} + name_};
+    return fstat(fd_, &opened) == 0 && stat(path.c_str(), &linked) == 0 &&
+           opened.st_dev == linked.st_dev && opened.st_ino == linked.st_ino;
+}
+
+//------------------------------------------------------------------------------
+void ShmRing::Unlink() const noexcept
+{
+    if (Linked())
+    {
+        shm_unlink(name_.c_str());
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ShmRing::Map(size_t size) noexcept
+{
+    void *memory{
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0)};
+    if (memory == MAP_FAILED)
+    {
+        return false;
+    }
+
+    size_ = size;
+    header_ = static_cast<Header *>(memory);
+    data_ = static_cast<char *>(memory) + sizeof(Header);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void ShmRing::Write(uint64_t position, const void *data, size_t size) noexcept
+{
+    const size_t offset{position % capacity_};
+    const size_t first{min(size, capacity_ - offset)};
+
+    memcpy(data_ + offset, data, first);
+    memcpy(data_, static_cast<const char *>(data) + first, size - first);
+}
+
+//------------------------------------------------------------------------------
+void ShmRing::Read(uint64_t position, void *data, size_t size) const noexcept
+{
+    const size_t offset{position % capacity_};
+    const size_t first{min(size, capacity_ - offset)};
+
+    memcpy(data, data_ + offset, first);
+    memcpy(static_cast<char *>(data) + first, data_, size - first);
+}
+
+}  // namespace tasp
@@ -0,0 +1,333 @@
+/**
+ * @file
+ * @brief Кольцевой буфер сообщений в разделяемой памяти.
+ */
+#ifndef TASP_LOGGING_SHM_RING_HPP_
+#define TASP_LOGGING_SHM_RING_HPP_
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <string_view>
+
+namespace tasp
+{
+
+/**
+ * @brief Кольцевой буфер сообщений в разделяемой памяти (POSIX shm).
+ *
+ * Буфер рассчитан на одного писателя (поток логирования процесса) и одного
+ * читателя (сборщик логов). Записи хранятся в виде длины и содержимого.
+ * Читатель периодически обновляет метку времени, по которой писатель
+ * определяет, работает ли сборщик.
+ *
+ * Читать записи может только процесс, захвативший буфер (@ref Acquire). Если
+ * сборщик не подключился или завершился, писатель захватывает буфер сам,
+ * чтобы вывести непрочитанные записи в резервный лог.
+ *
+ * Сегменты создаются в /dev/shm с именем, начинающимся с @ref prefix_.
+ */
+class ShmRing final
+{
+public:
+    /**
+     * @brief Конструктор создания нового буфера (для писателя).
+     *
+     * Если сегмент с таким именем уже существует, он удаляется и создается
+     * новый. Читатель, у которого отображен прежний сегмент, продолжает
+     * работать с ним до отключения.
+     *
+     * @param name Название сегмента разделяемой памяти
+     * @param capacity Размер области данных в байтах
+     */
+    ShmRing(std::string_view name, std::size_t capacity) noexcept;
+
+    /**
+     * @brief Конструктор открытия существующего буфера (для читателя).
+     *
+     * @param name Название сегмента разделяемой памяти
+     */
+    explicit ShmRing(std::string_view name) noexcept;
+
+    /**
+     * @brief Деструктор.
+     *
+     * Отключает разделяемую память. Сам сегмент не удаляется.
+     */
+    ~ShmRing() noexcept;
+
+    /**
+     * @brief Проверка корректного создания или открытия буфера.
+     *
+     * @return Результат проверки
+     */
+    [[nodiscard]] bool Valid() const noexcept;
+
+    /**
+     * @brief Запись в буфер.
+     *
+     * @param record Данные для записи
+     *
+     * @return Результат записи. false - буфер недоступен или переполнен
+     */
+    bool Push(std::string_view record) noexcept;
+
+    /**
+     * @brief Чтение записи из буфера.
+     *
+     * @param record Прочитанные данные
+     *
+     * @return Результат чтения. false - буфер пуст
+     */
+    bool Pop(std::string &record) noexcept;
+
+    /**
+     * @brief Проверка наличия непрочитанных записей.
+     *
+     * @return Результат проверки
+     */
+    [[nodiscard]] bool Empty() const noexcept;
+
+    /**
+     * @brief Обновление метки времени работы читателя.
+     */
+    void Heartbeat() noexcept;
+
+    /**
+     * @brief Проверка работы читателя.
+     *
+     * @param timeout Максимально допустимое время с последнего обновления
+     * метки времени читателем
+     *
+     * @return Работает ли читатель
+     */
+    [[nodiscard]] bool ReaderAlive(
+        std::chrono::nanoseconds timeout) const noexcept;
+
+    /**
+     * @brief Захват буфера для чтения.
+     *
+     * Буфер захватывается, если он свободен, уже захвачен этим же читателем
+     * или захвативший его процесс завершился.
+     *
+     * @param reader Идентификатор читателя: PID сборщика или @ref writer_ для
+     * писателя
+     *
+     * @return Результат захвата
+     */
+    bool Acquire(pid_t reader) noexcept;
+
+    /**
+     * @brief Освобождение буфера, захваченного для чтения.
+     *
+     * @param reader Идентификатор читателя, переданный в @ref Acquire
+     */
+    void Release(pid_t reader) noexcept;
+
+    /**
+     * @brief Запрос идентификатора процесса, создавшего буфер.
+     *
+     * @return Идентификатор процесса
+     */
+    [[nodiscard]] pid_t Owner() const noexcept;
+
+    /**
+     * @brief Запрос количества записей, не поместившихся в буфер.
+     *
+     * @return Количество записей
+     */
+    [[nodiscard]] std::uint64_t Dropped() const noexcept;
+
+    /**
+     * @brief Отметка о завершении записи в буфер.
+     *
+     * Читатель удаляет закрытый буфер после чтения оставшихся записей.
+     */
+    void Close() noexcept;
+
+    /**
+     * @brief Проверка завершения записи в буфер.
+     *
+     * @return Результат проверки
+     */
+    [[nodiscard]] bool Closed() const noexcept;
+
+    /**
+     * @brief Проверка того, что название сегмента указывает на открытый сегмент
+     * (сегмент не был удален или заменен другим процессом).
+     *
+     * @return Результат проверки
+     */
+    [[nodiscard]] bool Linked() const noexcept;
+
+    /**
+     * @brief Удаление сегмента разделяемой памяти.
+     *
+     * Сегмент удаляется, только если название еще указывает на него.
+     */
+    void Unlink() const noexcept;
+
+    /**
+     * @brief Идентификатор читателя для захвата буфера писателем.
+     */
+    static constexpr pid_t writer_{-1};
+
+    /**
+     * @brief Префикс названия сегментов с буферами сообщений.
+     */
+    static constexpr std::string_view prefix_{"tasp-log."};
+
+    /**
+     * @brief Директория, в которой размещаются сегменты разделяемой памяти.
+     */
+    static constexpr std::string_view directory_{"/dev/shm"};
+
+    ShmRing(const ShmRing &) = delete;
+    ShmRing(ShmRing &&) = delete;
+    ShmRing &operator=(const ShmRing &) = delete;
+    ShmRing &operator=(ShmRing &&) = delete;
+
+private:
+    /**
+     * @brief Заголовок буфера, размещаемый в начале сегмента.
+     */
+    struct Header
+    {
+        /**
+         * @brief Признак буфера сообщений. Записывается последним при
+         * создании буфера.
+         */
+        std::atomic<std::uint32_t> magic;
+
+        /**
+         * @brief Версия формата буфера.
+         */
+        std::uint32_t version;
+
+        /**
+         * @brief Размер области данных в байтах.
+         */
+        std::uint64_t capacity;
+
+        /**
+         * @brief Идентификатор процесса, создавшего буфер.
+         */
+        pid_t owner;
+
+        /**
+         * @brief Позиция записи (монотонно возрастает).
+         */
+        std::atomic<std::uint64_t> head;
+
+        /**
+         * @brief Позиция чтения (монотонно возрастает).
+         */
+        std::atomic<std::uint64_t> tail;
+
+        /**
+         * @brief Последнее время работы читателя, std::chrono::steady_clock
+         * в наносекундах.
+         */
+        std::atomic<std::int64_t> heartbeat;
+
+        /**
+         * @brief Количество записей, не поместившихся в буфер.
+         */
+        std::atomic<std::uint64_t> dropped;
+
+        /**
+         * @brief Признак завершения записи в буфер.
+         */
+        std::atomic<std::uint32_t> closed;
+
+        /**
+         * @brief Идентификатор читателя, захватившего буфер. 0 - буфер
+         * свободен.
+         */
+        std::atomic<pid_t> reader;
+    };
+
+    /**
+     * @brief Отображение сегмента в память.
+     *
+     * @param size Размер сегмента
+     *
+     * @return Результат отображения
+     */
+    bool Map(std::size_t size) noexcept;
+
+    /**
+     * @brief Копирование данных в область данных с учетом перехода через
+     * границу буфера.
+     *
+     * @param position Позиция записи
+     * @param data Данные
+     * @param size Размер данных
+     */
+    void Write(std::uint64_t position,
+               const void *data,
+               std::size_t size) noexcept;
+
+    /**
+     * @brief Копирование данных из области данных с учетом перехода через
+     * границу буфера.
+     *
+     * @param position Позиция чтения
+     * @param data Буфер для данных
+     * @param size Размер данных
+     */
+    void Read(std::uint64_t position, void *data, std::size_t size) const
+        noexcept;
+
+    /**
+     * @brief Название сегмента разделяемой памяти.
+     */
+    std::string name_;
+
+    /**
+     * @brief Файловый дескриптор сегмента.
+     */
+    int fd_{-1};
+
+    /**
+     * @brief Размер отображенного сегмента.
+     */
+    std::size_t size_{0};
+
+    /**
+     * @brief Размер области данных в байтах.
+     *
+     * Определяется размером отображения и не зависит от заголовка в
+     * разделяемой памяти.
+     */
+    std::size_t capacity_{0};
+
+    /**
+     * @brief Заголовок буфера.
+     */
+    Header *header_{nullptr};
+
+    /**
+     * @brief Область данных.
+     */
+    char *data_{nullptr};
+
+    /**
+     * @brief Значение признака буфера сообщений.
+     */
+    static constexpr std::uint32_t magic_{0x5441534C};
+
+    /**
+     * @brief Текущая версия формата буфера.
+     */
+    static constexpr std::uint32_t version_{4};
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+                  "Для разделяемой памяти необходимы неблокирующие атомики");
+};
+
+}  // namespace tasp
+
+#endif  // TASP_LOGGING_SHM_RING_HPP_
@@ -32,6 +32,12 @@ void ConsoleSink::PrintImpl(const LogLine &line) noexcept
     cout << '\n';
 }
 
+//------------------------------------------------------------------------------
+void ConsoleSink::FlushImpl() noexcept
+{
+    cout.flush();
+}
+
 //------------------------------------------------------------------------------
 string ConsoleSink::ToColorLogLevel(const LogLevel &level) noexcept
 {
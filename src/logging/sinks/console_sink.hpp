@@ -42,6 +42,11 @@ private:
      */
     void PrintImpl(const LogLine &line) noexcept override;
 
+    /**
+     * @brief Реализация сброса буферизированных данных.
+     */
+    void FlushImpl() noexcept override;
+
     /**
      * @brief Преобразования уровня лога в вывод в консоль с цветом.
      *
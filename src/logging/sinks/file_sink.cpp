@@ -1,14 +1,37 @@
 #include "file_sink.hpp"
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <ctime>
+#include <sstream>
+#include <vector>
+
 #include "tasp/config.hpp"
 #include "tasp/logging.hpp"
 
 using std::error_code;
 using std::exception;
-using std::ofstream;
+using std::make_unique;
+using std::memory_order_relaxed;
+using std::size_t;
 using std::string;
 using std::string_view;
+using std::stringstream;
 using std::to_string;
+using std::uint64_t;
+using std::vector;
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+using std::chrono::nanoseconds;
+using std::chrono::steady_clock;
+using std::chrono::system_clock;
 
 namespace tasp
 {
@@ -24,9 +47,21 @@ FileSinkRotate::FileSinkRotate(string_view config_path) noexcept
     enable_ = conf.Get(path + ".rotate.enable", enable_);
     max_size_ = conf.Get(path + ".rotate.max_size", max_size_);
     max_files_ = conf.Get(path + ".rotate.max_files", max_files_);
+    preallocate_ = conf.Get(path + ".rotate.preallocate", max_size_);
+
+    const string period{conf.Get<string>(path + ".rotate.period", "none")};
+    if (period == "hourly")
+    {
+        period_ = Period::Hourly;
+    }
+    else if (period == "daily")
+    {
+        period_ = Period::Daily;
+    }
 
     const int base{1024};
     max_size_ = max_size_ * base * base;
+    preallocate_ = enable_ ? preallocate_ * base * base : 0;
 }
 
 //------------------------------------------------------------------------------
@@ -37,18 +72,23 @@ void FileSinkRotate::SetFullPath(const fs::path &fullpath) noexcept
 {
     fullpath_ = fullpath;
 
-    try
-    {
-        current_size_ = fs::file_size(fullpath_);
-    }
-    catch (const exception &exception)
+    error_code error{};
+    current_size_ = fs::file_size(fullpath_, error);
+    if (error)
     {
         current_size_ = 0;
+        StartSegment(system_clock::now());
+        return;
     }
+
+    // Время изменения файла (experimental::filesystem использует
+    // std::chrono::system_clock).
+    const Timepoint modified{fs::last_write_time(fullpath_, error)};
+    StartSegment(error ? system_clock::now() : PeriodStart(modified));
 }
 
 //------------------------------------------------------------------------------
-bool FileSinkRotate::Rotate(size_t message_length) noexcept
+bool FileSinkRotate::Rotate(size_t message_length, const Timepoint &time) noexcept
 {
     if (!enable_)
     {
@@ -56,11 +96,67 @@ bool FileSinkRotate::Rotate(size_t message_length) noexcept
     }
 
     current_size_ += message_length;
-    if (current_size_ < max_size_)
+
+    const bool by_time{time >= next_rotation_};
+    const bool by_size{max_size_ != 0 && current_size_ >= max_size_};
+    if (!by_time && !by_size)
     {
         return false;
     }
 
+    if (period_ == Period::None)
+    {
+        RenameNumbered();
+    }
+    else
+    {
+        RenameSegment();
+    }
+
+    // Новое сообщение выводится уже в новый файл.
+    current_size_ = message_length;
+    StartSegment(by_time ? PeriodStart(time) : time);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+std::uintmax_t FileSinkRotate::Preallocate() const noexcept
+{
+    return preallocate_;
+}
+
+//------------------------------------------------------------------------------
+void FileSinkRotate::StartSegment(const Timepoint &start) noexcept
+{
+    segment_start_ = start;
+
+    if (period_ == Period::None)
+    {
+        next_rotation_ = Timepoint::max();
+        return;
+    }
+
+    const time_t start_time{system_clock::to_time_t(PeriodStart(start))};
+    tm local{};
+    localtime_r(&start_time, &local);
+
+    if (period_ == Period::Hourly)
+    {
+        ++local.tm_hour;
+    }
+    else
+    {
+        ++local.tm_mday;
+    }
+    local.tm_isdst = -1;
+
+    next_rotation_ = system_clock::from_time_t(mktime(&local));
+}
+
+//------------------------------------------------------------------------------
+void FileSinkRotate::RenameNumbered() const noexcept
+{
     fs::path src_log{fullpath_};
     src_log += "." + to_string(max_files_);
 
@@ -77,10 +173,80 @@ bool FileSinkRotate::Rotate(size_t message_length) noexcept
             fs::rename(src_log, dst_log, error);
         }
     }
+}
 
-    current_size_ = 0;
+//------------------------------------------------------------------------------
+void FileSinkRotate::RenameSegment() const noexcept
+{
+    const time_t start{system_clock::to_time_t(segment_start_)};
+    tm local{};
+    localtime_r(&start, &local);
 
-    return true;
+    std::array<char, 32> suffix{};
+    strftime(suffix.data(), suffix.size(), ".%Y%m%d-%H%M%S", &local);
+
+    fs::path segment{fullpath_};
+    segment += suffix.data();
+
+    error_code error{};
+    for (int number = 1; fs::exists(segment, error); ++number)
+    {
+        segment = fullpath_;
+        segment += suffix.data();
+        segment += "." + to_string(number);
+    }
+
+    fs::rename(fullpath_, segment, error);
+
+    if (max_files_ == 0)
+    {
+        return;
+    }
+
+    // Сегменты отличаются только суффиксом времени, поэтому сортировка по
+    // имени совпадает с сортировкой по времени.
+    const string prefix{fullpath_.filename().string() + "."};
+    vector<fs::path> segments{};
+    for (const auto &entry :
+         fs::directory_iterator(fullpath_.parent_path(), error))
+    {
+        const string name{entry.path().filename().string()};
+        if (name.size() > prefix.size() &&
+            name.compare(0, prefix.size(), prefix) == 0 &&
+            isdigit(static_cast<unsigned char>(name[prefix.size()])) != 0)
+        {
+            segments.push_back(entry.path());
+        }
+    }
+
+    if (segments.size() <= max_files_)
+    {
+        return;
+    }
+
+    sort(segments.begin(), segments.end());
+    for (size_t i = 0; i < segments.size() - max_files_; ++i)
+    {
+        fs::remove(segments[i], error);
+    }
+}
+
+//------------------------------------------------------------------------------
+Timepoint FileSinkRotate::PeriodStart(const Timepoint &time) const noexcept
+{
+    const time_t value{system_clock::to_time_t(time)};
+    tm local{};
+    localtime_r(&value, &local);
+
+    local.tm_sec = 0;
+    local.tm_min = 0;
+    if (period_ == Period::Daily)
+    {
+        local.tm_hour = 0;
+    }
+    local.tm_isdst = -1;
+
+    return system_clock::from_time_t(mktime(&local));
 }
 
 /*------------------------------------------------------------------------------
@@ -118,30 +284,276 @@ FileSink::FileSink(string_view config_path) noexcept
 
     fullpath_ /= name;
 
+    json_ = conf.Get<string>(path + ".format", "text") == "json";
+    stamps_ = conf.Get(path + ".stamps", stamps_);
+    if (json_)
+    {
+        Json::StreamWriterBuilder builder{};
+        builder["indentation"] = "";
+        builder["emitUTF8"] = true;
+        json_writer_.reset(builder.newStreamWriter());
+    }
+    else
+    {
+        const string_view default_pattern{stamps_ ? LogPattern::stamps_
+                                                  : LogPattern::default_};
+        pattern_ = make_unique<LogPattern>(
+            conf.Get<string>(path + ".pattern", string{default_pattern}));
+    }
+
+    const string durability{
+        conf.Get<string>(path + ".durability.mode", "none")};
+    if (durability == "periodic")
+    {
+        durability_ = Durability::Periodic;
+    }
+    else if (durability == "group")
+    {
+        durability_ = Durability::Group;
+    }
+
+    sync_interval_ = milliseconds{conf.Get(
+        path + ".durability.interval",
+        static_cast<unsigned int>(sync_interval_.count()))};
+    durable_level_ =
+        LogLevel{conf.Get<string>(path + ".durability.level", "Error")}.Get();
+    last_sync_ = steady_clock::now();
+
     rotate_.SetFullPath(fullpath_);
     rotate_.Rotate();
 
-    file_.open(fullpath_, ofstream::out | ofstream::app);
+    buffer_.reserve(buffer_size_);
+    Open();
 }
 
 //------------------------------------------------------------------------------
 FileSink::~FileSink() noexcept
 {
-    file_.close();
+    FlushImpl();
+    if (durability_ != Durability::None && unsynced_ != 0)
+    {
+        SyncFile();
+    }
+    ReleasePreallocated();
+
+    if (fd_ != -1)
+    {
+        close(fd_);
+    }
+}
+
+//------------------------------------------------------------------------------
+int FileSink::Descriptor() const noexcept
+{
+    return fd_;
 }
 
 //------------------------------------------------------------------------------
 void FileSink::PrintImpl(const LogLine &line) noexcept
 {
-    const string message{line.ToString()};
+    const size_t start{buffer_.size()};
+    Format(line, buffer_);
+
+    const Timepoint time{line.Time() != Timepoint{} ? line.Time()
+                                                    : system_clock::now()};
+    if (rotate_.Rotate(buffer_.size() - start + 1, time))
+    {
+        // Накопленные ранее сообщения дописываются в файл, уже переименованный
+        // при ротации.
+        WriteBuffer(start);
+        if (unsynced_ != 0)
+        {
+            SyncFile();
+        }
+        ReleasePreallocated();
+        Open();
+    }
+
+    buffer_ += '\n';
+
+    ++unsynced_;
+    if (durability_ == Durability::Group && line.Level() >= durable_level_)
+    {
+        durable_pending_ = true;
+    }
+
+    if (buffer_.size() >= buffer_size_)
+    {
+        FlushImpl();
+    }
+}
+
+//------------------------------------------------------------------------------
+milliseconds FileSink::SyncInterval() const noexcept
+{
+    return durability_ != Durability::None ? sync_interval_ : milliseconds{0};
+}
+
+//------------------------------------------------------------------------------
+LogLevel::Level FileSink::DurableLevel() const noexcept
+{
+    return durability_ == Durability::Group ? durable_level_
+                                            : LogLevel::Level::None;
+}
+
+//------------------------------------------------------------------------------
+Json::Value FileSink::Statistics() const noexcept
+{
+    static const std::array<string, 3> modes{{"none", "periodic", "group"}};
+
+    Json::Value statistics{};
+    statistics["durability"] = modes.at(static_cast<size_t>(durability_));
+
+    const uint64_t count{sync_statistics_.count};
+    const auto latency{sync_statistics_.latency.load()};
+    const auto max_latency{sync_statistics_.max_latency.load()};
+
+    Json::Value sync{};
+    sync["count"] = Json::UInt64{count};
+    sync["latency_avg_us"] = Json::UInt64{
+        count != 0 ? static_cast<uint64_t>(
+                         duration_cast<microseconds>(latency).count()) /
+                         count
+                   : 0};
+    sync["latency_max_us"] = Json::UInt64{static_cast<uint64_t>(
+        duration_cast<microseconds>(max_latency).count())};
+    sync["batch_avg"] =
+        Json::UInt64{count != 0 ? sync_statistics_.lines / count : 0};
+    sync["batch_max"] = Json::UInt64{sync_statistics_.max_lines};
+    statistics["sync"] = sync;
+
+    return statistics;
+}
+
+//------------------------------------------------------------------------------
+void FileSink::SyncImpl() noexcept
+{
+    if (durability_ == Durability::None || unsynced_ == 0)
+    {
+        return;
+    }
+
+    if (!durable_pending_ && steady_clock::now() - last_sync_ < sync_interval_)
+    {
+        return;
+    }
+
+    FlushImpl();
+    SyncFile();
+}
+
+//------------------------------------------------------------------------------
+void FileSink::SyncFile() noexcept
+{
+    const auto start{steady_clock::now()};
+    if (fd_ != -1)
+    {
+        fdatasync(fd_);
+    }
+    const auto finish{steady_clock::now()};
+    const nanoseconds latency{finish - start};
+
+    auto &stats{sync_statistics_};
+    stats.count.fetch_add(1, memory_order_relaxed);
+    stats.lines.fetch_add(unsynced_, memory_order_relaxed);
+    stats.latency.store(stats.latency.load(memory_order_relaxed) + latency,
+                        memory_order_relaxed);
+    if (unsynced_ > stats.max_lines.load(memory_order_relaxed))
+    {
+        stats.max_lines.store(unsynced_, memory_order_relaxed);
+    }
+    if (latency > stats.max_latency.load(memory_order_relaxed))
+    {
+        stats.max_latency.store(latency, memory_order_relaxed);
+    }
+
+    unsynced_ = 0;
+    durable_pending_ = false;
+    last_sync_ = finish;
+}
+
+//------------------------------------------------------------------------------
+void FileSink::Open() noexcept
+{
+    const int fd{open(fullpath_.c_str(),
+                      O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+                      S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH)};
+    if (fd == -1)
+    {
+        return;
+    }
+
+    const auto preallocate{rotate_.Preallocate()};
+    if (preallocate != 0)
+    {
+        fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(preallocate));
+    }
 
-    if (rotate_.Rotate(message.length()))
+    if (fd_ == -1)
+    {
+        fd_ = fd;
+        return;
+    }
+
+    dup2(fd, fd_);
+    close(fd);
+}
+
+//------------------------------------------------------------------------------
+void FileSink::ReleasePreallocated() const noexcept
+{
+    struct stat info
     {
-        file_.close();
-        file_.open(fullpath_, ofstream::out | ofstream::app);
+    };
+    if (rotate_.Preallocate() == 0 || fd_ == -1 || fstat(fd_, &info) == -1)
+    {
+        return;
+    }
+
+    // Усечение до текущего размера освобождает блоки за концом файла.
+    [[maybe_unused]] const int result{ftruncate(fd_, info.st_size)};
+}
+
+//------------------------------------------------------------------------------
+void FileSink::Format(const LogLine &line, string &buffer) const noexcept
+{
+    if (!json_)
+    {
+        pattern_->Format(line, buffer);
+        return;
+    }
+
+    stringstream buf{};
+    json_writer_->write(line.ToJSON(stamps_), &buf);
+    buffer += buf.str();
+}
+
+//------------------------------------------------------------------------------
+void FileSink::FlushImpl() noexcept
+{
+    WriteBuffer(buffer_.size());
+}
+
+//------------------------------------------------------------------------------
+void FileSink::WriteBuffer(size_t size) noexcept
+{
+    string_view data{buffer_.data(), size};
+    while (!data.empty() && fd_ != -1)
+    {
+        const ssize_t written{write(fd_, data.data(), data.size())};
+        if (written == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        data.remove_prefix(static_cast<size_t>(written));
     }
 
-    file_ << message << '\n';
+    buffer_.erase(0, size);
 }
 
 }  // namespace tasp
@@ -5,10 +5,12 @@
 #ifndef TASP_LOGGING_SINKS_FILE_SINK_HPP_
 #define TASP_LOGGING_SINKS_FILE_SINK_HPP_
 
+#include <atomic>
+#include <chrono>
 #include <experimental/filesystem>
-#include <fstream>
 
 #include "../log_line.hpp"
+#include "../log_pattern.hpp"
 #include "sink.hpp"
 
 namespace fs = std::experimental::filesystem;
@@ -18,6 +20,11 @@ namespace tasp
 
 /**
  * @brief Класс для ротации текстового лога.
+ *
+ * Ротация выполняется по размеру файла и (или) по времени (каждый час или
+ * каждые сутки). При ротации по размеру без периода файлы нумеруются:
+ * ИМЯ.1 ... ИМЯ.N. При заданном периоде закрытые сегменты называются по
+ * времени начала: ИМЯ.ГГГГММДД-ЧЧММСС.
  */
 class FileSinkRotate final
 {
@@ -37,6 +44,9 @@ public:
     /**
      * @brief Установка полного пути к основному файлу лога.
      *
+     * Для существующего файла началом сегмента считается начало периода, в
+     * котором файл был изменен последний раз.
+     *
      * @param fullpath Полный путь к файлу
      */
     void SetFullPath(const fs::path &fullpath) noexcept;
@@ -44,14 +54,24 @@ public:
     /**
      * @brief Ротация лог файла.
      *
-     * При вызове функции проверятся включена ротация и достигнут ли
-     * максимально допустимый размер файла.
+     * При вызове функции проверятся включена ротация, достигнут ли
+     * максимально допустимый размер файла и наступил ли следующий период.
+     * Проверка периода - сравнение с заранее вычисленной границей.
      *
-     * @param message_length Размер нового сообщения
+     * @param message_length Размер нового сообщения вместе с переводом строки
+     * @param time Время нового сообщения
      *
      * @return Была ли произведена ротация
      */
-    bool Rotate(size_t message_length = 0) noexcept;
+    bool Rotate(size_t message_length = 0,
+                const Timepoint &time = std::chrono::system_clock::now()) noexcept;
+
+    /**
+     * @brief Запрос размера, резервируемого под новый файл лога.
+     *
+     * @return Размер в байтах или 0, если резервирование не требуется
+     */
+    [[nodiscard]] std::uintmax_t Preallocate() const noexcept;
 
     FileSinkRotate(const FileSinkRotate &) = delete;
     FileSinkRotate(FileSinkRotate &&) = delete;
@@ -59,6 +79,43 @@ public:
     FileSinkRotate &operator=(FileSinkRotate &&) = delete;
 
 private:
+    /**
+     * @brief Периоды ротации по времени.
+     */
+    enum class Period : std::uint8_t
+    {
+        None = 0,   /*!< Без ротации по времени */
+        Hourly = 1, /*!< Каждый час */
+        Daily = 2   /*!< Каждые сутки */
+    };
+
+    /**
+     * @brief Начало нового сегмента: вычисление времени следующей ротации.
+     *
+     * @param start Время начала сегмента
+     */
+    void StartSegment(const Timepoint &start) noexcept;
+
+    /**
+     * @brief Переименование файлов с номерами (ротация без периода).
+     */
+    void RenameNumbered() const noexcept;
+
+    /**
+     * @brief Переименование файла в сегмент с временем начала и удаление
+     * старых сегментов сверх максимального количества.
+     */
+    void RenameSegment() const noexcept;
+
+    /**
+     * @brief Вычисление начала периода по местному времени.
+     *
+     * @param time Момент времени
+     *
+     * @return Начало периода, в который входит момент времени
+     */
+    [[nodiscard]] Timepoint PeriodStart(const Timepoint &time) const noexcept;
+
     /**
      * @brief Текущий размер файла.
      */
@@ -75,10 +132,30 @@ private:
     uint16_t max_files_{10};
 
     /**
-     * @brief Максимальный размер файла.
+     * @brief Максимальный размер файла. 0 - без ограничения.
      */
     std::uintmax_t max_size_{10};
 
+    /**
+     * @brief Размер, резервируемый под новый файл лога.
+     */
+    std::uintmax_t preallocate_{0};
+
+    /**
+     * @brief Период ротации по времени.
+     */
+    Period period_{Period::None};
+
+    /**
+     * @brief Время начала текущего сегмента.
+     */
+    Timepoint segment_start_{};
+
+    /**
+     * @brief Время следующей ротации по времени.
+     */
+    Timepoint next_rotation_{Timepoint::max()};
+
     /**
      * @brief Полный путь к файлу лога.
      */
@@ -103,6 +180,38 @@ public:
      */
     ~FileSink() noexcept override;
 
+    /**
+     * @brief Запрос файлового дескриптора для аварийного вывода сообщений.
+     *
+     * Номер дескриптора не меняется при ротации.
+     *
+     * @return Дескриптор или -1, если файл не открыт
+     */
+    [[nodiscard]] int Descriptor() const noexcept override;
+
+    /**
+     * @brief Запрос интервала периодической синхронизации.
+     *
+     * @return Интервал или 0, если синхронизация выключена
+     */
+    [[nodiscard]] std::chrono::milliseconds SyncInterval() const
+        noexcept override;
+
+    /**
+     * @brief Запрос уровня сообщений, ожидающих синхронизации (только для
+     * режима group).
+     *
+     * @return Уровень сообщений
+     */
+    [[nodiscard]] LogLevel::Level DurableLevel() const noexcept override;
+
+    /**
+     * @brief Запрос статистики синхронизации с устройством хранения.
+     *
+     * @return Статистика в формате Json::Value
+     */
+    [[nodiscard]] Json::Value Statistics() const noexcept override;
+
     FileSink(const FileSink &) = delete;
     FileSink(FileSink &&) = delete;
     FileSink &operator=(const FileSink &) = delete;
@@ -116,15 +225,178 @@ private:
      */
     void PrintImpl(const LogLine &line) noexcept override;
 
+    /**
+     * @brief Реализация сброса буферизированных данных.
+     *
+     * Использует только write(2), поэтому может вызываться из обработчика
+     * сигнала.
+     */
+    void FlushImpl() noexcept override;
+
+    /**
+     * @brief Реализация синхронизации с устройством хранения.
+     *
+     * В режиме periodic синхронизация выполняется, если с предыдущей прошло
+     * больше интервала. В режиме group - также сразу после вывода сообщения
+     * уровня не ниже @ref durable_level_.
+     */
+    void SyncImpl() noexcept override;
+
+    /**
+     * @brief Синхронизация файла (fdatasync) с обновлением статистики.
+     */
+    void SyncFile() noexcept;
+
+    /**
+     * @brief Открытие файла лога.
+     *
+     * При повторном открытии (после ротации) новый файл подставляется на место
+     * прежнего дескриптора, чтобы номер дескриптора не менялся. Под файл
+     * резервируется место (fallocate), размер файла при этом не меняется.
+     */
+    void Open() noexcept;
+
+    /**
+     * @brief Освобождение зарезервированного, но не использованного места за
+     * концом файла.
+     */
+    void ReleasePreallocated() const noexcept;
+
+    /**
+     * @brief Формирование строки для вывода в лог в выбранном формате.
+     *
+     * Строка добавляется в конец буфера без перевода строки.
+     *
+     * @param line Данные для вывода
+     * @param buffer Буфер для результата
+     */
+    void Format(const LogLine &line, std::string &buffer) const noexcept;
+
+    /**
+     * @brief Запись начала буфера в файл.
+     *
+     * Использует только write(2). Записанные данные удаляются из буфера.
+     *
+     * @param size Количество байт для записи
+     */
+    void WriteBuffer(std::size_t size) noexcept;
+
     /**
      * @brief Полный путь к логу.
      */
     fs::path fullpath_;
 
     /**
-     * @brief Открытый файл для вывода сообщений.
+     * @brief Флаг вывода сообщений в формате JSON (по одному объекту на
+     * строку).
+     */
+    bool json_{false};
+
+    /**
+     * @brief Флаг вывода порядкового номера и монотонного времени сообщения.
+     */
+    bool stamps_{false};
+
+    /**
+     * @brief Шаблон строки для текстового формата.
+     */
+    std::unique_ptr<LogPattern> pattern_;
+
+    /**
+     * @brief Объект для вывода сообщений в формате JSON.
+     */
+    std::unique_ptr<Json::StreamWriter> json_writer_;
+
+    /**
+     * @brief Дескриптор открытого файла для вывода сообщений.
+     */
+    int fd_{-1};
+
+    /**
+     * @brief Буфер сообщений, еще не записанных в файл.
+     */
+    std::string buffer_;
+
+    /**
+     * @brief Размер буфера, при достижении которого данные записываются в файл.
+     */
+    static constexpr std::size_t buffer_size_{64 * 1024};
+
+    /**
+     * @brief Режимы синхронизации с устройством хранения.
+     */
+    enum class Durability : std::uint8_t
+    {
+        None = 0,     /*!< Без синхронизации */
+        Periodic = 1, /*!< Периодическая синхронизация */
+        Group = 2     /*!< Групповая синхронизация по важным сообщениям */
+    };
+
+    /**
+     * @brief Статистика синхронизаций с устройством хранения.
+     */
+    struct SyncStatistics
+    {
+        /**
+         * @brief Количество синхронизаций.
+         */
+        std::atomic<std::uint64_t> count{0};
+
+        /**
+         * @brief Суммарное количество синхронизированных сообщений.
+         */
+        std::atomic<std::uint64_t> lines{0};
+
+        /**
+         * @brief Максимальное количество сообщений за одну синхронизацию.
+         */
+        std::atomic<std::uint64_t> max_lines{0};
+
+        /**
+         * @brief Суммарное время синхронизаций.
+         */
+        std::atomic<std::chrono::nanoseconds> latency{};
+
+        /**
+         * @brief Максимальное время синхронизации.
+         */
+        std::atomic<std::chrono::nanoseconds> max_latency{};
+    };
+
+    /**
+     * @brief Режим синхронизации с устройством хранения.
+     */
+    Durability durability_{Durability::None};
+
+    /**
+     * @brief Интервал периодической синхронизации.
+     */
+    std::chrono::milliseconds sync_interval_{1000};
+
+    /**
+     * @brief Уровень сообщений, ожидающих синхронизации в режиме group.
+     */
+    LogLevel::Level durable_level_{LogLevel::Level::Error};
+
+    /**
+     * @brief Количество сообщений, выведенных после последней синхронизации.
+     */
+    std::uint64_t unsynced_{0};
+
+    /**
+     * @brief Флаг вывода сообщения, ожидающего синхронизации.
+     */
+    bool durable_pending_{false};
+
+    /**
+     * @brief Время последней синхронизации.
+     */
+    std::chrono::steady_clock::time_point last_sync_{};
+
+    /**
+     * @brief Статистика синхронизаций.
      */
-    std::ofstream file_;
+    SyncStatistics sync_statistics_;
 
     /**
      * @brief Ротация лог-файлов.
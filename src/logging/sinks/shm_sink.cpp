@@ -0,0 +1,183 @@
+#include "shm_sink.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "tasp/config.hpp"
+#include "tasp/logging.hpp"
+
+using std::make_unique;
+using std::string;
+using std::string_view;
+using std::to_string;
+using std::vector;
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+namespace tasp
+{
+/*------------------------------------------------------------------------------
+    ShmSink
+------------------------------------------------------------------------------*/
+ShmSink::ShmSink(string_view config_path) noexcept
+: Sink(config_path)
+{
+    auto &conf{ConfigGlobal::Instance()};
+
+    const string path{config_path};
+
+    origin_ = conf.Get<string>("program.name") + ":" + to_string(getpid());
+
+    const std::size_t base{1024};
+    const std::size_t default_size{1024};
+    const auto size{conf.Get(path + ".size", default_size) * base};
+
+    timeout_ = milliseconds{conf.Get(path + ".timeout", 2000U)};
+
+    // Номер буфера в процессе: после перезагрузки логирования сборщик
+    // дочитывает закрытый прежний буфер, пока новый создается под другим
+    // названием.
+    static std::atomic<unsigned int> generation{0};
+
+    string name{ShmRing::prefix_};
+    name += origin_;
+    name += "." + to_string(generation.fetch_add(1));
+    ring_ = make_unique<ShmRing>(name, size);
+
+    // Сборщик подключает новые буферы периодически, поэтому до его
+    // подключения сообщения записываются в буфер в течение timeout.
+    deadline_ = steady_clock::now() + timeout_;
+
+    // По умолчанию резервным является файловый лог. Если он уже включен в
+    // logging.sinks, сообщения и так выводятся локально.
+    fallback_type_ = conf.Get<string>(path + ".fallback", "");
+    const bool configured{!fallback_type_.empty()};
+    if (!configured)
+    {
+        fallback_type_ = "file";
+    }
+
+    if (fallback_type_ == "none")
+    {
+        fallback_type_.clear();
+    }
+    else if (fallback_type_ == "shm")
+    {
+        Logging::Warning("Лог типа shm не может быть резервным");
+        fallback_type_.clear();
+    }
+    else if (conf.Get("logging.sinks." + fallback_type_ + ".enable", true))
+    {
+        const auto types{conf.Get<vector<string>>("logging.sinks.")};
+        if (std::find(types.begin(), types.end(), fallback_type_) !=
+            types.end())
+        {
+            if (configured)
+            {
+                Logging::Warning("Резервный лог {} уже используется для "
+                                 "вывода сообщений и не будет создан",
+                                 fallback_type_);
+            }
+            fallback_type_.clear();
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+ShmSink::~ShmSink() noexcept
+{
+    if (!ring_->ReaderAlive(timeout_))
+    {
+        Reclaim();
+        ring_->Unlink();
+    }
+    else
+    {
+        ring_->Close();
+    }
+}
+
+//------------------------------------------------------------------------------
+void ShmSink::Finish() noexcept
+{
+    if (!ring_->ReaderAlive(timeout_))
+    {
+        Reclaim();
+    }
+
+    finished_ = true;
+}
+
+//------------------------------------------------------------------------------
+void ShmSink::PrintImpl(const LogLine &line) noexcept
+{
+    if (ring_->ReaderAlive(timeout_) || steady_clock::now() < deadline_)
+    {
+        if (ring_->Push(line.Serialize(origin_)))
+        {
+            return;
+        }
+    }
+    else
+    {
+        // Сборщик не подключился или завершился: непрочитанные записи
+        // выводятся в резервный лог перед сообщением, чтобы сохранить
+        // порядок.
+        Reclaim();
+    }
+
+    if (Fallback())
+    {
+        fallback_->Print(line);
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ShmSink::Fallback() noexcept
+{
+    if (fallback_ == nullptr && !fallback_type_.empty() && !finished_)
+    {
+        const SinkFactory factory{};
+        fallback_ = factory.Create(fallback_type_,
+                                   "logging.sinks." + fallback_type_);
+        if (fallback_ == nullptr)
+        {
+            fallback_type_.clear();
+        }
+    }
+
+    return fallback_ != nullptr;
+}
+
+//------------------------------------------------------------------------------
+void ShmSink::Reclaim() noexcept
+{
+    if (ring_->Empty() || !Fallback() || !ring_->Acquire(ShmRing::writer_))
+    {
+        return;
+    }
+
+    string record{};
+    while (ring_->Pop(record))
+    {
+        const auto restored{LogLine::Deserialize(record)};
+        if (restored != nullptr)
+        {
+            fallback_->Print(*restored);
+        }
+    }
+
+    ring_->Release(ShmRing::writer_);
+}
+
+//------------------------------------------------------------------------------
+void ShmSink::FlushImpl() noexcept
+{
+    if (fallback_ != nullptr)
+    {
+        fallback_->Flush();
+    }
+}
+
+}  // namespace tasp
@@ -0,0 +1,127 @@
+/**
+ * @file
+ * @brief Классы для вывода сообщений в разделяемую память для сборщика логов.
+ */
+#ifndef TASP_LOGGING_SINKS_SHM_SINK_HPP_
+#define TASP_LOGGING_SINKS_SHM_SINK_HPP_
+
+#include "../log_line.hpp"
+#include "../shm_ring.hpp"
+#include "sink.hpp"
+
+namespace tasp
+{
+
+/**
+ * @brief Реализация вывода сообщений в кольцевой буфер в разделяемой памяти.
+ *
+ * Сообщения из буферов всех процессов считываются одним сборщиком логов
+ * (tasp-log-collector) и выводятся в его логи. Если сборщик не подключился в
+ * течение timeout после создания буфера, завершился или буфер переполнен,
+ * сообщения выводятся в локальный резервный лог (по умолчанию file).
+ * Резервный лог создается при первой неудачной записи в буфер.
+ */
+class ShmSink final : public Sink
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * @param config_path Путь к параметрам лога в конфигурационном файле
+     */
+    explicit ShmSink(std::string_view config_path) noexcept;
+
+    /**
+     * @brief Деструктор.
+     *
+     * Если сборщик логов не работает, непрочитанные записи выводятся в
+     * резервный лог и сегмент разделяемой памяти удаляется, иначе буфер
+     * закрывается и удаляется сборщиком после чтения.
+     */
+    ~ShmSink() noexcept override;
+
+    /**
+     * @brief Завершение вывода.
+     *
+     * Если сборщик логов не работает, непрочитанные записи выводятся в
+     * резервный лог. После завершения резервный лог больше не создается, так
+     * как глобальный конфигурационный файл может быть удален.
+     */
+    void Finish() noexcept override;
+
+    ShmSink(const ShmSink &) = delete;
+    ShmSink(ShmSink &&) = delete;
+    ShmSink &operator=(const ShmSink &) = delete;
+    ShmSink &operator=(ShmSink &&) = delete;
+
+private:
+    /**
+     * @brief Реализация вывода сообщения в лог.
+     *
+     * @param line Данные для вывода
+     */
+    void PrintImpl(const LogLine &line) noexcept override;
+
+    /**
+     * @brief Реализация сброса буферизированных данных.
+     */
+    void FlushImpl() noexcept override;
+
+    /**
+     * @brief Создание резервного лога при первом обращении.
+     *
+     * @return Результат создания. false - резервный лог не используется
+     */
+    bool Fallback() noexcept;
+
+    /**
+     * @brief Вывод непрочитанных записей буфера в резервный лог.
+     *
+     * Записи выводятся, только если буфер удалось захватить для чтения, то
+     * есть сборщик не подключен к нему или завершился.
+     */
+    void Reclaim() noexcept;
+
+    /**
+     * @brief Источник сообщений в формате НАЗВАНИЕ_ПРОГРАММЫ:PID.
+     */
+    std::string origin_;
+
+    /**
+     * @brief Кольцевой буфер в разделяемой памяти.
+     */
+    std::unique_ptr<ShmRing> ring_;
+
+    /**
+     * @brief Максимальное время с последней активности сборщика, после
+     * которого сборщик считается неработающим.
+     */
+    std::chrono::milliseconds timeout_{2000};
+
+    /**
+     * @brief Момент, до которого сообщения записываются в буфер в ожидании
+     * подключения сборщика.
+     */
+    std::chrono::steady_clock::time_point deadline_;
+
+    /**
+     * @brief Тип резервного лога. Пустая строка - резервный лог не
+     * используется (параметр fallback равен none или лог этого типа уже
+     * включен).
+     */
+    std::string fallback_type_;
+
+    /**
+     * @brief Резервный лог для вывода сообщений при недоступности сборщика.
+     */
+    std::unique_ptr<Sink> fallback_;
+
+    /**
+     * @brief Признак завершения вывода (@ref Finish).
+     */
+    bool finished_{false};
+};
+
+}  // namespace tasp
+
+#endif  // TASP_LOGGING_SINKS_SHM_SINK_HPP_
@@ -2,6 +2,7 @@
 
 #include "console_sink.hpp"
 #include "file_sink.hpp"
+#include "shm_sink.hpp"
 #include "syslog_sink.hpp"
 #include "tasp/config.hpp"
 
@@ -9,6 +10,7 @@ using std::make_unique;
 using std::string;
 using std::string_view;
 using std::unique_ptr;
+using std::chrono::steady_clock;
 
 namespace tasp
 {
@@ -31,10 +33,78 @@ void Sink::Print(const LogLine &line) noexcept
 {
     if (level_ <= line.Level())
     {
-        PrintImpl(line);
+        PrintUnfiltered(line);
     }
 }
 
+//------------------------------------------------------------------------------
+void Sink::PrintUnfiltered(const LogLine &line) noexcept
+{
+    const auto start{steady_clock::now()};
+    PrintImpl(line);
+    batch_latency_ += steady_clock::now() - start;
+    ++batch_lines_;
+}
+
+//------------------------------------------------------------------------------
+void Sink::Flush() noexcept
+{
+    const auto start{steady_clock::now()};
+    FlushImpl();
+
+    if (batch_lines_ != 0)
+    {
+        write_latency_.Record(batch_latency_ + (steady_clock::now() - start));
+        batch_latency_ = {};
+        batch_lines_ = 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+void Sink::FlushImpl() noexcept
+{
+}
+
+//------------------------------------------------------------------------------
+int Sink::Descriptor() const noexcept
+{
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+void Sink::Sync() noexcept
+{
+    SyncImpl();
+}
+
+//------------------------------------------------------------------------------
+void Sink::SyncImpl() noexcept
+{
+}
+
+//------------------------------------------------------------------------------
+void Sink::Finish() noexcept
+{
+}
+
+//------------------------------------------------------------------------------
+std::chrono::milliseconds Sink::SyncInterval() const noexcept
+{
+    return std::chrono::milliseconds{0};
+}
+
+//------------------------------------------------------------------------------
+LogLevel::Level Sink::DurableLevel() const noexcept
+{
+    return LogLevel::Level::None;
+}
+
+//------------------------------------------------------------------------------
+Json::Value Sink::Statistics() const noexcept
+{
+    return Json::nullValue;
+}
+
 //------------------------------------------------------------------------------
 const LogLevel &Sink::Level() const noexcept
 {
@@ -47,6 +117,12 @@ const string &Sink::ConfigPath() const noexcept
     return config_path_;
 }
 
+//------------------------------------------------------------------------------
+const LatencyHistogram &Sink::WriteLatency() const noexcept
+{
+    return write_latency_;
+}
+
 /*------------------------------------------------------------------------------
     SinkFactory
 ------------------------------------------------------------------------------*/
@@ -66,6 +142,11 @@ SinkFactory::SinkFactory() noexcept
     {
         return make_unique<FileSink>(config_path);
     };
+
+    types_["shm"] = [](string_view config_path)
+    {
+        return make_unique<ShmSink>(config_path);
+    };
 }
 
 //------------------------------------------------------------------------------
@@ -84,4 +165,29 @@ unique_ptr<Sink> SinkFactory::Create(string_view type,
     return nullptr;
 }
 
+//------------------------------------------------------------------------------
+string SinkFactory::Fingerprint(string_view type,
+                                string_view config_path) noexcept
+{
+    auto &conf{ConfigGlobal::Instance()};
+
+    string fingerprint{type};
+    fingerprint += '\n';
+    fingerprint += conf.String(config_path);
+    fingerprint += conf.String("program.name");
+    fingerprint += conf.String("program.path");
+
+    if (type == "shm")
+    {
+        const auto fallback{
+            conf.Get<string>(string{config_path} + ".fallback", "file")};
+        if (fallback != "shm" && fallback != "none")
+        {
+            fingerprint += conf.String("logging.sinks." + fallback);
+        }
+    }
+
+    return fingerprint;
+}
+
 }  // namespace tasp
@@ -5,8 +5,10 @@
 #ifndef TASP_LOGGING_SINKS_SINK_HPP_
 #define TASP_LOGGING_SINKS_SINK_HPP_
 
+#include <chrono>
 #include <memory>
 
+#include "../latency_histogram.hpp"
 #include "../log_line.hpp"
 
 namespace tasp
@@ -37,6 +39,74 @@ public:
      */
     void Print(const LogLine &line) noexcept;
 
+    /**
+     * @brief Вывод сообщения в лог без проверки уровня сообщения.
+     *
+     * @param line Данные для вывода
+     */
+    void PrintUnfiltered(const LogLine &line) noexcept;
+
+    /**
+     * @brief Сброс буферизированных данных лога на устройство вывода.
+     *
+     * Суммарное время вывода сообщений после предыдущего сброса и самого
+     * сброса учитывается в гистограмме времени записи (@ref WriteLatency).
+     */
+    void Flush() noexcept;
+
+    /**
+     * @brief Запрос файлового дескриптора для аварийного вывода сообщений.
+     *
+     * Если лог возвращает дескриптор, его функция @ref FlushImpl должна
+     * использовать только async-signal-safe функции, т.к. вызывается из
+     * обработчика сигнала при падении программы.
+     *
+     * @return Дескриптор или -1, если аварийный вывод не поддерживается
+     */
+    [[nodiscard]] virtual int Descriptor() const noexcept;
+
+    /**
+     * @brief Синхронизация выведенных данных с устройством хранения.
+     *
+     * Вызывается потоком обработки после вывода очередной пачки сообщений без
+     * захвата мьютекса очереди. Лог сам решает, нужна ли синхронизация.
+     */
+    void Sync() noexcept;
+
+    /**
+     * @brief Завершение вывода перед остановкой потока обработки.
+     *
+     * Вызывается потоком обработки после вывода последних сообщений, пока
+     * глобальный конфигурационный файл еще доступен. По умолчанию ничего не
+     * делает.
+     */
+    virtual void Finish() noexcept;
+
+    /**
+     * @brief Запрос интервала периодической синхронизации.
+     *
+     * @return Интервал или 0, если периодическая синхронизация не требуется
+     */
+    [[nodiscard]] virtual std::chrono::milliseconds SyncInterval() const
+        noexcept;
+
+    /**
+     * @brief Запрос уровня сообщений, для которых вызов логирования ожидает
+     * синхронизации с устройством хранения.
+     *
+     * @return Уровень сообщений или LogLevel::Level::None, если ожидание не
+     * требуется
+     */
+    [[nodiscard]] virtual LogLevel::Level DurableLevel() const noexcept;
+
+    /**
+     * @brief Запрос статистики работы лога.
+     *
+     * @return Статистика в формате Json::Value или null, если статистика не
+     * собирается
+     */
+    [[nodiscard]] virtual Json::Value Statistics() const noexcept;
+
     /**
      * @brief Запрос максимального уровня сообщений выводимых в лог.
      *
@@ -51,6 +121,13 @@ public:
      */
     [[nodiscard]] const std::string &ConfigPath() const noexcept;
 
+    /**
+     * @brief Запрос гистограммы времени записи пачек сообщений в лог.
+     *
+     * @return Гистограмма
+     */
+    [[nodiscard]] const LatencyHistogram &WriteLatency() const noexcept;
+
     Sink(const Sink &) = delete;
     Sink(Sink &&) = delete;
     Sink &operator=(const Sink &) = delete;
@@ -64,6 +141,20 @@ private:
      */
     virtual void PrintImpl(const LogLine &line) noexcept = 0;
 
+    /**
+     * @brief Реализация сброса буферизированных данных.
+     *
+     * По умолчанию ничего не делает.
+     */
+    virtual void FlushImpl() noexcept;
+
+    /**
+     * @brief Реализация синхронизации с устройством хранения.
+     *
+     * По умолчанию ничего не делает.
+     */
+    virtual void SyncImpl() noexcept;
+
     /**
      * @brief Путь к параметрам лога в конфигурационном файле.
      */
@@ -73,6 +164,21 @@ private:
      * @brief Максимальный уровень сообщений выводимый в лог.
      */
     LogLevel level_;
+
+    /**
+     * @brief Время вывода сообщений после предыдущего сброса.
+     */
+    std::chrono::nanoseconds batch_latency_{};
+
+    /**
+     * @brief Количество сообщений, выведенных после предыдущего сброса.
+     */
+    std::uint64_t batch_lines_{0};
+
+    /**
+     * @brief Гистограмма времени записи пачек сообщений.
+     */
+    LatencyHistogram write_latency_;
 };
 
 /**
@@ -98,6 +204,7 @@ public:
      *   file - вывод в файл
      *   console - вывод в консоль
      *   syslog - вывод в syslog
+     *   shm - вывод в разделяемую память для сборщика логов
      *
      * Если тип лога не поддерживается, возвращается nullptr.
      *
@@ -109,6 +216,22 @@ public:
     std::unique_ptr<Sink> Create(std::string_view type,
                                  std::string_view config_path) const noexcept;
 
+    /**
+     * @brief Запрос параметров, от которых зависит лог.
+     *
+     * В результат входят параметры лога, параметры программы (название и
+     * путь) и, для лога типа shm, параметры резервного лога. Если результат
+     * не изменился, лог можно не пересоздавать при перезагрузке.
+     *
+     * @param type Тип лога
+     * @param config_path Путь к параметрам лога в конфигурационном файле
+     *
+     * @return Параметры в виде текста
+     */
+    [[nodiscard]] static std::string Fingerprint(
+        std::string_view type,
+        std::string_view config_path) noexcept;
+
     SinkFactory(const SinkFactory &) = delete;
     SinkFactory(SinkFactory &&) = delete;
     SinkFactory &operator=(const SinkFactory &) = delete;
@@ -1,5 +1,7 @@
 #include "thread_impl.hpp"
 
+#include "../daemon/signal_stack.hpp"
+
 using std::function;
 using std::make_unique;
 using std::thread;
@@ -56,6 +58,8 @@ void ThreadImpl::Stop() noexcept
 //------------------------------------------------------------------------------
 void ThreadImpl::Main() noexcept
 {
+    const SignalStack signal_stack{};
+
     while (status_ != Status::NeedStop)
     {
         worker_();
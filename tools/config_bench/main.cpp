@@ -0,0 +1,160 @@
+/**
+ * @file
+ * @brief Сравнение скорости чтения параметров из конфигурационного файла.
+ *
+ * Создает конфигурационный файл на 5000 параметров (50 x 10 x 10) и измеряет
+ * среднее время одного запроса при обходе дерева YAML (tasp::Config), по
+ * индексу снимка глобального конфигурационного файла (tasp::ConfigGlobal) и
+ * через кэшируемый ключ (tasp::ConfigKey).
+ *
+ * Запуск: tasp-config-bench [КОЛИЧЕСТВО_ЗАПРОСОВ]
+ */
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <experimental/filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "tasp/config.hpp"
+
+namespace fs = std::experimental::filesystem;
+
+using std::string;
+using std::vector;
+using std::chrono::duration;
+using std::chrono::steady_clock;
+
+namespace
+{
+
+/**
+ * @brief Количество разделов каждого уровня вложенности.
+ */
+constexpr int sections_{50};
+
+/**
+ * @brief Количество подразделов и параметров в каждом разделе.
+ */
+constexpr int children_{10};
+
+/**
+ * @brief Создание конфигурационного файла для измерений.
+ *
+ * @param path Путь к файлу
+ */
+void CreateConfig(const fs::path &path)
+{
+    std::ofstream output{path};
+    output << "logging:\n  sinks:\n    file:\n      enable: false\n";
+    for (int section = 0; section < sections_; ++section)
+    {
+        output << "section" << section << ":\n";
+        for (int group = 0; group < children_; ++group)
+        {
+            output << "  group" << group << ":\n";
+            for (int key = 0; key < children_; ++key)
+            {
+                output << "    key" << key << ": "
+                       << section * 100 + group * 10 + key << '\n';
+            }
+        }
+    }
+}
+
+/**
+ * @brief Формирование путей к параметрам в порядке запросов.
+ *
+ * @param count Количество путей
+ *
+ * @return Пути к параметрам
+ */
+vector<string> CreatePaths(std::size_t count)
+{
+    vector<string> paths{};
+    paths.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        // Простое число в шаге распределяет запросы по всем параметрам.
+        const std::size_t index{i * 7919 % (sections_ * children_ * children_)};
+        paths.push_back("section" + std::to_string(index / 100) + ".group" +
+                        std::to_string(index / 10 % 10) + ".key" +
+                        std::to_string(index % 10));
+    }
+
+    return paths;
+}
+
+/**
+ * @brief Измерение среднего времени вызова функции.
+ *
+ * @param name Название измерения
+ * @param count Количество вызовов
+ * @param function Функция, принимающая номер вызова и возвращающая
+ * прочитанное значение
+ */
+template<typename Function>
+void Measure(const string &name, std::size_t count, Function &&function)
+{
+    long long sum{0};
+    const auto start{steady_clock::now()};
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        sum += static_cast<long long>(function(i));
+    }
+    const duration<double, std::micro> elapsed{steady_clock::now() - start};
+
+    std::cout << std::fixed << std::setprecision(3) << std::setw(10)
+              << elapsed.count() / static_cast<double>(count)
+              << " мкс/запрос  " << name << " (контрольная сумма " << sum
+              << ")\n";
+}
+
+}  // namespace
+
+int main(int argc, const char **argv)
+{
+    const std::size_t default_count{100000};
+    const std::size_t count{
+        argc > 1 ? std::strtoul(argv[1], nullptr, 10) : default_count};
+    if (count == 0)
+    {
+        std::cerr << "Неверное количество запросов: " << argv[1] << '\n';
+        return EXIT_FAILURE;
+    }
+
+    const fs::path directory{fs::temp_directory_path() /
+                             ("tasp-config-bench-" + std::to_string(getpid()))};
+    fs::create_directories(directory);
+    const fs::path path{directory / "bench.yml"};
+    CreateConfig(path);
+
+    const auto paths{CreatePaths(count)};
+
+    const tasp::Config config{path};
+    Measure("Config (дерево YAML)",
+            count,
+            [&](std::size_t i) { return config.Get<int>(paths[i]); });
+
+    const auto &global{tasp::ConfigGlobal::Instance(path)};
+    Measure("ConfigGlobal (индекс)",
+            count,
+            [&](std::size_t i) { return global.Get<int>(paths[i]); });
+    Measure("ConfigGlobal, строка",
+            count,
+            [&](std::size_t i) { return global.Get<string>(paths[i]).size(); });
+
+    const tasp::ConfigKey<int> key{paths.front()};
+    Measure("ConfigKey",
+            count,
+            [&](std::size_t /*unused*/) { return key.Get(); });
+
+    std::error_code error{};
+    fs::remove_all(directory, error);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,200 @@
+#include "log_collector.hpp"
+
+#include <unistd.h>
+
+#include <csignal>
+#include <experimental/filesystem>
+
+#include "daemon/signal_stack.hpp"
+#include "tasp/config.hpp"
+#include "tasp/logging.hpp"
+
+using std::error_code;
+using std::make_unique;
+using std::scoped_lock;
+using std::string;
+using std::thread;
+using std::vector;
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+using std::chrono::steady_clock;
+
+namespace fs = std::experimental::filesystem;
+
+namespace tasp
+{
+/*------------------------------------------------------------------------------
+    LogCollector
+------------------------------------------------------------------------------*/
+LogCollector::LogCollector(int argc, const char **argv) noexcept
+: Daemon(argc, argv)
+{
+    Reload();
+    thread_ = make_unique<thread>(&LogCollector::Worker, this);
+}
+
+//------------------------------------------------------------------------------
+LogCollector::~LogCollector() noexcept
+{
+    stop_ = true;
+
+    thread_->join();
+    thread_.reset(nullptr);
+
+    Drain();
+
+    // Процессы выводят непрочитанные записи в резервный лог.
+    for (auto &item : rings_)
+    {
+        item.second->Release(getpid());
+    }
+}
+
+//------------------------------------------------------------------------------
+void LogCollector::Reload() noexcept
+{
+    auto &conf{ConfigGlobal::Instance()};
+
+    const scoped_lock lock{mutex_};
+
+    const milliseconds default_interval{10};
+    interval_ = milliseconds{
+        conf.Get("collector.interval",
+                 static_cast<unsigned int>(default_interval.count()))};
+
+    sinks_.clear();
+
+    const string sinks_path{"collector.sinks."};
+    auto types{conf.Get<vector<string>>(sinks_path, {"file"})};
+    for (const auto &type : types)
+    {
+        if (type == "shm")
+        {
+            Logging::Warning("Лог типа shm не может использоваться сборщиком");
+            continue;
+        }
+
+        if (conf.Get(sinks_path + type + ".enable", true))
+        {
+            auto log{factory_.Create(type, sinks_path + type)};
+            if (log != nullptr)
+            {
+                sinks_.push_back(std::move(log));
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void LogCollector::Worker() noexcept
+{
+    const SignalStack signal_stack{};
+
+    const seconds scan_interval{1};
+    auto next_scan{steady_clock::now()};
+
+    while (!stop_)
+    {
+        if (steady_clock::now() >= next_scan)
+        {
+            Scan();
+            next_scan = steady_clock::now() + scan_interval;
+        }
+
+        Drain();
+
+        milliseconds interval{};
+        {
+            const scoped_lock lock{mutex_};
+            interval = interval_;
+        }
+        std::this_thread::sleep_for(interval);
+    }
+}
+
+//------------------------------------------------------------------------------
+void LogCollector::Scan() noexcept
+{
+    const scoped_lock lock{mutex_};
+
+    error_code error{};
+    for (const auto &entry :
+         fs::directory_iterator(fs::path{ShmRing::directory_}, error))
+    {
+        const string name{entry.path().filename()};
+        if (name.compare(0, ShmRing::prefix_.size(), ShmRing::prefix_) != 0 ||
+            rings_.count(name) != 0)
+        {
+            continue;
+        }
+
+        // Буфер, который процесс захватил для вывода записей в резервный
+        // лог, подключается при следующем поиске.
+        auto ring{make_unique<ShmRing>(name)};
+        if (ring->Valid() && ring->Acquire(getpid()))
+        {
+            Logging::Info("Подключен буфер сообщений {}", name);
+            ring->Heartbeat();
+            rings_.emplace(name, std::move(ring));
+        }
+    }
+
+    for (auto iter = rings_.begin(); iter != rings_.end();)
+    {
+        // Буфер отключается после чтения оставшихся записей, если процесс
+        // закрыл его или завершился, либо сегмент был заменен новым с тем же
+        // названием (он будет подключен при следующем поиске).
+        const auto &ring{iter->second};
+        if (ring->Empty() &&
+            (ring->Closed() || !ring->Linked() ||
+             (kill(ring->Owner(), 0) != 0 && errno == ESRCH)))
+        {
+            Logging::Info("Отключен буфер сообщений {}", iter->first);
+            ring->Unlink();
+            iter = rings_.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void LogCollector::Drain() noexcept
+{
+    const scoped_lock lock{mutex_};
+
+    bool printed{false};
+    string record{};
+    for (auto &item : rings_)
+    {
+        auto &ring{item.second};
+        ring->Heartbeat();
+
+        while (ring->Pop(record))
+        {
+            const auto line{LogLine::Deserialize(record)};
+            if (line == nullptr)
+            {
+                continue;
+            }
+
+            for (const auto &sink : sinks_)
+            {
+                sink->Print(*line);
+            }
+            printed = true;
+        }
+    }
+
+    if (printed)
+    {
+        for (const auto &sink : sinks_)
+        {
+            sink->Flush();
+        }
+    }
+}
+
+}  // namespace tasp
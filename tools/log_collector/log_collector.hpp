@@ -0,0 +1,109 @@
+/**
+ * @file
+ * @brief Сборщик логов из разделяемой памяти процессов.
+ */
+#ifndef TASP_TOOLS_LOG_COLLECTOR_LOG_COLLECTOR_HPP_
+#define TASP_TOOLS_LOG_COLLECTOR_LOG_COLLECTOR_HPP_
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "logging/shm_ring.hpp"
+#include "logging/sinks/sink.hpp"
+#include "tasp/daemon.hpp"
+
+namespace tasp
+{
+
+/**
+ * @brief Демон сбора логов.
+ *
+ * Периодически ищет в /dev/shm кольцевые буферы процессов, использующих лог
+ * типа shm, считывает из них сообщения и выводит их в логи, перечисленные в
+ * параметре collector.sinks конфигурационного файла.
+ */
+class LogCollector final : public Daemon
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * @param argc Количество параметров запуска
+     * @param argv Массив параметров
+     */
+    LogCollector(int argc, const char **argv) noexcept;
+
+    /**
+     * @brief Деструктор.
+     *
+     * Останавливает поток сбора и выводит оставшиеся сообщения.
+     */
+    ~LogCollector() noexcept override;
+
+    /**
+     * @brief Перезагрузка логов сборщика по параметрам конфигурационного файла.
+     */
+    void Reload() noexcept override;
+
+    LogCollector(const LogCollector &) = delete;
+    LogCollector(LogCollector &&) = delete;
+    LogCollector &operator=(const LogCollector &) = delete;
+    LogCollector &operator=(LogCollector &&) = delete;
+
+private:
+    /**
+     * @brief Потоковая функция сбора сообщений.
+     */
+    void Worker() noexcept;
+
+    /**
+     * @brief Поиск новых буферов и удаление буферов завершенных процессов.
+     */
+    void Scan() noexcept;
+
+    /**
+     * @brief Чтение сообщений из всех буферов и вывод их в логи.
+     */
+    void Drain() noexcept;
+
+    /**
+     * @brief Мьютекс для синхронизации сбора и перезагрузки логов.
+     */
+    std::mutex mutex_;
+
+    /**
+     * @brief Фабрика для создания объектов логирования.
+     */
+    SinkFactory factory_;
+
+    /**
+     * @brief Список открытых логов.
+     */
+    std::vector<std::unique_ptr<Sink>> sinks_;
+
+    /**
+     * @brief Открытые буферы процессов по названию сегмента.
+     */
+    std::map<std::string, std::unique_ptr<ShmRing>> rings_;
+
+    /**
+     * @brief Интервал между чтением буферов.
+     */
+    std::chrono::milliseconds interval_{10};
+
+    /**
+     * @brief Флаг остановки потока сбора.
+     */
+    std::atomic<bool> stop_{false};
+
+    /**
+     * @brief Поток сбора сообщений.
+     */
+    std::unique_ptr<std::thread> thread_{nullptr};
+};
+
+}  // namespace tasp
+
+#endif  // TASP_TOOLS_LOG_COLLECTOR_LOG_COLLECTOR_HPP_
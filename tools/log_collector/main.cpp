@@ -0,0 +1,7 @@
+#include "log_collector.hpp"
+
+int main(int argc, const char **argv)
+{
+    const tasp::LogCollector collector{argc, argv};
+    return collector.Exec();
+}